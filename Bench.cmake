@@ -0,0 +1,16 @@
+file(GLOB_RECURSE PlayPG_BENCH_SOURCES ${PROJECT_SOURCE_DIR}/bench/*.cpp)
+
+file(MAKE_DIRECTORY assets)
+file(COPY ${PlayPG_TEST_ASSETS} DESTINATION assets)
+
+set (PlayPG_BENCH_NAME "benchPG")
+
+if ( PlayPG_DEBUG )
+    set (PlayPG_BENCH_NAME "${PlayPG_BENCH_NAME}-d")
+endif ()
+
+add_executable(${PlayPG_BENCH_NAME}
+               ${PlayPG_SOURCES}
+               ${PlayPG_BENCH_SOURCES}
+               ${PlayPG_NON_DATA_HEADERS})
+target_link_libraries(${PlayPG_BENCH_NAME} ${PlayPG_LIBS})
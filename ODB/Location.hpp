@@ -33,6 +33,7 @@
 #include <string>
 
 #include "Map.hpp"
+#include "MapHeader.hpp"
 
 #include "PlayPGODB.hpp"
 
@@ -41,16 +42,16 @@ namespace PlayPG {
 #pragma db object table("locations")
 class Location {
 public:
-	static std::string makeMD5Hash(const std::string &base64Hash);
-
 	explicit Location(const Map &map);
 
 	explicit Location(const std::string &locationName_, const std::string &knownFileName_,
-	        const std::string &knownMD5Hash_, const uint32_t &version_) :
+	        const std::string &knownHash_, const uint32_t &version_,
+	        const std::string &hashAlgorithm_ = MapHeader::HASH_ALGORITHM) :
 			        id { 0u },
 			        locationName { locationName_ },
 			        knownFileName { knownFileName_ },
-			        knownMD5Hash { knownMD5Hash_ },
+			        knownHash { knownHash_ },
+			        hashAlgorithm { hashAlgorithm_ },
 			        version { version_ } {
 	}
 
@@ -60,7 +61,8 @@ public:
 	std::string locationName;
 
 	std::string knownFileName;
-	std::string knownMD5Hash;
+	std::string knownHash;
+	std::string hashAlgorithm;
 
 	uint32_t version;
 
@@ -71,7 +73,8 @@ private:
 	id {0u},
 	locationName {""},
 	knownFileName {""},
-	knownMD5Hash {""},
+	knownHash {""},
+	hashAlgorithm {""},
 	version {0u} {
 	}
 };
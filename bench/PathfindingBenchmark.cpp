@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Times pathfinding on the bundled maps and on large synthetic grids.
+ *
+ * Usage: benchPG [map.tmx...]
+ * With no arguments, assets/outdoor.tmx and assets/room1.tmx are used.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <APG/APG.hpp>
+INITIALIZE_EASYLOGGINGPP
+
+#include <tmxparser/Tmx.h>
+
+#include "Map.hpp"
+#include "pathfinding/GridSearch.hpp"
+#include "pathfinding/JumpPointSearch.hpp"
+#include "pathfinding/PathGraph.hpp"
+#include "pathfinding/Pathfinder.hpp"
+#include "util/BitGrid.hpp"
+
+using namespace PlayPG;
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+constexpr const int QUERY_COUNT = 2000;
+constexpr const uint32_t SYNTHETIC_SIZE = 1000u;
+
+double msSince(const bench_clock::time_point &start) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(bench_clock::now() - start).count() / 1000.0;
+}
+
+/**
+ * Plain A* over every tile, as a baseline for the other searches.
+ */
+float plainAStar(const BitGrid &solid, const glm::ivec2 &start, const glm::ivec2 &goal) {
+	const int32_t width = static_cast<int32_t>(solid.getWidth());
+	const int32_t height = static_cast<int32_t>(solid.getHeight());
+
+	const auto walkable = [&](int32_t x, int32_t y) {
+		return x >= 0 && y >= 0 && x < width && y < height && !solid.get(x, y);
+	};
+
+	std::vector<float> costs(static_cast<std::size_t>(width) * height, pathcost::UNREACHABLE);
+	std::vector<std::pair<float, int32_t>> open;
+	const auto greater = std::greater<std::pair<float, int32_t>>();
+
+	costs[start.y * width + start.x] = 0.0f;
+	open.emplace_back(pathcost::octile(start, goal), start.y * width + start.x);
+
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), greater);
+		const auto current = open.back();
+		open.pop_back();
+
+		const glm::ivec2 tile { current.second % width, current.second / width };
+		const float cost = costs[current.second];
+
+		if (tile == goal) {
+			return cost;
+		}
+
+		if (current.first > cost + pathcost::octile(tile, goal)) {
+			continue;
+		}
+
+		for (int32_t dy = -1; dy <= 1; ++dy) {
+			for (int32_t dx = -1; dx <= 1; ++dx) {
+				if ((dx == 0 && dy == 0) || !walkable(tile.x + dx, tile.y + dy)) {
+					continue;
+				}
+
+				if (dx != 0 && dy != 0 && (!walkable(tile.x + dx, tile.y) || !walkable(tile.x, tile.y + dy))) {
+					continue;
+				}
+
+				const auto next = (tile.y + dy) * width + tile.x + dx;
+				const float nextCost = cost + (dx != 0 && dy != 0 ? pathcost::DIAGONAL : pathcost::STRAIGHT);
+
+				if (nextCost < costs[next]) {
+					costs[next] = nextCost;
+					open.emplace_back(nextCost + pathcost::octile( { tile.x + dx, tile.y + dy }, goal), next);
+					std::push_heap(open.begin(), open.end(), greater);
+				}
+			}
+		}
+	}
+
+	return pathcost::UNREACHABLE;
+}
+
+BitGrid makeScatteredGrid(uint32_t size, std::mt19937 &random) {
+	BitGrid grid(size, size);
+	std::uniform_int_distribution<int> percent(0, 99);
+
+	for (uint32_t y = 0u; y < size; ++y) {
+		for (uint32_t x = 0u; x < size; ++x) {
+			grid.set(x, y, percent(random) < 20);
+		}
+	}
+
+	return grid;
+}
+
+BitGrid makeRoomsGrid(uint32_t size, std::mt19937 &random) {
+	constexpr const uint32_t roomSize = 25u;
+	BitGrid grid(size, size);
+	std::uniform_int_distribution<uint32_t> doorway(1u, roomSize - 2u);
+
+	for (uint32_t y = 0u; y < size; ++y) {
+		for (uint32_t x = 0u; x < size; ++x) {
+			grid.set(x, y, x % roomSize == 0u || y % roomSize == 0u);
+		}
+	}
+
+	// knock a doorway through every wall
+	for (uint32_t y = 0u; y < size; y += roomSize) {
+		for (uint32_t x = 0u; x < size; x += roomSize) {
+			const auto eastDoor = std::min(y + doorway(random), size - 1u);
+			const auto southDoor = std::min(x + doorway(random), size - 1u);
+
+			if (x + roomSize < size) {
+				grid.set(x + roomSize, eastDoor, false);
+			}
+
+			if (y + roomSize < size) {
+				grid.set(southDoor, y + roomSize, false);
+			}
+		}
+	}
+
+	return grid;
+}
+
+std::vector<std::pair<glm::ivec2, glm::ivec2>> makeQueries(const BitGrid &solid, std::mt19937 &random) {
+	std::uniform_int_distribution<int32_t> xs(0, static_cast<int32_t>(solid.getWidth()) - 1);
+	std::uniform_int_distribution<int32_t> ys(0, static_cast<int32_t>(solid.getHeight()) - 1);
+
+	const auto randomOpenTile = [&]() {
+		for (int attempt = 0; attempt < 1000; ++attempt) {
+			const glm::ivec2 tile { xs(random), ys(random) };
+
+			if (!solid.get(tile.x, tile.y)) {
+				return tile;
+			}
+		}
+
+		return glm::ivec2 { 0, 0 };
+	};
+
+	std::vector<std::pair<glm::ivec2, glm::ivec2>> queries;
+	queries.reserve(QUERY_COUNT);
+
+	for (int i = 0; i < QUERY_COUNT; ++i) {
+		queries.emplace_back(randomOpenTile(), randomOpenTile());
+	}
+
+	return queries;
+}
+
+void benchmarkGrid(const std::string &name, const BitGrid &solid, std::mt19937 &random, el::Logger * const logger) {
+	logger->info("%v: %vx%v tiles", name, solid.getWidth(), solid.getHeight());
+
+	auto start = bench_clock::now();
+	auto graph = std::make_shared<const PathGraph>(solid);
+	logger->info("  Graph build: %vms, %v nodes, %v edges", msSince(start), graph->getLiveNodeCount(),
+	        graph->getEdgeCount());
+
+	const auto queries = makeQueries(solid, random);
+	std::vector<float> optimalCosts;
+	optimalCosts.reserve(queries.size());
+
+	start = bench_clock::now();
+	for (const auto &query : queries) {
+		optimalCosts.emplace_back(plainAStar(solid, query.first, query.second));
+	}
+	logger->info("  Plain A*: %vms for %v queries", msSince(start), queries.size());
+
+	Pathfinder pathfinder(graph);
+	std::vector<glm::ivec2> path;
+
+	start = bench_clock::now();
+	for (const auto &query : queries) {
+		pathfinder.findShortPath(query.first, query.second, path);
+	}
+	logger->info("  JPS: %vms", msSince(start));
+
+	double costRatioTotal = 0.0;
+	double worstRatio = 1.0;
+	int found = 0;
+
+	start = bench_clock::now();
+	for (std::size_t i = 0u; i < queries.size(); ++i) {
+		if (pathfinder.findLongPath(queries[i].first, queries[i].second, path) && optimalCosts[i] > 0.0f) {
+			const double ratio = pathfinder.getLastPathCost() / optimalCosts[i];
+			costRatioTotal += ratio;
+			worstRatio = std::max(worstRatio, ratio);
+			++found;
+		}
+	}
+	logger->info("  HPA*: %vms, path cost vs optimal: %v average, %v worst", msSince(start),
+	        found > 0 ? costRatioTotal / found : 1.0, worstRatio);
+
+	start = bench_clock::now();
+	for (const auto &query : queries) {
+		pathfinder.findPath(query.first, query.second, path);
+	}
+	logger->info("  Pathfinder (JPS or HPA* by distance): %vms", msSince(start));
+
+	// Simulate a hot swap which changes a handful of tiles.
+	BitGrid changed = solid;
+	std::uniform_int_distribution<uint32_t> xs(0u, solid.getWidth() - 1u);
+	std::uniform_int_distribution<uint32_t> ys(0u, solid.getHeight() - 1u);
+
+	for (int i = 0; i < 10; ++i) {
+		const auto x = xs(random), y = ys(random);
+		changed.set(x, y, !changed.get(x, y));
+	}
+
+	start = bench_clock::now();
+	const auto updated = graph->updatedFor(changed);
+	const auto incrementalTime = msSince(start);
+
+	start = bench_clock::now();
+	PathGraph rebuilt(changed);
+	logger->info("  Hot swap of 10 tiles: incremental %vms (%v clusters), full rebuild %vms", incrementalTime,
+	        updated->getRebuiltClusterCount(), msSince(start));
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	START_EASYLOGGINGPP(argc, argv);
+	APG::Game::setLoggerToAPGStyle("PlayPG");
+
+	auto logger = el::Loggers::getLogger("PlayPG");
+	std::mt19937 random(419u);
+
+	std::vector<std::string> mapFiles;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		// easylogging consumes its own --v/--verbose style flags.
+		if (arg.compare(0, 1, "-") != 0) {
+			mapFiles.emplace_back(arg);
+		}
+	}
+
+	if (mapFiles.empty()) {
+		mapFiles = {"assets/outdoor.tmx", "assets/room1.tmx"};
+	}
+
+	for (const auto &mapFile : mapFiles) {
+		Tmx::Map tmxMap;
+		tmxMap.ParseFile(mapFile);
+
+		if (tmxMap.HasError()) {
+			logger->error("Couldn't parse %v: %v", mapFile, tmxMap.GetErrorText());
+			continue;
+		}
+
+		const Map map(&tmxMap);
+		benchmarkGrid(mapFile, map.getSolidGrid(), random, logger);
+	}
+
+	benchmarkGrid("Synthetic scattered obstacles", makeScatteredGrid(SYNTHETIC_SIZE, random), random, logger);
+	benchmarkGrid("Synthetic rooms", makeRoomsGrid(SYNTHETIC_SIZE, random), random, logger);
+
+	return EXIT_SUCCESS;
+}
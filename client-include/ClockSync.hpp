@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CLIENT_INCLUDE_CLOCKSYNC_HPP_
+#define CLIENT_INCLUDE_CLOCKSYNC_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <array>
+
+#include "net/RoundTripStats.hpp"
+#include "net/packets/TimePackets.hpp"
+#include "util/Util.hpp"
+
+namespace PlayPG {
+
+/**
+ * Estimates the offset between our monotonic clock and the map server's from NTP-style ping/pong exchanges, so
+ * that client systems can tell what time it is on the server. All times are in microseconds.
+ *
+ * Queueing only ever delays a packet, so the exchange with the lowest recent round trip is the one least skewed
+ * by it; the offset follows that exchange, slewing gradually and only stepping when it's far off.
+ */
+class ClockSync final {
+public:
+	// Ping quickly to begin with so we converge within a second of joining, then settle to a low rate.
+	static constexpr const uint32_t FAST_PING_COUNT = 5u;
+	static constexpr const uint64_t FAST_PING_INTERVAL = 100000u;
+	static constexpr const uint64_t PING_INTERVAL = 2000000u;
+
+	// Ping again if a pong hasn't come back in this long.
+	static constexpr const uint64_t PING_TIMEOUT = 5000000u;
+
+	static constexpr const std::size_t FILTER_SIZE = 8u;
+
+	static constexpr const int64_t STEP_THRESHOLD = 100000;
+	static constexpr const double SLEW_GAIN = 0.25;
+
+	explicit ClockSync() = default;
+	~ClockSync() = default;
+
+	bool shouldPing(uint64_t localNow) const;
+
+	/**
+	 * Only one ping is outstanding at a time; call this only when shouldPing() says so.
+	 */
+	TimePingPacket makePing(uint64_t localNow);
+
+	/**
+	 * Returns false and changes nothing if the pong doesn't answer our outstanding ping.
+	 */
+	bool onPong(uint64_t clientSendTime, uint64_t serverReceiveTime, uint64_t serverSendTime, uint64_t localNow);
+
+	/**
+	 * Forgets everything, e.g. after connecting to a different map server.
+	 */
+	void reset();
+
+	bool isSynchronised() const {
+		return synchronised_;
+	}
+
+	uint64_t toServerTime(uint64_t localMicros) const {
+		return static_cast<uint64_t>(static_cast<int64_t>(localMicros) + offset_);
+	}
+
+	/**
+	 * Only meaningful once isSynchronised().
+	 */
+	uint64_t serverTimeNow() const {
+		return toServerTime(util::monotonicMicros());
+	}
+
+	/**
+	 * Server time minus local time.
+	 */
+	int64_t getOffset() const {
+		return offset_;
+	}
+
+	const RoundTripStats &getRoundTrip() const {
+		return roundTrip_;
+	}
+
+private:
+	struct Sample {
+		int64_t offset;
+		uint64_t roundTrip;
+	};
+
+	std::array<Sample, FILTER_SIZE> samples_;
+	std::size_t sampleCount_ = 0u;
+	std::size_t nextSample_ = 0u;
+
+	int64_t offset_ = 0;
+	bool synchronised_ = false;
+
+	RoundTripStats roundTrip_;
+
+	uint32_t pingsSent_ = 0u;
+	uint64_t lastPingAt_ = 0u;
+	bool awaitingPong_ = false;
+
+	// Echoed back so the server can measure the round trip too.
+	uint64_t lastPongServerTime_ = 0u;
+	uint64_t lastPongReceivedAt_ = 0u;
+};
+
+}
+
+#endif /* CLIENT_INCLUDE_CLOCKSYNC_HPP_ */
@@ -35,6 +35,7 @@
 
 #include "components/Renderable.hpp"
 #include "components/Position.hpp"
+#include "components/Interpolated.hpp"
 
 
 #endif /* INCLUDE_COMPONENTS_HPP_ */
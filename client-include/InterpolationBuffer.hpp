@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CLIENT_INCLUDE_INTERPOLATIONBUFFER_HPP_
+#define CLIENT_INCLUDE_INTERPOLATIONBUFFER_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <array>
+
+#include <glm/vec2.hpp>
+
+namespace PlayPG {
+
+/**
+ * The recent positions of one remote entity, timestamped with server time in seconds, so it can be drawn
+ * smoothly a little in the past regardless of when packets happened to arrive.
+ */
+class InterpolationBuffer final {
+public:
+	// Over a second and a half of history at 20 snapshots a second.
+	static constexpr const uint32_t CAPACITY = 32u;
+
+	explicit InterpolationBuffer() = default;
+	~InterpolationBuffer() = default;
+
+	/**
+	 * Samples must arrive in time order; older or duplicate times are ignored. The oldest sample is dropped when
+	 * full.
+	 */
+	void push(double time, const glm::vec2 &position);
+
+	/**
+	 * Sets *position to where the entity was at time, interpolating between the samples either side. Before the
+	 * oldest sample it holds there; after the newest it extrapolates along the last movement for at most
+	 * maxExtrapolation seconds, then holds. Returns false if there are no samples.
+	 */
+	bool sample(double time, double maxExtrapolation, glm::vec2 *position) const;
+
+	void clear() {
+		count_ = 0u;
+	}
+
+	std::size_t size() const {
+		return count_;
+	}
+
+private:
+	struct Sample {
+		double time;
+		glm::vec2 position;
+	};
+
+	const Sample &at(std::size_t index) const {
+		return samples_[(first_ + index) % CAPACITY];
+	}
+
+	std::array<Sample, CAPACITY> samples_;
+	std::size_t first_ = 0u;
+	std::size_t count_ = 0u;
+};
+
+}
+
+#endif /* CLIENT_INCLUDE_INTERPOLATIONBUFFER_HPP_ */
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CLIENT_INCLUDE_MOVEPREDICTION_HPP_
+#define CLIENT_INCLUDE_MOVEPREDICTION_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <array>
+
+#include <glm/vec2.hpp>
+
+namespace PlayPG {
+
+/**
+ * Remembers moves which have been applied locally but not yet confirmed by the map server, so that when the
+ * server corrects us they can be replayed on top of where it says we are. Only an actual correction moves the
+ * player; acknowledgements just forget confirmed moves.
+ */
+class MovePrediction final {
+public:
+	// About three seconds of continuous movement at 20 moves a second.
+	static constexpr const uint32_t CAPACITY = 64u;
+
+	struct PendingMove {
+		uint32_t sequence;
+		glm::ivec2 delta;
+	};
+
+	explicit MovePrediction() = default;
+	~MovePrediction() = default;
+
+	/**
+	 * Records a move which is about to be applied locally and returns its sequence number. Returns 0 if too many
+	 * moves are unconfirmed, in which case the move shouldn't be made at all.
+	 */
+	uint32_t record(const glm::ivec2 &delta);
+
+	/**
+	 * Forgets every move up to and including sequence.
+	 */
+	void acknowledge(uint32_t sequence);
+
+	/**
+	 * The server has dealt with everything up to sequence and put us at serverTile. Returns where we are after
+	 * replaying every newer move from there, skipping any which isOpen(tile) says are now blocked.
+	 */
+	template<typename F> glm::ivec2 reconcile(uint32_t sequence, const glm::ivec2 &serverTile, F &&isOpen);
+
+	/**
+	 * Forgets everything, e.g. after changing map.
+	 */
+	void reset();
+
+	std::size_t getPendingCount() const {
+		return count_;
+	}
+
+private:
+	const PendingMove &at(std::size_t index) const {
+		return moves_[(first_ + index) % CAPACITY];
+	}
+
+	std::array<PendingMove, CAPACITY> moves_;
+	std::size_t first_ = 0u;
+	std::size_t count_ = 0u;
+
+	uint32_t nextSequence_ = 1u;
+};
+
+template<typename F> glm::ivec2 MovePrediction::reconcile(uint32_t sequence, const glm::ivec2 &serverTile,
+        F &&isOpen) {
+	acknowledge(sequence);
+
+	auto tile = serverTile;
+
+	for (std::size_t i = 0u; i < count_; ++i) {
+		const auto next = tile + at(i).delta;
+
+		// The server will reject this one too and correct us again; keep it until then.
+		if (isOpen(next)) {
+			tile = next;
+		}
+	}
+
+	return tile;
+}
+
+}
+
+#endif /* CLIENT_INCLUDE_MOVEPREDICTION_HPP_ */
@@ -51,6 +51,8 @@ class Entity;
 
 namespace PlayPG {
 
+class MovementSystem;
+
 enum class GameState {
 	LOGIN,
 	CHARACTER_SELECT,
@@ -89,6 +91,7 @@ private:
 	std::unique_ptr<APG::GLTmxRenderer> indoorRenderer;
 
 	std::unique_ptr<ashley::Engine> engine;
+	MovementSystem *movementSystem = nullptr;
 
 	ashley::Entity *player = nullptr;
 	void changeToWorld(const std::unique_ptr<Map> &renderer);
@@ -33,5 +33,8 @@
 #include "systems/RenderSystem.hpp"
 #include "systems/MovementSystem.hpp"
 #include "systems/NetworkDispatchSystem.hpp"
+#include "systems/InterpolationSystem.hpp"
+#include "systems/SnapshotSystem.hpp"
+#include "systems/ClockSyncSystem.hpp"
 
 #endif /* INCLUDE_SYSTEMS_HPP_ */
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SYSTEMS_CLOCKSYNCSYSTEM_HPP_
+#define INCLUDE_SYSTEMS_CLOCKSYNCSYSTEM_HPP_
+
+#include <cstdint>
+
+#include <Ashley/Ashley.hpp>
+
+#include "ClockSync.hpp"
+
+namespace PlayPG {
+class NetworkDispatchSystem;
+
+/**
+ * Keeps a ClockSync up to date by pinging the map server in the background. Should run just before the
+ * NetworkDispatchSystem so pings go out in the same frame they're timestamped.
+ */
+class ClockSyncSystem final : public ashley::EntitySystem {
+public:
+	explicit ClockSyncSystem(int64_t priority);
+	explicit ClockSyncSystem(NetworkDispatchSystem * const networkDispatchSystem, int64_t priority);
+	virtual ~ClockSyncSystem() = default;
+
+	void update(float deltaTime) override final;
+
+	ClockSyncSystem &attachNetworkingSystem(NetworkDispatchSystem * const networkDispatchSystem);
+	ClockSyncSystem &detachNetworkingSystem();
+
+	const ClockSync &getClock() const {
+		return clock_;
+	}
+
+private:
+	NetworkDispatchSystem * networkDispatchSystem_;
+
+	ClockSync clock_;
+};
+
+}
+
+#endif /* INCLUDE_SYSTEMS_CLOCKSYNCSYSTEM_HPP_ */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SYSTEMS_INTERPOLATIONSYSTEM_HPP_
+#define INCLUDE_SYSTEMS_INTERPOLATIONSYSTEM_HPP_
+
+#include <cstdint>
+
+#include <Ashley/Ashley.hpp>
+
+namespace PlayPG {
+class ClockSync;
+
+/**
+ * Writes each Interpolated entity's position as it was a short delay ago in server time, so that remote entities
+ * move smoothly between snapshots. Must run before the RenderSystem.
+ *
+ * Playback follows the server's clock minus the delay, or the newest snapshot time until the clock is synchronised.
+ * It advances with the frame time and is gently steered back when the two drift apart, so jitter in packet arrival
+ * doesn't show up as jitter on screen.
+ */
+class InterpolationSystem final : public ashley::IteratingSystem {
+public:
+	// Two snapshots at 20 ticks a second, so one can be lost without having to extrapolate.
+	static constexpr const double DEFAULT_DELAY = 0.1;
+	static constexpr const double DEFAULT_MAX_EXTRAPOLATION = 0.25;
+
+	// The fraction of the playback error corrected each second.
+	static constexpr const double CLOCK_CORRECTION_RATE = 2.0;
+
+	// Further out than this (e.g. after a stall) playback jumps instead of being steered.
+	static constexpr const double CLOCK_SNAP_THRESHOLD = 1.0;
+
+	explicit InterpolationSystem(int64_t priority, double delay = DEFAULT_DELAY, double maxExtrapolation =
+	        DEFAULT_MAX_EXTRAPOLATION);
+	virtual ~InterpolationSystem() = default;
+
+	void update(float deltaTime) override final;
+	void processEntity(ashley::Entity * const entity, float deltaTime) override final;
+
+	/**
+	 * A snapshot taken at serverTime (in seconds) has been applied to the Interpolated entities.
+	 */
+	void onSnapshot(double serverTime);
+
+	/**
+	 * Forgets server time, e.g. after changing map server.
+	 */
+	void reset();
+
+	/**
+	 * The clock must outlive this system; nullptr follows snapshot times instead.
+	 */
+	void setClock(const ClockSync * const clock) {
+		clock_ = clock;
+	}
+
+	double getRenderTime() const {
+		return renderTime_;
+	}
+
+	double getDelay() const {
+		return delay_;
+	}
+
+private:
+	const double delay_;
+	const double maxExtrapolation_;
+
+	const ClockSync * clock_ = nullptr;
+
+	double newestSnapshotTime_ = 0.0;
+	double renderTime_ = 0.0;
+	bool started_ = false;
+};
+
+}
+
+#endif /* INCLUDE_SYSTEMS_INTERPOLATIONSYSTEM_HPP_ */
@@ -33,6 +33,10 @@
 
 #include <Ashley/Ashley.hpp>
 
+#include <glm/vec2.hpp>
+
+#include "MovePrediction.hpp"
+
 namespace Tmx {
 class Map;
 }
@@ -55,6 +59,10 @@ struct Move {
 	const int32_t yTiles;
 };
 
+/**
+ * Moves entities a tile at a time. With networking attached, moves are predicted: they're applied immediately and
+ * sent to the map server, then replayed on top of the server's position if it corrects us.
+ */
 class MovementSystem : public ashley::EntitySystem {
 public:
 	explicit MovementSystem(Map * const map, int64_t priority);
@@ -70,6 +78,25 @@ public:
 	MovementSystem &attachNetworkingSystem(NetworkDispatchSystem * const networkDispatchSystem);
 	MovementSystem &detachNetworkingSystem();
 
+	/**
+	 * The server has accepted every move up to and including sequence.
+	 */
+	void acknowledgeMoves(uint32_t sequence);
+
+	/**
+	 * The server has dealt with every move up to and including sequence and says the predicted entity is at tile.
+	 */
+	void correctMoves(uint32_t sequence, const glm::ivec2 &tile);
+
+	/**
+	 * Forgets unconfirmed moves, e.g. when the predicted entity is removed.
+	 */
+	void resetPrediction();
+
+	const MovePrediction &getPrediction() const {
+		return prediction_;
+	}
+
 	bool networkingAttached() const {
 		return networkDispatchSystem_ != nullptr;
 	}
@@ -84,6 +111,9 @@ private:
 	NetworkDispatchSystem * networkDispatchSystem_;
 
 	std::vector<Move> moves_;
+
+	MovePrediction prediction_;
+	ashley::Entity *predicted_ = nullptr;
 };
 
 }
@@ -30,6 +30,10 @@
 
 #include <cstdint>
 
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
 #include <Ashley/Ashley.hpp>
 
 #include <APG/APGNet.hpp>
@@ -38,19 +42,37 @@
 
 namespace PlayPG {
 
+/**
+ * Sends queued packets each update, then reads whatever the server has sent and hands each packet to the handler
+ * registered for its opcode.
+ */
 class NetworkDispatchSystem : public ashley::EntitySystem {
 public:
-	explicit NetworkDispatchSystem(APG::SDLSocket &socket, int64_t priority);
+	/**
+	 * Called with the socket positioned just after the opcode; must read the rest of the packet. Returns false
+	 * if the packet was malformed.
+	 */
+	using PacketHandler = std::function<bool(APG::Socket &socket)>;
+
+	// Keeps a flood of packets from stalling a frame; the rest are read next frame.
+	static constexpr const uint32_t MAX_PACKETS_PER_UPDATE = 64u;
+
+	explicit NetworkDispatchSystem(APG::Socket &socket, int64_t priority);
 	virtual ~NetworkDispatchSystem() = default;
 
 	void update(float deltaTime) override final;
 
 	void queuePacket(Packet &&packet);
 
+	void setHandler(ServerOpcode opcode, PacketHandler &&handler);
+
 private:
-	APG::SDLSocket &socket_;
+	void receivePackets();
+
+	APG::Socket &socket_;
 
 	std::vector<Packet> packetQueue;
+	std::unordered_map<opcode_type_t, PacketHandler> handlers_;
 };
 
 }
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SYSTEMS_SNAPSHOTSYSTEM_HPP_
+#define INCLUDE_SYSTEMS_SNAPSHOTSYSTEM_HPP_
+
+#include <cstdint>
+
+#include <unordered_map>
+#include <vector>
+
+#include <Ashley/Ashley.hpp>
+
+#include "net/Snapshot.hpp"
+
+namespace APG {
+class Socket;
+class Sprite;
+}
+
+namespace PlayPG {
+class Map;
+class NetworkDispatchSystem;
+class InterpolationSystem;
+
+/**
+ * Reads snapshots from the map server, acknowledges them, and keeps an entity for each remote player in sight,
+ * feeding their positions to the InterpolationSystem. Snapshots are decoded as they arrive but only applied to
+ * entities in update(), so packet handling never adds or removes entities mid-frame.
+ */
+class SnapshotSystem final : public ashley::EntitySystem {
+public:
+	// Must be at least the server's history so that any baseline it picks is still here.
+	static constexpr const uint32_t SNAPSHOT_HISTORY = 32u;
+
+	explicit SnapshotSystem(Map * const map, APG::Sprite * const sprite, InterpolationSystem * const interpolation,
+	        int64_t priority);
+	virtual ~SnapshotSystem() = default;
+
+	void addedToEngine(ashley::Engine &engine) override;
+	void removedFromEngine(ashley::Engine &engine) override;
+
+	void update(float deltaTime) override final;
+
+	SnapshotSystem &attachNetworkingSystem(NetworkDispatchSystem * const networkDispatchSystem);
+	SnapshotSystem &detachNetworkingSystem();
+
+	/**
+	 * The local player is predicted by the MovementSystem, so their own entry in each snapshot is ignored.
+	 */
+	void setLocalGUID(uint64_t guid) {
+		localGUID_ = guid;
+	}
+
+	/**
+	 * Forgets every snapshot and remote entity, e.g. when changing map. Call before the engine's entities are
+	 * removed.
+	 */
+	void reset();
+
+	std::size_t getRemoteEntityCount() const {
+		return remoteEntities_.size();
+	}
+
+private:
+	struct RemoteEntity {
+		ashley::Entity *entity;
+
+		// The last snapshot this entity was in.
+		uint32_t lastSeen;
+	};
+
+	struct ReceivedSnapshot {
+		uint32_t sequence;
+		double serverTime;
+	};
+
+	bool readSnapshot(APG::Socket &socket);
+	void applySnapshot(const ReceivedSnapshot &received);
+
+	Map * map_;
+	APG::Sprite * sprite_;
+	InterpolationSystem * interpolation_;
+
+	NetworkDispatchSystem * networkDispatchSystem_ = nullptr;
+	ashley::Engine * engine_ = nullptr;
+
+	SnapshotRing<std::vector<EntityState>> snapshots_ { SNAPSHOT_HISTORY };
+	uint32_t newestSequence_ = 0u;
+
+	// Decoded since the last update, oldest first.
+	std::vector<ReceivedSnapshot> pending_;
+
+	std::vector<EntityState> decoded_;
+	const std::vector<EntityState> emptyBaseline_;
+
+	std::unordered_map<uint64_t, RemoteEntity> remoteEntities_;
+	uint64_t localGUID_ = 0u;
+};
+
+}
+
+#endif /* INCLUDE_SYSTEMS_SNAPSHOTSYSTEM_HPP_ */
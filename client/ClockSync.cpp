@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <limits>
+
+#include "ClockSync.hpp"
+
+namespace PlayPG {
+
+constexpr const uint32_t ClockSync::FAST_PING_COUNT;
+constexpr const uint64_t ClockSync::FAST_PING_INTERVAL;
+constexpr const uint64_t ClockSync::PING_INTERVAL;
+constexpr const uint64_t ClockSync::PING_TIMEOUT;
+constexpr const std::size_t ClockSync::FILTER_SIZE;
+constexpr const int64_t ClockSync::STEP_THRESHOLD;
+constexpr const double ClockSync::SLEW_GAIN;
+
+bool ClockSync::shouldPing(uint64_t localNow) const {
+	if (pingsSent_ == 0u) {
+		return true;
+	}
+
+	const auto sinceLastPing = localNow - lastPingAt_;
+
+	if (awaitingPong_) {
+		return sinceLastPing >= PING_TIMEOUT;
+	}
+
+	return sinceLastPing >= (pingsSent_ < FAST_PING_COUNT ? FAST_PING_INTERVAL : PING_INTERVAL);
+}
+
+TimePingPacket ClockSync::makePing(uint64_t localNow) {
+	++pingsSent_;
+	lastPingAt_ = localNow;
+	awaitingPong_ = true;
+
+	const auto held = lastPongServerTime_ == 0u ? 0u : localNow - lastPongReceivedAt_;
+
+	if (held > std::numeric_limits<uint32_t>::max()) {
+		// Too stale to be any use to the server.
+		return TimePingPacket(localNow, 0u, 0u);
+	}
+
+	return TimePingPacket(localNow, lastPongServerTime_, static_cast<uint32_t>(held));
+}
+
+bool ClockSync::onPong(uint64_t clientSendTime, uint64_t serverReceiveTime, uint64_t serverSendTime,
+        uint64_t localNow) {
+	if (!awaitingPong_ || clientSendTime != lastPingAt_ || localNow < clientSendTime
+	        || serverSendTime < serverReceiveTime) {
+		return false;
+	}
+
+	awaitingPong_ = false;
+	lastPongServerTime_ = serverSendTime;
+	lastPongReceivedAt_ = localNow;
+
+	const auto serverHeld = serverSendTime - serverReceiveTime;
+	const auto total = localNow - clientSendTime;
+	const uint64_t roundTrip = total > serverHeld ? total - serverHeld : 0u;
+
+	const int64_t outbound = static_cast<int64_t>(serverReceiveTime) - static_cast<int64_t>(clientSendTime);
+	const int64_t inbound = static_cast<int64_t>(serverSendTime) - static_cast<int64_t>(localNow);
+
+	roundTrip_.addSample(roundTrip);
+
+	samples_[nextSample_] = Sample { (outbound + inbound) / 2, roundTrip };
+	nextSample_ = (nextSample_ + 1u) % FILTER_SIZE;
+
+	if (sampleCount_ < FILTER_SIZE) {
+		++sampleCount_;
+	}
+
+	const Sample *best = &samples_[0];
+
+	for (std::size_t i = 1u; i < sampleCount_; ++i) {
+		if (samples_[i].roundTrip < best->roundTrip) {
+			best = &samples_[i];
+		}
+	}
+
+	const auto error = best->offset - offset_;
+
+	if (!synchronised_ || error > STEP_THRESHOLD || error < -STEP_THRESHOLD) {
+		offset_ = best->offset;
+		synchronised_ = true;
+	} else {
+		offset_ += static_cast<int64_t>(static_cast<double>(error) * SLEW_GAIN);
+	}
+
+	return true;
+}
+
+void ClockSync::reset() {
+	*this = ClockSync();
+}
+
+}
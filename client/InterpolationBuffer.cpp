@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "InterpolationBuffer.hpp"
+
+namespace PlayPG {
+
+constexpr const uint32_t InterpolationBuffer::CAPACITY;
+
+void InterpolationBuffer::push(double time, const glm::vec2 &position) {
+	if (count_ > 0u && time <= at(count_ - 1u).time) {
+		return;
+	}
+
+	if (count_ == CAPACITY) {
+		first_ = (first_ + 1u) % CAPACITY;
+		--count_;
+	}
+
+	samples_[(first_ + count_) % CAPACITY] = Sample { time, position };
+	++count_;
+}
+
+bool InterpolationBuffer::sample(double time, double maxExtrapolation, glm::vec2 *position) const {
+	if (count_ == 0u) {
+		return false;
+	}
+
+	const auto &oldest = at(0u);
+
+	if (time <= oldest.time) {
+		*position = oldest.position;
+		return true;
+	}
+
+	const auto &newest = at(count_ - 1u);
+
+	if (time >= newest.time) {
+		if (count_ == 1u) {
+			*position = newest.position;
+			return true;
+		}
+
+		const auto &previous = at(count_ - 2u);
+		const double ahead = std::min(time - newest.time, std::max(maxExtrapolation, 0.0));
+		const auto t = static_cast<float>(ahead / (newest.time - previous.time));
+
+		*position = newest.position + (newest.position - previous.position) * t;
+		return true;
+	}
+
+	// The buffer is small and usually sampled near its newest end, so search backwards.
+	std::size_t after = count_ - 1u;
+
+	while (at(after - 1u).time > time) {
+		--after;
+	}
+
+	const auto &from = at(after - 1u);
+	const auto &to = at(after);
+	const auto t = static_cast<float>((time - from.time) / (to.time - from.time));
+
+	*position = from.position + (to.position - from.position) * t;
+	return true;
+}
+
+}
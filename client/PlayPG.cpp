@@ -80,7 +80,7 @@ bool PlayPG::init() {
 
 	engine = std::make_unique<ashley::Engine>();
 
-	auto movementSystem = engine->addSystem<MovementSystem>(mapOutdoor.get(), 6000);
+	movementSystem = engine->addSystem<MovementSystem>(mapOutdoor.get(), 6000);
 
 	engine->addSystem<InputSystem>(inputManager.get(), movementSystem, 5000);
 	engine->addSystem<CameraFocusSystem>(camera.get(), 7500);
@@ -195,6 +195,7 @@ bool PlayPG::doLogin() {
 
 void PlayPG::changeToWorld(const std::unique_ptr<Map> &map) {
 	engine->removeAllEntities();
+	movementSystem->resetPrediction();
 
 	{
 		auto frontLayerEntities = MapUtil::generateFrontLayerEntities(*map, outdoorRenderer.get());
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdint>
+
+#include <Ashley/Ashley.hpp>
+
+#include <APG/APGNet.hpp>
+
+#include "systems/ClockSyncSystem.hpp"
+#include "systems/NetworkDispatchSystem.hpp"
+#include "util/Util.hpp"
+
+namespace PlayPG {
+
+ClockSyncSystem::ClockSyncSystem(int64_t priority) :
+		        ClockSyncSystem(nullptr, priority) {
+}
+
+ClockSyncSystem::ClockSyncSystem(NetworkDispatchSystem * const networkDispatchSystem, int64_t priority) :
+		        EntitySystem(priority),
+		        networkDispatchSystem_ { nullptr } {
+	attachNetworkingSystem(networkDispatchSystem);
+}
+
+void ClockSyncSystem::update(float deltaTime) {
+	if (networkDispatchSystem_ == nullptr) {
+		return;
+	}
+
+	const auto now = util::monotonicMicros();
+
+	if (clock_.shouldPing(now)) {
+		networkDispatchSystem_->queuePacket(clock_.makePing(now));
+	}
+}
+
+ClockSyncSystem &ClockSyncSystem::attachNetworkingSystem(NetworkDispatchSystem * const networkDispatchSystem) {
+	if (networkDispatchSystem_ != nullptr) {
+		detachNetworkingSystem();
+	}
+
+	networkDispatchSystem_ = networkDispatchSystem;
+
+	if (networkDispatchSystem_ == nullptr) {
+		return *this;
+	}
+
+	networkDispatchSystem_->setHandler(ServerOpcode::TIME_PONG, [this](APG::Socket &socket) {
+		if (socket.recv(24) != 24) {
+			return false;
+		}
+
+		const auto clientSendTime = socket.getLong();
+		const auto serverReceiveTime = socket.getLong();
+		const auto serverSendTime = socket.getLong();
+
+		// A pong we've given up on isn't an error.
+		clock_.onPong(clientSendTime, serverReceiveTime, serverSendTime, util::monotonicMicros());
+		return true;
+	});
+
+	return *this;
+}
+
+ClockSyncSystem &ClockSyncSystem::detachNetworkingSystem() {
+	if (networkDispatchSystem_ != nullptr) {
+		networkDispatchSystem_->setHandler(ServerOpcode::TIME_PONG, nullptr);
+	}
+
+	networkDispatchSystem_ = nullptr;
+
+	// The next server might have a different clock.
+	clock_.reset();
+	return *this;
+}
+
+}
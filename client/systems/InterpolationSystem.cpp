@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+
+#include <algorithm>
+
+#include <Ashley/Ashley.hpp>
+
+#include "ClockSync.hpp"
+#include "components/Interpolated.hpp"
+#include "components/Position.hpp"
+#include "systems/InterpolationSystem.hpp"
+
+namespace PlayPG {
+
+constexpr const double InterpolationSystem::DEFAULT_DELAY;
+constexpr const double InterpolationSystem::DEFAULT_MAX_EXTRAPOLATION;
+constexpr const double InterpolationSystem::CLOCK_CORRECTION_RATE;
+constexpr const double InterpolationSystem::CLOCK_SNAP_THRESHOLD;
+
+InterpolationSystem::InterpolationSystem(int64_t priority, double delay, double maxExtrapolation) :
+		        IteratingSystem(ashley::Family::getFor( { typeid(Interpolated), typeid(Position) }), priority),
+		        delay_ { delay },
+		        maxExtrapolation_ { maxExtrapolation } {
+}
+
+void InterpolationSystem::update(float deltaTime) {
+	// Nothing to play back until the first snapshot.
+	if (!started_) {
+		return;
+	}
+
+	renderTime_ += deltaTime;
+
+	double serverTime = newestSnapshotTime_;
+
+	if (clock_ != nullptr && clock_->isSynchronised()) {
+		serverTime = static_cast<double>(clock_->serverTimeNow()) / 1000000.0;
+	}
+
+	const double error = (serverTime - delay_) - renderTime_;
+
+	if (std::abs(error) > CLOCK_SNAP_THRESHOLD) {
+		renderTime_ += error;
+	} else {
+		renderTime_ += error * std::min(1.0, deltaTime * CLOCK_CORRECTION_RATE);
+	}
+
+	IteratingSystem::update(deltaTime);
+}
+
+void InterpolationSystem::processEntity(ashley::Entity * const entity, float deltaTime) {
+	const auto positionMapper = ashley::ComponentMapper<Position>::getMapper();
+	const auto interpolatedMapper = ashley::ComponentMapper<Interpolated>::getMapper();
+
+	const auto position = positionMapper.get(entity);
+	const auto interpolated = interpolatedMapper.get(entity);
+
+	interpolated->buffer.sample(renderTime_, maxExtrapolation_, &position->p);
+}
+
+void InterpolationSystem::onSnapshot(double serverTime) {
+	if (!started_) {
+		renderTime_ = serverTime - delay_;
+		started_ = true;
+	}
+
+	newestSnapshotTime_ = std::max(newestSnapshotTime_, serverTime);
+}
+
+void InterpolationSystem::reset() {
+	newestSnapshotTime_ = 0.0;
+	renderTime_ = 0.0;
+	started_ = false;
+}
+
+}
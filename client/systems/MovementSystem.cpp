@@ -49,7 +49,8 @@ MovementSystem::MovementSystem(Map * const map, int64_t priority) :
 
 MovementSystem::MovementSystem(Map * const map, NetworkDispatchSystem * const networkDispatchSystem, int64_t priority) :
 		        EntitySystem(priority),
-		        map_ { map } {
+		        map_ { map },
+		        networkDispatchSystem_ { nullptr } {
 	attachNetworkingSystem(networkDispatchSystem);
 }
 
@@ -62,30 +63,102 @@ void MovementSystem::update(float deltaTime) {
 		const glm::vec2 destination = { position->p.x + move.xTiles * map_->getTileWidth(), position->p.y
 		        + move.yTiles * map_->getTileHeight() };
 
-		if (!map_->isSolidAtCoord(destination)) {
-			position->p = destination;
+		// The server would only reject a move into a wall, so don't bother sending it.
+		if (map_->isSolidAtCoord(destination)) {
+			continue;
 		}
 
-		if(networkDispatchSystem_ != nullptr) {
-			networkDispatchSystem_->queuePacket(MovementPacket(move));
+		if (networkDispatchSystem_ != nullptr) {
+			const auto sequence = prediction_.record(glm::ivec2 { move.xTiles, move.yTiles });
+
+			// We're too far ahead of the server; wait for it to catch up.
+			if (sequence == 0u) {
+				continue;
+			}
+
+			predicted_ = move.entity;
+
+			networkDispatchSystem_->queuePacket(
+			        MovementPacket(sequence, static_cast<int16_t>(move.xTiles), static_cast<int16_t>(move.yTiles)));
 		}
+
+		position->p = destination;
 	}
 
 	moves_.clear();
 }
 
 MovementSystem &MovementSystem::attachNetworkingSystem(NetworkDispatchSystem * const networkDispatchSystem) {
+	if (networkDispatchSystem_ != nullptr) {
+		detachNetworkingSystem();
+	}
+
 	networkDispatchSystem_ = networkDispatchSystem;
 
+	if (networkDispatchSystem_ == nullptr) {
+		return *this;
+	}
+
+	networkDispatchSystem_->setHandler(ServerOpcode::MOVE_ACK, [this](APG::Socket &socket) {
+		if (socket.recv(4) != 4) {
+			return false;
+		}
+
+		acknowledgeMoves(socket.getInt());
+		return true;
+	});
+
+	networkDispatchSystem_->setHandler(ServerOpcode::MOVE_CORRECTION, [this](APG::Socket &socket) {
+		if (socket.recv(12) != 12) {
+			return false;
+		}
+
+		const auto sequence = socket.getInt();
+		const auto x = static_cast<int32_t>(socket.getInt());
+		const auto y = static_cast<int32_t>(socket.getInt());
+
+		correctMoves(sequence, glm::ivec2 { x, y });
+		return true;
+	});
+
 	return *this;
 }
 
 MovementSystem &MovementSystem::detachNetworkingSystem() {
+	if (networkDispatchSystem_ != nullptr) {
+		networkDispatchSystem_->setHandler(ServerOpcode::MOVE_ACK, nullptr);
+		networkDispatchSystem_->setHandler(ServerOpcode::MOVE_CORRECTION, nullptr);
+	}
+
 	networkDispatchSystem_ = nullptr;
+	resetPrediction();
 
 	return *this;
 }
 
+void MovementSystem::acknowledgeMoves(uint32_t sequence) {
+	prediction_.acknowledge(sequence);
+}
+
+void MovementSystem::correctMoves(uint32_t sequence, const glm::ivec2 &tile) {
+	if (predicted_ == nullptr) {
+		prediction_.acknowledge(sequence);
+		return;
+	}
+
+	const auto corrected = prediction_.reconcile(sequence, tile, [this](const glm::ivec2 &next) {
+		return !map_->isSolidAtTile(next);
+	});
+
+	const auto &position = ashley::ComponentMapper<Position>::getMapper().get(predicted_);
+	position->p = glm::vec2(corrected.x * map_->getTileWidth(), corrected.y * map_->getTileHeight());
+}
+
+void MovementSystem::resetPrediction() {
+	prediction_.reset();
+	predicted_ = nullptr;
+}
+
 void MovementSystem::addMove(Move &&move) {
 	moves_.emplace_back(std::move(move));
 }
@@ -25,11 +25,18 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <utility>
+
+#include <APG/core/APGeasylogging.hpp>
+
 #include "systems/NetworkDispatchSystem.hpp"
+#include "util/Util.hpp"
 
 namespace PlayPG {
 
-NetworkDispatchSystem::NetworkDispatchSystem(APG::SDLSocket &socket, int64_t priority) :
+constexpr const uint32_t NetworkDispatchSystem::MAX_PACKETS_PER_UPDATE;
+
+NetworkDispatchSystem::NetworkDispatchSystem(APG::Socket &socket, int64_t priority) :
 		        EntitySystem(priority),
 		        socket_ { socket } {
 
@@ -46,6 +53,39 @@ void NetworkDispatchSystem::update(float deltaTime) {
 	}
 
 	packetQueue.clear();
+
+	receivePackets();
+}
+
+void NetworkDispatchSystem::setHandler(ServerOpcode opcode, PacketHandler &&handler) {
+	handlers_[util::to_integral(opcode)] = std::move(handler);
+}
+
+void NetworkDispatchSystem::receivePackets() {
+	const auto logger = el::Loggers::getLogger("PlayPG");
+
+	for (uint32_t i = 0u; i < MAX_PACKETS_PER_UPDATE && socket_.hasActivity(); ++i) {
+		socket_.clear();
+
+		if (socket_.recv(2) != 2) {
+			logger->error("Lost connection to the server.");
+			return;
+		}
+
+		const auto opcode = socket_.getShort();
+		const auto handler = handlers_.find(opcode);
+
+		if (handler == handlers_.end() || !handler->second) {
+			// Packets aren't length-prefixed, so there's no way to skip this one and find the next.
+			logger->error("Received unhandled opcode %v from the server; can't read any further.", opcode);
+			socket_.disconnect();
+			return;
+		}
+
+		if (!handler->second(socket_)) {
+			logger->error("Received a malformed packet with opcode %v from the server.", opcode);
+		}
+	}
 }
 
 }
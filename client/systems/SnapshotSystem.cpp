@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdint>
+
+#include <string>
+
+#include <Ashley/Ashley.hpp>
+
+#include <APG/APGNet.hpp>
+
+#include "components/Interpolated.hpp"
+#include "components/Position.hpp"
+#include "components/Renderable.hpp"
+#include "systems/SnapshotSystem.hpp"
+#include "systems/InterpolationSystem.hpp"
+#include "systems/NetworkDispatchSystem.hpp"
+#include "net/packets/SnapshotPackets.hpp"
+#include "util/BitStream.hpp"
+#include "Map.hpp"
+
+namespace PlayPG {
+
+constexpr const uint32_t SnapshotSystem::SNAPSHOT_HISTORY;
+
+SnapshotSystem::SnapshotSystem(Map * const map, APG::Sprite * const sprite, InterpolationSystem * const interpolation,
+        int64_t priority) :
+		        EntitySystem(priority),
+		        map_ { map },
+		        sprite_ { sprite },
+		        interpolation_ { interpolation } {
+	pending_.reserve(SNAPSHOT_HISTORY);
+}
+
+void SnapshotSystem::addedToEngine(ashley::Engine &engine) {
+	engine_ = &engine;
+}
+
+void SnapshotSystem::removedFromEngine(ashley::Engine &engine) {
+	reset();
+	engine_ = nullptr;
+}
+
+void SnapshotSystem::update(float deltaTime) {
+	for (const auto &received : pending_) {
+		applySnapshot(received);
+	}
+
+	pending_.clear();
+}
+
+SnapshotSystem &SnapshotSystem::attachNetworkingSystem(NetworkDispatchSystem * const networkDispatchSystem) {
+	if (networkDispatchSystem_ != nullptr) {
+		detachNetworkingSystem();
+	}
+
+	networkDispatchSystem_ = networkDispatchSystem;
+
+	if (networkDispatchSystem_ != nullptr) {
+		networkDispatchSystem_->setHandler(ServerOpcode::SNAPSHOT, [this](APG::Socket &socket) {
+			return readSnapshot(socket);
+		});
+	}
+
+	return *this;
+}
+
+SnapshotSystem &SnapshotSystem::detachNetworkingSystem() {
+	if (networkDispatchSystem_ != nullptr) {
+		networkDispatchSystem_->setHandler(ServerOpcode::SNAPSHOT, nullptr);
+	}
+
+	networkDispatchSystem_ = nullptr;
+	return *this;
+}
+
+void SnapshotSystem::reset() {
+	if (engine_ != nullptr) {
+		for (const auto &remote : remoteEntities_) {
+			engine_->removeEntity(remote.second.entity);
+		}
+	}
+
+	remoteEntities_.clear();
+	pending_.clear();
+
+	snapshots_ = SnapshotRing<std::vector<EntityState>>(SNAPSHOT_HISTORY);
+	newestSequence_ = 0u;
+	interpolation_->reset();
+}
+
+bool SnapshotSystem::readSnapshot(APG::Socket &socket) {
+	if (socket.recv(20) != 20) {
+		return false;
+	}
+
+	const auto sequence = socket.getInt();
+	const auto baseline = socket.getInt();
+	const auto serverTime = socket.getLong();
+	const auto packedFormat = socket.getShort();
+	const auto deltaLength = socket.getShort();
+
+	SnapshotFormat format;
+
+	if (!SnapshotFormat::unpack(packedFormat, &format)) {
+		return false;
+	}
+
+	if (socket.recv(deltaLength) != deltaLength) {
+		return false;
+	}
+
+	const auto delta = socket.getStringByLength(deltaLength);
+
+	// Snapshots only ever arrive in order over TCP, but a newer one makes an older one useless anyway.
+	if (sequence <= newestSequence_) {
+		return true;
+	}
+
+	const std::vector<EntityState> *baselineStates = &emptyBaseline_;
+
+	if (baseline != 0u) {
+		baselineStates = snapshots_.find(baseline);
+
+		// Can't be decoded; the server will fall back to a full snapshot once our acks stop matching its history.
+		if (baselineStates == nullptr) {
+			return true;
+		}
+	}
+
+	BitReader reader(reinterpret_cast<const uint8_t *>(delta.data()), delta.size());
+
+	if (!decodeSnapshotDelta(*baselineStates, reader, format, decoded_)) {
+		return false;
+	}
+
+	// Decoded separately because recording can reuse the slot the baseline is in.
+	snapshots_.record(sequence) = decoded_;
+	newestSequence_ = sequence;
+
+	// Too many to apply in one frame; the newest ones have everything that matters.
+	if (pending_.size() == SNAPSHOT_HISTORY) {
+		pending_.erase(pending_.begin());
+	}
+
+	pending_.emplace_back(ReceivedSnapshot { sequence, static_cast<double>(serverTime) / 1000000.0 });
+
+	if (networkDispatchSystem_ != nullptr) {
+		networkDispatchSystem_->queuePacket(SnapshotAckPacket(sequence));
+	}
+
+	return true;
+}
+
+void SnapshotSystem::applySnapshot(const ReceivedSnapshot &received) {
+	const auto states = snapshots_.find(received.sequence);
+
+	if (states == nullptr || engine_ == nullptr) {
+		return;
+	}
+
+	const auto interpolatedMapper = ashley::ComponentMapper<Interpolated>::getMapper();
+	const glm::vec2 tileSize(map_->getTileWidth(), map_->getTileHeight());
+
+	for (const auto &state : *states) {
+		if (state.guid == localGUID_) {
+			continue;
+		}
+
+		const glm::vec2 position = glm::vec2(state.tile) * tileSize;
+		auto it = remoteEntities_.find(state.guid);
+
+		if (it == remoteEntities_.end()) {
+			auto entity = engine_->addEntity();
+			entity->add<Position>(position.x, position.y);
+			entity->add<Renderable>(sprite_);
+			entity->add<Interpolated>();
+
+			it = remoteEntities_.emplace(state.guid, RemoteEntity { entity, received.sequence }).first;
+		}
+
+		it->second.lastSeen = received.sequence;
+
+		// Every entity gets a sample for every snapshot, even if it hasn't moved, so that playback interpolates
+		// towards where it stopped rather than extrapolating its last movement.
+		interpolatedMapper.get(it->second.entity)->buffer.push(received.serverTime, position);
+	}
+
+	for (auto it = remoteEntities_.begin(); it != remoteEntities_.end();) {
+		if (it->second.lastSeen != received.sequence) {
+			engine_->removeEntity(it->second.entity);
+			it = remoteEntities_.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	interpolation_->onSnapshot(received.serverTime);
+}
+
+}
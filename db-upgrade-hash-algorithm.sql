@@ -0,0 +1,7 @@
+-- Upgrades a database created before map hashes recorded their algorithm, keeping every row.
+-- Existing hashes are MD5; the login server rehashes them with the current algorithm the next time it starts.
+-- Not needed for databases created from db.sql.
+
+ALTER TABLE `locations`
+  CHANGE `knownMD5Hash` `knownHash` VARCHAR(64) NOT NULL,
+  ADD `hashAlgorithm` VARCHAR(16) NOT NULL DEFAULT 'md5' AFTER `knownHash`;
@@ -43,7 +43,8 @@ CREATE TABLE `locations` (
 
   `locationName` VARCHAR(50) NOT NULL,
   `knownFileName` VARCHAR(255) NOT NULL,
-  `knownMD5Hash` VARCHAR(25) NOT NULL,
+  `knownHash` VARCHAR(64) NOT NULL,
+  `hashAlgorithm` VARCHAR(16) NOT NULL,
 
   `version` int(11) NOT NULL,
 
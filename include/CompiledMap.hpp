@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_COMPILEDMAP_HPP_
+#define INCLUDE_COMPILEDMAP_HPP_
+
+#include <cstdint>
+
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <APG/core/APGeasylogging.hpp>
+
+#include "MapHeader.hpp"
+#include "util/MappedFile.hpp"
+
+namespace PlayPG {
+
+class Map;
+
+/**
+ * The fixed-size header at the start of every compiled (.ppg) map file.
+ *
+ * All offsets are in bytes from the start of the file and every section starts on an 8 byte boundary
+ * so that the file can be used in place after being mapped into memory. Values are stored in the byte
+ * order of the machine that compiled the map; endianCheck is used to reject files from a machine with
+ * a different byte order.
+ */
+struct CompiledMapHeader {
+	char magic[4];
+	uint32_t endianCheck;
+	uint32_t formatVersion;
+	uint32_t mapVersion;
+
+	uint32_t width;
+	uint32_t height;
+	uint32_t tileWidth;
+	uint32_t tileHeight;
+
+	// Each row of the collision grid is padded to a whole number of 64-bit words.
+	uint32_t wordsPerRow;
+
+	uint32_t interestingCount;
+	uint32_t spawnCount;
+	uint32_t objectCount;
+
+	uint32_t nameLength;
+	uint32_t sourceHashLength;
+	uint32_t stringTableLength;
+	uint32_t reserved;
+
+	uint64_t nameOffset;
+	uint64_t sourceHashOffset;
+	uint64_t solidOffset;
+	uint64_t interestingOffset;
+	uint64_t spawnOffset;
+	uint64_t objectOffset;
+	uint64_t stringTableOffset;
+};
+
+static_assert(std::is_standard_layout<CompiledMapHeader>::value, "CompiledMapHeader must be standard layout.");
+static_assert(sizeof(CompiledMapHeader) == 120u, "CompiledMapHeader must have no padding.");
+
+/**
+ * An object rectangle in pixel coordinates. The name is stored in the string table.
+ */
+struct CompiledMapObject {
+	float x;
+	float y;
+	float width;
+	float height;
+
+	uint32_t nameOffset;
+	uint32_t nameLength;
+};
+
+static_assert(sizeof(CompiledMapObject) == 24u, "CompiledMapObject must have no padding.");
+
+/**
+ * A read-only, memory mapped compiled map. Produced by CompiledMap::compile from an already loaded Map,
+ * and loaded using CompiledMap::fromFile.
+ *
+ * Compiled maps contain only what the server needs: the name and version, a bit-packed collision grid,
+ * the indices of interesting and spawn tiles and the object rectangles.
+ */
+class CompiledMap final {
+public:
+	static constexpr const char * const FILE_EXTENSION = ".ppg";
+	static constexpr const uint32_t FORMAT_VERSION = 2u; // 2: source hashes are xxh64 rather than MD5
+	static constexpr const uint32_t ENDIAN_CHECK = 0x01020304u;
+
+	static bool hasCompiledExtension(const std::string &fileName);
+
+	/**
+	 * Writes the given map to outputFile in the compiled format. sourceHash should identify the TMX
+	 * file the map was loaded from, and is stored so that servers using the compiled file agree on a
+	 * hash with servers using the original file.
+	 */
+	static bool compile(const Map &map, const std::string &sourceHash, const std::string &outputFile,
+	        el::Logger * const logger);
+
+	/**
+	 * Maps the given file into memory and validates it. Returns nullptr if the file is missing,
+	 * truncated or was written by an incompatible version.
+	 */
+	static std::unique_ptr<CompiledMap> fromFile(const std::string &fileName, el::Logger * const logger);
+
+	/**
+	 * Reads only the header of the given compiled map, for servers which don't need the map's contents.
+	 */
+	static MapHeader readHeader(const std::string &fileName, el::Logger * const logger);
+
+	~CompiledMap() = default;
+
+	const CompiledMapHeader &getHeader() const {
+		return *header_;
+	}
+
+	std::string getName() const;
+	std::string getSourceHash() const;
+
+	const std::string &getFileName() const {
+		return file_->getFileName();
+	}
+
+	const uint64_t *getSolidWords() const {
+		return sectionAt<uint64_t>(header_->solidOffset);
+	}
+
+	const uint32_t *getInterestingTiles() const {
+		return sectionAt<uint32_t>(header_->interestingOffset);
+	}
+
+	const uint32_t *getSpawnTiles() const {
+		return sectionAt<uint32_t>(header_->spawnOffset);
+	}
+
+	const CompiledMapObject *getObjects() const {
+		return sectionAt<CompiledMapObject>(header_->objectOffset);
+	}
+
+	std::string getObjectName(const CompiledMapObject &object) const;
+
+	/**
+	 * The underlying file; Maps can hold on to this to keep the mapping alive.
+	 */
+	std::shared_ptr<const MappedFile> getMappedFile() const {
+		return file_;
+	}
+
+private:
+	explicit CompiledMap(std::shared_ptr<const MappedFile> &&file);
+
+	static bool validate(const MappedFile &file, el::Logger * const logger);
+
+	template<typename T> const T *sectionAt(uint64_t offset) const {
+		return reinterpret_cast<const T *>(file_->data() + offset);
+	}
+
+	std::shared_ptr<const MappedFile> file_;
+	const CompiledMapHeader * header_;
+};
+
+}
+
+#endif /* INCLUDE_COMPILEDMAP_HPP_ */
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_ENTITYGRID_HPP_
+#define INCLUDE_ENTITYGRID_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+namespace PlayPG {
+
+class Map;
+
+/**
+ * A read-only view of a contiguous run of entity IDs.
+ */
+template<typename T> class ContiguousSpan final {
+public:
+	explicit ContiguousSpan(const T *first = nullptr, std::size_t size = 0u) :
+			        first_ { first },
+			        size_ { size } {
+	}
+
+	const T *begin() const {
+		return first_;
+	}
+
+	const T *end() const {
+		return first_ + size_;
+	}
+
+	const T &operator[](std::size_t index) const {
+		return first_[index];
+	}
+
+	std::size_t size() const {
+		return size_;
+	}
+
+	bool empty() const {
+		return size_ == 0u;
+	}
+
+private:
+	const T *first_;
+	std::size_t size_;
+};
+
+/**
+ * Indexes entities by the tile they stand on, so that "who is near (x, y)?" doesn't need a scan over every
+ * entity on a map.
+ *
+ * The map is split into square cells of cellSize tiles. Each cell stores the IDs of its entities in one
+ * contiguous array with their tile positions alongside, so a query touches a handful of small arrays.
+ * Inserting, moving and removing are O(1); removing swaps the last entity in a cell into the gap, so order
+ * within a cell isn't stable.
+ */
+class EntityGrid final {
+public:
+	using id_type = uint64_t;
+	using IdSpan = ContiguousSpan<id_type>;
+
+	static constexpr const int32_t DEFAULT_CELL_SIZE = 8;
+
+	explicit EntityGrid(const Map &map, int32_t cellSize = DEFAULT_CELL_SIZE);
+	explicit EntityGrid(int32_t widthInTiles, int32_t heightInTiles, int32_t cellSize = DEFAULT_CELL_SIZE);
+	~EntityGrid() = default;
+
+	/**
+	 * Returns false if the ID is already present or the tile is outside the map.
+	 */
+	bool insert(id_type id, const glm::ivec2 &tile);
+
+	/**
+	 * Returns false if the ID isn't present or the tile is outside the map, in which case nothing changes.
+	 */
+	bool move(id_type id, const glm::ivec2 &tile);
+
+	bool remove(id_type id);
+	void clear();
+
+	bool contains(id_type id) const {
+		return entries_.find(id) != entries_.end();
+	}
+
+	/**
+	 * Sets *tile to the position of the entity and returns true if it's present.
+	 */
+	bool getPosition(id_type id, glm::ivec2 * tile) const;
+
+	/**
+	 * Replaces the contents of out with the IDs of every entity whose tile is inside the rectangle, returning
+	 * a span over them. Reusing out between calls avoids allocating.
+	 */
+	IdSpan queryRect(int32_t x, int32_t y, int32_t w, int32_t h, std::vector<id_type> &out) const;
+
+	/**
+	 * As queryRect, but for every entity within radius tiles (Euclidean distance) of centre.
+	 */
+	IdSpan queryRadius(const glm::ivec2 &centre, int32_t radius, std::vector<id_type> &out) const;
+
+	/**
+	 * Calls func(id, tile) for every entity whose tile is inside the rectangle, without allocating.
+	 */
+	template<typename F> void forEachInRect(int32_t x, int32_t y, int32_t w, int32_t h, F &&func) const {
+		const int32_t x1 = std::min(x + w, widthInTiles_) - 1;
+		const int32_t y1 = std::min(y + h, heightInTiles_) - 1;
+		const int32_t x0 = std::max(x, 0);
+		const int32_t y0 = std::max(y, 0);
+
+		if (x0 > x1 || y0 > y1) {
+			return;
+		}
+
+		for (int32_t cy = y0 / cellSize_; cy <= y1 / cellSize_; ++cy) {
+			for (int32_t cx = x0 / cellSize_; cx <= x1 / cellSize_; ++cx) {
+				const auto &cell = cells_[cy * cellsWide_ + cx];
+
+				for (std::size_t i = 0u; i < cell.ids.size(); ++i) {
+					const auto &tile = cell.tiles[i];
+
+					if (tile.x >= x0 && tile.x <= x1 && tile.y >= y0 && tile.y <= y1) {
+						func(cell.ids[i], tile);
+					}
+				}
+			}
+		}
+	}
+
+	/**
+	 * Calls func(id, tile) for every entity within radius tiles of centre, without allocating.
+	 */
+	template<typename F> void forEachInRadius(const glm::ivec2 &centre, int32_t radius, F &&func) const {
+		const int64_t radiusSquared = static_cast<int64_t>(radius) * radius;
+
+		forEachInRect(centre.x - radius, centre.y - radius, radius * 2 + 1, radius * 2 + 1,
+		        [&](id_type id, const glm::ivec2 &tile) {
+			        const int64_t dx = tile.x - centre.x;
+			        const int64_t dy = tile.y - centre.y;
+
+			        if (dx * dx + dy * dy <= radiusSquared) {
+				        func(id, tile);
+			        }
+		        });
+	}
+
+	/**
+	 * The IDs of every entity in the given cell, in no particular order.
+	 */
+	IdSpan cellEntities(int32_t cellX, int32_t cellY) const;
+
+	std::size_t size() const {
+		return entries_.size();
+	}
+
+	int32_t getCellSize() const {
+		return cellSize_;
+	}
+
+	int32_t getCellsWide() const {
+		return cellsWide_;
+	}
+
+	int32_t getCellsHigh() const {
+		return cellsHigh_;
+	}
+
+	int32_t getWidthInTiles() const {
+		return widthInTiles_;
+	}
+
+	int32_t getHeightInTiles() const {
+		return heightInTiles_;
+	}
+
+private:
+	struct Cell {
+		std::vector<id_type> ids;
+		std::vector<glm::ivec2> tiles;
+	};
+
+	struct Entry {
+		uint32_t cell;
+		uint32_t slot;
+	};
+
+	bool isInside(const glm::ivec2 &tile) const {
+		return tile.x >= 0 && tile.y >= 0 && tile.x < widthInTiles_ && tile.y < heightInTiles_;
+	}
+
+	uint32_t cellIndexFor(const glm::ivec2 &tile) const {
+		return static_cast<uint32_t>((tile.y / cellSize_) * cellsWide_ + (tile.x / cellSize_));
+	}
+
+	void addToCell(id_type id, const glm::ivec2 &tile, Entry &entry);
+	void removeFromCell(const Entry &entry);
+
+	int32_t widthInTiles_;
+	int32_t heightInTiles_;
+
+	int32_t cellSize_;
+	int32_t cellsWide_;
+	int32_t cellsHigh_;
+
+	std::vector<Cell> cells_;
+	std::unordered_map<id_type, Entry> entries_;
+};
+
+}
+
+#endif /* INCLUDE_ENTITYGRID_HPP_ */
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_FIELDOFVIEW_HPP_
+#define INCLUDE_FIELDOFVIEW_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "util/BitGrid.hpp"
+#include "util/ThreadPool.hpp"
+
+namespace PlayPG {
+
+/**
+ * The set of tiles visible from one tile out to a given radius, computed with symmetric shadowcasting
+ * over a grid of opaque tiles. Symmetric means that if B is visible from A then A is visible from B.
+ *
+ * Opaque tiles which border visible space are visible themselves (you can see a wall), and every tile
+ * within the radius measured as a circle is considered.
+ */
+class FieldOfView final {
+public:
+	// Larger radii are clamped to this.
+	static constexpr const int32_t MAX_RADIUS = 255;
+
+	FieldOfView(const BitGrid &opaque, const glm::ivec2 &origin, int32_t radius);
+	~FieldOfView() = default;
+
+	bool isVisible(int32_t x, int32_t y) const {
+		const int32_t localX = x - origin_.x + radius_;
+		const int32_t localY = y - origin_.y + radius_;
+
+		if (localX < 0 || localY < 0 || localX > 2 * radius_ || localY > 2 * radius_) {
+			return false;
+		}
+
+		return visible_.get(static_cast<uint32_t>(localX), static_cast<uint32_t>(localY));
+	}
+
+	/**
+	 * Calls func(x, y) with the map coordinates of each visible tile.
+	 */
+	template<typename F> void forEachVisible(F &&func) const {
+		visible_.forEachSet([this, &func](uint32_t x, uint32_t y) {
+			func(static_cast<int32_t>(x) + origin_.x - radius_, static_cast<int32_t>(y) + origin_.y - radius_);
+		});
+	}
+
+	/**
+	 * The visible tiles as a (2 * radius + 1) square bitset centred on the origin.
+	 */
+	const BitGrid &getVisibleGrid() const {
+		return visible_;
+	}
+
+	const glm::ivec2 &getOrigin() const {
+		return origin_;
+	}
+
+	int32_t getRadius() const {
+		return radius_;
+	}
+
+	uint32_t getVisibleCount() const {
+		return visibleCount_;
+	}
+
+private:
+	void reveal(const BitGrid &opaque, int32_t x, int32_t y);
+
+	glm::ivec2 origin_;
+	int32_t radius_;
+
+	BitGrid visible_;
+	uint32_t visibleCount_ = 0u;
+};
+
+/**
+ * Returns true if nothing opaque lies on the straight line between the centres of from and to. The end
+ * tiles themselves may be opaque. Where the line passes exactly between two tiles, it's only blocked if
+ * both are opaque, so hasLineOfSight(a, b) == hasLineOfSight(b, a).
+ */
+bool hasLineOfSight(const BitGrid &opaque, const glm::ivec2 &from, const glm::ivec2 &to);
+
+/**
+ * Caches fields of view for one version of a map, keyed on origin and radius, so that an entity which
+ * hasn't moved doesn't need its visibility recomputed every tick. The least recently used entries are
+ * dropped once the cache is full.
+ *
+ * The opaque grid is copied when the cache is made, so it won't see later edits such as an instance's
+ * TerrainOverlay; anything whose terrain can change needs a cache of its own.
+ *
+ * Safe to use from several threads at once.
+ */
+class VisibilityCache final {
+public:
+	static constexpr const std::size_t DEFAULT_CAPACITY = 4096u;
+	struct Viewer {
+		glm::ivec2 origin;
+		int32_t radius;
+	};
+
+	explicit VisibilityCache(const BitGrid &opaque, std::size_t capacity = DEFAULT_CAPACITY);
+	~VisibilityCache() = default;
+
+	/**
+	 * Returns the cached field of view for origin and radius, computing it on the calling thread if needed.
+	 */
+	std::shared_ptr<const FieldOfView> get(const glm::ivec2 &origin, int32_t radius);
+
+	/**
+	 * Returns the field of view for every viewer (e.g. every player on the map this tick) in the same
+	 * order, computing any which aren't cached on the pool's worker threads. Blocks until all are done, so
+	 * must not be called from a task running on the same pool.
+	 */
+	std::vector<std::shared_ptr<const FieldOfView>> getAll(const std::vector<Viewer> &viewers, ThreadPool &pool);
+
+	bool hasLineOfSight(const glm::ivec2 &from, const glm::ivec2 &to) const {
+		return PlayPG::hasLineOfSight(opaque_, from, to);
+	}
+
+	const BitGrid &getOpaqueGrid() const {
+		return opaque_;
+	}
+
+	std::size_t getHitCount() const;
+	std::size_t getMissCount() const;
+
+private:
+	using key_type = uint64_t;
+
+	static key_type makeKey(const glm::ivec2 &origin, int32_t radius);
+
+	std::shared_ptr<const FieldOfView> lookup(key_type key);
+	void store(key_type key, std::shared_ptr<const FieldOfView> fov);
+
+	const BitGrid opaque_;
+	const std::size_t capacity_;
+
+	// Most recently used at the front.
+	using lru_list = std::list<std::pair<key_type, std::shared_ptr<const FieldOfView>>>;
+	lru_list entries_;
+	std::unordered_map<key_type, lru_list::iterator> index_;
+
+	std::size_t hits_ = 0u;
+	std::size_t misses_ = 0u;
+
+	mutable std::mutex mutex_;
+};
+
+}
+
+#endif /* INCLUDE_FIELDOFVIEW_HPP_ */
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_INTERESTMANAGER_HPP_
+#define INCLUDE_INTERESTMANAGER_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "EntityGrid.hpp"
+
+namespace PlayPG {
+
+/**
+ * Tells a subscriber that an entity has come into or gone out of its area of interest.
+ */
+struct InterestEvent final {
+	enum class Type
+		: uint8_t {
+			ENTER = 0x00,
+		LEAVE = 0x01
+	};
+
+	EntityGrid::id_type subscriber;
+	EntityGrid::id_type entity;
+
+	// Where the entity is for ENTER; unused for LEAVE.
+	glm::ivec2 tile;
+
+	Type type;
+};
+
+/**
+ * Tracks which cells of an EntityGrid each subscriber is interested in, so an entity update only needs to go to
+ * the subscribers of the cell the entity is in.
+ *
+ * A subscriber is always subscribed to every cell within radius cells of its own, and is only unsubscribed from a
+ * cell once it's more than radius + hysteresis cells away. Walking back and forth over a cell boundary doesn't
+ * churn subscriptions.
+ *
+ * A subscriber knows about an entity exactly when the entity's cell is one of its subscriptions, and the manager
+ * emits an ENTER or LEAVE event whenever that changes. Subscribers never get events about themselves.
+ *
+ * Changes must be reported in the order they're applied to the grid: insert then entityAdded, move then
+ * entityMoved, remove then entityRemoved. Subscription updates see the grid as it is when they're made.
+ */
+class InterestManager final {
+public:
+	using id_type = EntityGrid::id_type;
+
+	static constexpr const int32_t DEFAULT_RADIUS_IN_CELLS = 2;
+	static constexpr const int32_t DEFAULT_HYSTERESIS_IN_CELLS = 1;
+
+	explicit InterestManager(const EntityGrid &entities, int32_t radiusInCells = DEFAULT_RADIUS_IN_CELLS,
+	        int32_t hysteresisInCells = DEFAULT_HYSTERESIS_IN_CELLS);
+	~InterestManager() = default;
+
+	InterestManager(const InterestManager &other) = delete;
+	InterestManager &operator=(const InterestManager &other) = delete;
+
+	/**
+	 * Subscribes a new subscriber around tile, or recentres an existing one.
+	 */
+	void updateSubscriber(id_type subscriber, const glm::ivec2 &tile, std::vector<InterestEvent> &events);
+
+	/**
+	 * Forgets a subscriber. If events is given, the subscriber is told it has lost sight of everything it knew
+	 * about; leave it out when there's nobody left to tell.
+	 */
+	void removeSubscriber(id_type subscriber, std::vector<InterestEvent> *events = nullptr);
+
+	void entityAdded(id_type entity, const glm::ivec2 &tile, std::vector<InterestEvent> &events);
+	void entityMoved(id_type entity, const glm::ivec2 &from, const glm::ivec2 &to, std::vector<InterestEvent> &events);
+	void entityRemoved(id_type entity, const glm::ivec2 &tile, std::vector<InterestEvent> &events);
+
+	/**
+	 * Calls func(subscriber) for everyone subscribed to the cell containing tile.
+	 */
+	template<typename F> void forEachSubscriber(const glm::ivec2 &tile, F &&func) const {
+		for (const auto subscriber : cellSubscribers_[cellIndexFor(cellOf(tile))]) {
+			func(subscriber);
+		}
+	}
+
+	bool isSubscribed(id_type subscriber, const glm::ivec2 &tile) const;
+
+	std::size_t getSubscriberCount() const {
+		return subscriptions_.size();
+	}
+
+	int32_t getRadiusInCells() const {
+		return radius_;
+	}
+
+	int32_t getHysteresisInCells() const {
+		return hysteresis_;
+	}
+
+private:
+	/**
+	 * An inclusive rectangle of cells; empty when x0 > x1.
+	 */
+	struct CellRect {
+		int32_t x0;
+		int32_t y0;
+		int32_t x1;
+		int32_t y1;
+
+		bool empty() const {
+			return x0 > x1 || y0 > y1;
+		}
+
+		bool contains(const glm::ivec2 &cell) const {
+			return cell.x >= x0 && cell.x <= x1 && cell.y >= y0 && cell.y <= y1;
+		}
+
+		bool contains(const CellRect &other) const {
+			return other.empty() || (other.x0 >= x0 && other.x1 <= x1 && other.y0 >= y0 && other.y1 <= y1);
+		}
+	};
+
+	static const CellRect EMPTY_RECT;
+
+	glm::ivec2 cellOf(const glm::ivec2 &tile) const;
+
+	uint32_t cellIndexFor(const glm::ivec2 &cell) const {
+		return static_cast<uint32_t>(cell.y * entities_.getCellsWide() + cell.x);
+	}
+
+	CellRect rectAround(const glm::ivec2 &cell, int32_t radius) const;
+
+	void subscribeCell(id_type subscriber, const glm::ivec2 &cell, std::vector<InterestEvent> &events);
+	void unsubscribeCell(id_type subscriber, const glm::ivec2 &cell, std::vector<InterestEvent> *events);
+
+	const EntityGrid &entities_;
+
+	const int32_t radius_;
+	const int32_t hysteresis_;
+
+	std::unordered_map<id_type, CellRect> subscriptions_;
+	std::vector<std::vector<id_type>> cellSubscribers_;
+};
+
+}
+
+#endif /* INCLUDE_INTERESTMANAGER_HPP_ */
@@ -30,6 +30,7 @@
 
 #include <cstdint>
 
+#include <string>
 #include <vector>
 
 #include <glm/vec2.hpp>
@@ -38,8 +39,30 @@
 #include <tmxparser/Tmx.h>
 #include <APG/core/APGeasylogging.hpp>
 
+#include "ObjectTree.hpp"
+#include "TileIndex.hpp"
+#include "util/BitGrid.hpp"
+
 namespace PlayPG {
 
+class CompiledMap;
+
+/**
+ * A rectangular object placed on an object layer in Tiled; stored in pixel coordinates.
+ */
+struct MapObject final {
+	explicit MapObject(const std::string &name_, const glm::vec2 &position_, const glm::vec2 &size_) :
+			        name { name_ },
+			        position { position_ },
+			        size { size_ } {
+	}
+
+	std::string name;
+
+	glm::vec2 position;
+	glm::vec2 size;
+};
+
 struct MapTile final {
 	const bool isSolid;
 	const bool isInteresting;
@@ -57,58 +80,150 @@ public:
 	static std::string resolveNameFromMap(const Tmx::Map * map, el::Logger * const logger);
 	static uint32_t resolveVersionFromMap(const Tmx::Map * map, el::Logger * const logger);
 
-	explicit Map(const Tmx::Map * map);
-
+	/**
+	 * Parses a TMX map. Large maps split their tile rows over up to parseThreads threads, so callers
+	 * which are already running on a pool should leave this at 1.
+	 */
+	explicit Map(const Tmx::Map * map, unsigned int parseThreads = 1u);
+
+	/**
+	 * Creates a map from a compiled .ppg file, which doesn't require tmxparser at all.
+	 * Maps created this way return nullptr from getTmxMap() and share their collision grid with the
+	 * mapped file rather than copying it.
+	 */
+	explicit Map(const CompiledMap &compiled);
+
+	/**
+	 * Tiles outside of the map are always solid.
+	 */
 	bool isSolidAtTile(uint32_t x, uint32_t y) const {
-		return getTile(x, y).isSolid;
+		return solid_.getOr(x, y, true);
 	}
 
-	bool isSolidAtTile(const glm::ivec2 &pos) {
-		return getTile(pos.x, pos.y).isSolid;
+	bool isSolidAtTile(const glm::ivec2 &pos) const {
+		return isSolidAtTile(pos.x, pos.y);
 	}
 
 	bool isSolidAtCoord(float x, float y) const {
-		return getTile(x / getTileWidth(), y / getTileHeight()).isSolid;
+		return isSolidAtTile(coordToTileX(x), coordToTileY(y));
 	}
 
-	bool isSolidAtCoord(const glm::vec2 &pos) {
-		return getTile(pos.x / getTileWidth(), pos.y / getTileHeight()).isSolid;
+	bool isSolidAtCoord(const glm::vec2 &pos) const {
+		return isSolidAtCoord(pos.x, pos.y);
 	}
 
 	bool isInterestingAtTile(uint32_t x, uint32_t y) const {
-		return getTile(x, y).isInteresting;
+		return interesting_.getOr(x, y, false);
 	}
 
-	bool isInterestingAtTile(const glm::ivec2 &pos) {
-		return getTile(pos.x, pos.y).isInteresting;
+	bool isInterestingAtTile(const glm::ivec2 &pos) const {
+		return isInterestingAtTile(pos.x, pos.y);
 	}
 
 	bool isInterestingAtCoord(float x, float y) const {
-		return getTile(x / getTileWidth(), y / getTileHeight()).isInteresting;
+		return isInterestingAtTile(coordToTileX(x), coordToTileY(y));
 	}
 
-	bool isInterestingAtCoord(const glm::vec2 &pos) {
-		return getTile(pos.x / getTileWidth(), pos.y / getTileHeight()).isInteresting;
+	bool isInterestingAtCoord(const glm::vec2 &pos) const {
+		return isInterestingAtCoord(pos.x, pos.y);
 	}
 
+	/**
+	 * Returns true if any tile in the rectangle with top-left tile (x, y) and the given size in tiles is solid.
+	 * Parts of the rectangle outside of the map are ignored.
+	 */
+	bool isAnySolidInTileRect(int32_t x, int32_t y, int32_t width, int32_t height) const {
+		return solid_.anyInRect(x, y, width, height);
+	}
+
+	/**
+	 * Returns the x coordinate of the first solid tile in row y with xStart <= x < xEnd, or -1 if there is none.
+	 */
+	int32_t firstSolidInRow(uint32_t y, int32_t xStart, int32_t xEnd) const {
+		return solid_.firstSetInRow(y, xStart, xEnd);
+	}
+
+	/**
+	 * The last spawn tile in row-major order; see findNearestSpawn to choose between several.
+	 */
 	const glm::ivec2 &getSpawnPoint() const {
 		return spawnPoint;
 	}
 
+	/**
+	 * Finds the spawn tile nearest to the given tile, returning false if the map has no spawn tiles.
+	 */
+	bool findNearestSpawn(const glm::ivec2 &tile, glm::ivec2 * const spawn) const {
+		return spawnIndex_.findNearest(tile, spawn);
+	}
+
+	const TileIndex &getSpawnIndex() const {
+		return spawnIndex_;
+	}
+
+	const TileIndex &getInterestingIndex() const {
+		return interestingIndex_;
+	}
+
 	inline int getTileWidth() const {
-		return map->GetTileWidth();
+		return tileWidth_;
 	}
 
 	inline int getTileHeight() const {
-		return map->GetTileHeight();
+		return tileHeight_;
+	}
+
+	inline int getWidth() const {
+		return width_;
+	}
+
+	inline int getHeight() const {
+		return height_;
 	}
 
-	const MapTile &getTile(uint32_t x, uint32_t y) const;
+	MapTile getTile(uint32_t x, uint32_t y) const;
 
+	const BitGrid &getSolidGrid() const {
+		return solid_;
+	}
+
+	const BitGrid &getInterestingGrid() const {
+		return interesting_;
+	}
+
+	const BitGrid &getSpawnGrid() const {
+		return spawn_;
+	}
+
+	/**
+	 * Returns nullptr if this map was loaded from a compiled map file.
+	 */
 	const Tmx::Map * getTmxMap() const {
 		return map;
 	}
 
+	const std::vector<MapObject> &getObjects() const {
+		return objects_;
+	}
+
+	/**
+	 * An index over getObjects(), for finding the objects at a point.
+	 */
+	const ObjectTree &getObjectTree() const {
+		return objectTree_;
+	}
+
+	const std::string &getFileName() const {
+		return fileName_;
+	}
+
+	/**
+	 * The hash of the TMX file this map was compiled from, or "" if the map was parsed directly from TMX.
+	 */
+	const std::string &getSourceHash() const {
+		return sourceHash_;
+	}
+
 	const std::string &getName() const {
 		return name_;
 	}
@@ -123,16 +238,43 @@ private:
 	std::string name_;
 	uint32_t version_;
 
-	std::vector<MapTile> tiles;
+	std::string fileName_;
+	std::string sourceHash_ { "" };
+
+	int width_;
+	int height_;
+	int tileWidth_;
+	int tileHeight_;
+
+	// Cached so that converting from world coordinates to tiles is a multiply rather than a divide.
+	float inverseTileWidth_;
+	float inverseTileHeight_;
+
+	BitGrid solid_;
+	BitGrid interesting_;
+	BitGrid spawn_;
+
 	glm::ivec2 spawnPoint;
 
-	inline size_t resolveTileLoc(uint32_t x, uint32_t y) const {
-		return x + map->GetWidth() * y;
+	TileIndex spawnIndex_;
+	TileIndex interestingIndex_;
+
+	std::vector<MapObject> objects_;
+	ObjectTree objectTree_;
+
+	// Negative coordinates map to huge unsigned values, which then count as outside the map.
+	inline uint32_t coordToTileX(float x) const {
+		return static_cast<uint32_t>(static_cast<int32_t>(x * inverseTileWidth_));
+	}
+
+	inline uint32_t coordToTileY(float y) const {
+		return static_cast<uint32_t>(static_cast<int32_t>(y * inverseTileHeight_));
 	}
 
-	void parseMap();
+	void parseMap(unsigned int parseThreads);
 	void parseLayers(el::Logger * const logger);
-	void parseTiles(el::Logger * const logger);
+	void parseTiles(unsigned int parseThreads, el::Logger * const logger);
+	void buildIndices();
 };
 
 }
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_MAPHASHCACHE_HPP_
+#define INCLUDE_MAPHASHCACHE_HPP_
+
+#include <cstdint>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <APG/core/APGeasylogging.hpp>
+
+namespace PlayPG {
+
+/**
+ * Remembers the hashes of map files between runs, keyed by path, size and modification time, so that maps
+ * which haven't changed are never hashed again.
+ *
+ * Stored as a small text file (by default ".ppghashes" in the map directory). Safe to use from several
+ * threads at once.
+ */
+class MapHashCache final {
+public:
+	static constexpr const char *DEFAULT_FILE_NAME = ".ppghashes";
+
+	/**
+	 * Returns the default cache file for the directory containing the given map.
+	 */
+	static std::string defaultCacheFileFor(const std::string &mapFileName);
+
+	/**
+	 * Loads any existing entries from cacheFileName; a missing or unreadable file just means an empty cache.
+	 */
+	explicit MapHashCache(const std::string &cacheFileName, el::Logger * const logger);
+	~MapHashCache() = default;
+
+	MapHashCache(const MapHashCache &other) = delete;
+	MapHashCache &operator=(const MapHashCache &other) = delete;
+
+	/**
+	 * Returns the cached hash of fileName, or "" if there's no entry or the file has changed since it was
+	 * cached.
+	 */
+	std::string lookup(const std::string &fileName) const;
+
+	/**
+	 * Records the hash of fileName as of its current size and modification time. Call with details read
+	 * (by readFileDetails) before hashing the file, so that a change made while hashing isn't hidden.
+	 */
+	void store(const std::string &fileName, uint64_t fileSize, int64_t modificationTime, const std::string &hash);
+
+	/**
+	 * Writes the cache back to disk if anything changed, dropping entries for files which no longer exist.
+	 */
+	bool save();
+
+	/**
+	 * Reads the size and modification time (in nanoseconds where the platform supports it) of a file.
+	 */
+	static bool readFileDetails(const std::string &fileName, uint64_t * fileSize, int64_t * modificationTime);
+
+private:
+	struct Entry {
+		uint64_t fileSize;
+		int64_t modificationTime;
+		std::string hash;
+	};
+
+	const std::string cacheFileName_;
+	el::Logger * const logger_;
+
+	std::unordered_map<std::string, Entry> entries_;
+	bool dirty_ = false;
+
+	mutable std::mutex mutex_;
+};
+
+}
+
+#endif /* INCLUDE_MAPHASHCACHE_HPP_ */
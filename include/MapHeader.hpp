@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_MAPHEADER_HPP_
+#define INCLUDE_MAPHEADER_HPP_
+
+#include <cstdint>
+
+#include <string>
+
+#include <APG/core/APGeasylogging.hpp>
+
+namespace PlayPG {
+
+class MapHashCache;
+
+/**
+ * The subset of a map's details which can be read without parsing its tile data: the PPG_NAME and
+ * PPG_VERSION properties, the map dimensions and a hash of the raw file contents.
+ *
+ * Produced by MapHeader::scanTmxFile, which streams the file once without building a DOM, or read from the
+ * start of a compiled map. Useful for servers (e.g. the login server) which need to identify maps but
+ * never need to look at their tiles.
+ */
+struct MapHeader final {
+	/**
+	 * The algorithm used for every map hash, stored alongside hashes so that they can be told apart from
+	 * hashes made by older versions.
+	 */
+	static constexpr const char *HASH_ALGORITHM = "xxh64";
+
+	/**
+	 * Reads the header of either a TMX or compiled (.ppg) map, choosing based on the file's extension.
+	 */
+	static MapHeader scanFile(const std::string &fileName, el::Logger * const logger,
+	        MapHashCache * const cache = nullptr);
+
+	/**
+	 * Reads the header of the given TMX file while hashing the whole file in the same pass.
+	 * If the file can't be read or has no <map> element, the returned header will have valid == false.
+	 *
+	 * If the file's hash is in the given cache, only the header is read.
+	 */
+	static MapHeader scanTmxFile(const std::string &fileName, el::Logger * const logger,
+	        MapHashCache * const cache = nullptr);
+
+	/**
+	 * Hashes the raw bytes of the given file, returning a hex string or "" if the file couldn't be read.
+	 * Gives the same result as the hash produced by scanTmxFile.
+	 */
+	static std::string hashFile(const std::string &fileName, MapHashCache * const cache = nullptr);
+
+	std::string fileName;
+
+	std::string name;
+	uint32_t version = 0u;
+
+	int32_t width = 0;
+	int32_t height = 0;
+	int32_t tileWidth = 0;
+	int32_t tileHeight = 0;
+
+	std::string hash;
+
+	bool valid = false;
+	std::string errorText;
+};
+
+}
+
+#endif /* INCLUDE_MAPHEADER_HPP_ */
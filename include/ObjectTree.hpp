@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_OBJECTTREE_HPP_
+#define INCLUDE_OBJECTTREE_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+namespace PlayPG {
+
+struct MapObject;
+
+/**
+ * An immutable bounding volume hierarchy over a map's object rectangles, for finding which objects
+ * (portals, zones, scripted areas...) contain a point without testing every object.
+ *
+ * Objects are referred to by their index in the vector the tree was built from. Rectangles include their
+ * top and left edges but not their bottom and right edges, so a point on the boundary between two
+ * adjacent objects is only inside one of them.
+ */
+class ObjectTree final {
+public:
+	// Nodes with this many objects or fewer aren't split any further.
+	static constexpr const uint32_t MAX_LEAF_SIZE = 4u;
+
+	ObjectTree() = default;
+	explicit ObjectTree(const std::vector<MapObject> &objects);
+
+	~ObjectTree() = default;
+
+	/**
+	 * Calls func(objectIndex) for every object containing point, which is in pixels.
+	 */
+	template<typename F> void forEachContaining(const glm::vec2 &point, F &&func) const;
+
+	/**
+	 * Clears out and fills it with the indices of every object containing point, in ascending order.
+	 */
+	void findContaining(const glm::vec2 &point, std::vector<uint32_t> &out) const;
+
+	std::size_t getObjectCount() const {
+		return objectIndices_.size();
+	}
+
+	std::size_t getNodeCount() const {
+		return nodes_.size();
+	}
+
+private:
+	struct Node {
+		glm::vec2 min;
+		glm::vec2 max;
+
+		// Leaves hold objectIndices_[first] to objectIndices_[first + count]; other nodes have count == 0
+		// and children at first and first + 1.
+		uint32_t first;
+		uint32_t count;
+	};
+
+	struct Bounds {
+		glm::vec2 min;
+		glm::vec2 max;
+	};
+
+	static bool contains(const glm::vec2 &min, const glm::vec2 &max, const glm::vec2 &point) {
+		return point.x >= min.x && point.y >= min.y && point.x < max.x && point.y < max.y;
+	}
+
+	void build(uint32_t nodeIndex, uint32_t first, uint32_t count, const std::vector<Bounds> &bounds);
+
+	std::vector<Node> nodes_;
+	std::vector<uint32_t> objectIndices_;
+
+	// Copies of each object's rectangle in objectIndices_ order, so leaves don't need the original objects.
+	std::vector<Bounds> leafBounds_;
+};
+
+template<typename F> void ObjectTree::forEachContaining(const glm::vec2 &point, F &&func) const {
+	if (nodes_.empty()) {
+		return;
+	}
+
+	uint32_t stack[64];
+	uint32_t stackSize = 0u;
+	stack[stackSize++] = 0u;
+
+	while (stackSize > 0u) {
+		const auto &node = nodes_[stack[--stackSize]];
+
+		if (!contains(node.min, node.max, point)) {
+			continue;
+		}
+
+		if (node.count == 0u) {
+			stack[stackSize++] = node.first;
+			stack[stackSize++] = node.first + 1u;
+			continue;
+		}
+
+		for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+			if (contains(leafBounds_[i].min, leafBounds_[i].max, point)) {
+				func(objectIndices_[i]);
+			}
+		}
+	}
+}
+
+}
+
+#endif /* INCLUDE_OBJECTTREE_HPP_ */
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_TILEINDEX_HPP_
+#define INCLUDE_TILEINDEX_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <algorithm>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "util/BitGrid.hpp"
+
+namespace PlayPG {
+
+/**
+ * A read-only spatial index of a set of tiles (e.g. every spawn or interesting tile on a map), so that
+ * finding the nearest one or all those within a radius only looks at nearby tiles.
+ *
+ * Tiles are grouped into square buckets; all tiles are stored in one array sorted by bucket, with each
+ * bucket's tiles in row-major order.
+ */
+class TileIndex final {
+public:
+	static constexpr const int32_t DEFAULT_BUCKET_SIZE = 16;
+
+	/**
+	 * An empty index.
+	 */
+	TileIndex();
+
+	/**
+	 * Indexes every set tile in tiles.
+	 */
+	explicit TileIndex(const BitGrid &tiles, int32_t bucketSize = DEFAULT_BUCKET_SIZE);
+
+	~TileIndex() = default;
+
+	/**
+	 * Finds the indexed tile closest to from by straight line distance; ties are broken towards the
+	 * tile which comes first in row-major order. Returns false if the index is empty.
+	 */
+	bool findNearest(const glm::ivec2 &from, glm::ivec2 * const nearest) const;
+
+	/**
+	 * Calls func(tile) for every indexed tile at most radius tiles (straight line) from centre.
+	 */
+	template<typename F> void forEachWithin(const glm::ivec2 &centre, int32_t radius, F &&func) const;
+
+	/**
+	 * Appends every indexed tile at most radius tiles from centre to out.
+	 */
+	void findWithin(const glm::ivec2 &centre, int32_t radius, std::vector<glm::ivec2> &out) const {
+		forEachWithin(centre, radius, [&out](const glm::ivec2 &tile) {
+			out.emplace_back(tile);
+		});
+	}
+
+	/**
+	 * Every indexed tile, sorted by bucket.
+	 */
+	const std::vector<glm::ivec2> &getTiles() const {
+		return tiles_;
+	}
+
+	std::size_t size() const {
+		return tiles_.size();
+	}
+
+	bool empty() const {
+		return tiles_.empty();
+	}
+
+private:
+	static int64_t distanceSquared(const glm::ivec2 &a, const glm::ivec2 &b) {
+		const int64_t dx = a.x - b.x;
+		const int64_t dy = a.y - b.y;
+
+		return dx * dx + dy * dy;
+	}
+
+	int32_t bucketSize_;
+	int32_t bucketsWide_;
+	int32_t bucketsHigh_;
+
+	std::vector<glm::ivec2> tiles_;
+
+	// Bucket b's tiles are tiles_[bucketStarts_[b]] up to tiles_[bucketStarts_[b + 1]].
+	std::vector<uint32_t> bucketStarts_;
+};
+
+template<typename F> void TileIndex::forEachWithin(const glm::ivec2 &centre, int32_t radius, F &&func) const {
+	if (tiles_.empty() || radius < 0) {
+		return;
+	}
+
+	const int32_t minX = std::max((centre.x - radius) / bucketSize_, 0);
+	const int32_t minY = std::max((centre.y - radius) / bucketSize_, 0);
+	const int32_t maxX = std::min((centre.x + radius) / bucketSize_, bucketsWide_ - 1);
+	const int32_t maxY = std::min((centre.y + radius) / bucketSize_, bucketsHigh_ - 1);
+	const int64_t radiusSquared = static_cast<int64_t>(radius) * radius;
+
+	for (int32_t by = minY; by <= maxY; ++by) {
+		for (int32_t bx = minX; bx <= maxX; ++bx) {
+			const auto bucket = by * bucketsWide_ + bx;
+
+			for (auto i = bucketStarts_[bucket]; i < bucketStarts_[bucket + 1]; ++i) {
+				if (distanceSquared(tiles_[i], centre) <= radiusSquared) {
+					func(tiles_[i]);
+				}
+			}
+		}
+	}
+}
+
+}
+
+#endif /* INCLUDE_TILEINDEX_HPP_ */
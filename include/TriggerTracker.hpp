@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_TRIGGERTRACKER_HPP_
+#define INCLUDE_TRIGGERTRACKER_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "ObjectTree.hpp"
+
+namespace PlayPG {
+
+class Map;
+
+/**
+ * Emitted when an entity's position moves into or out of one of a map's objects.
+ */
+struct TriggerEvent final {
+	enum class Type : uint8_t {
+		ENTER,
+		EXIT,
+	};
+
+	uint64_t entity;
+
+	// Index into Map::getObjects().
+	uint32_t object;
+
+	Type type;
+};
+
+/**
+ * Tracks which of a map's objects each entity is inside, producing enter and exit events as entities
+ * move. Each update is one query of the map's ObjectTree.
+ *
+ * The map (or tree) must outlive the tracker. Not thread safe.
+ */
+class TriggerTracker final {
+public:
+	using id_type = uint64_t;
+
+	explicit TriggerTracker(const Map &map);
+	explicit TriggerTracker(const ObjectTree &tree);
+	~TriggerTracker() = default;
+
+	/**
+	 * Sets the entity's position in pixels (adding it if it isn't tracked yet) and appends an event to events
+	 * for each object entered or exited. Exits are appended before enters.
+	 */
+	void update(id_type id, const glm::vec2 &position, std::vector<TriggerEvent> &events);
+
+	/**
+	 * Stops tracking the entity, appending an exit event for every object it was inside.
+	 */
+	void remove(id_type id, std::vector<TriggerEvent> &events);
+
+	/**
+	 * The objects the entity is inside, in ascending order; empty if it isn't tracked.
+	 */
+	const std::vector<uint32_t> &getObjectsContaining(id_type id) const;
+
+	std::size_t size() const {
+		return inside_.size();
+	}
+
+private:
+	const ObjectTree &tree_;
+
+	std::unordered_map<id_type, std::vector<uint32_t>> inside_;
+
+	// Reused between updates to avoid allocating.
+	std::vector<uint32_t> scratch_;
+};
+
+}
+
+#endif /* INCLUDE_TRIGGERTRACKER_HPP_ */
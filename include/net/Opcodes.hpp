@@ -51,7 +51,11 @@ enum class ClientOpcode
 	VERSION_MISMATCH = 0x0002,
 	REQUEST_CHARACTERS = 0x0003,
 	CHARACTER_SELECT = 0x0004,
+	MAP_JOIN = 0x0005,
 	MOVE = 0x000A,
+	SNAPSHOT_ACK = 0x000B,
+	TIME_PING = 0x000C,
+	INTERACT = 0x000D,
 };
 
 enum class ServerOpcode
@@ -68,6 +72,11 @@ enum class ServerOpcode
 	NO_MAP_SERVER_ERROR = 0xFFF5,
 	SERVER_PUBKEY = 0xFFF4,
 	MALFORMED_PACKET = 0xFFF3,
+	MAP_SERVER_MAP_UPDATE = 0xFFF2,
+	SNAPSHOT = 0xFFF1,
+	MOVE_CORRECTION = 0xFFF0,
+	MOVE_ACK = 0xFFEF,
+	TIME_PONG = 0xFFEE,
 };
 
 static_assert(std::is_same<std::underlying_type<ClientOpcode>::type, std::underlying_type<ServerOpcode>::type>::value, "ClientOpcodes and ServerOpcodes must have the same underlying type.");
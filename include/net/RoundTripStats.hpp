@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_NET_ROUNDTRIPSTATS_HPP_
+#define INCLUDE_NET_ROUNDTRIPSTATS_HPP_
+
+#include <cstdint>
+
+namespace PlayPG {
+
+/**
+ * Smoothed round trip time and its variation, in microseconds, updated as TCP does (RFC 6298) so that one slow
+ * sample doesn't swing the estimate.
+ */
+class RoundTripStats final {
+public:
+	explicit RoundTripStats() = default;
+	~RoundTripStats() = default;
+
+	void addSample(uint64_t roundTripMicros);
+
+	uint64_t getLast() const {
+		return last_;
+	}
+
+	uint64_t getMin() const {
+		return min_;
+	}
+
+	uint64_t getSmoothed() const {
+		return smoothed_;
+	}
+
+	/**
+	 * The smoothed mean deviation from getSmoothed(); a measure of jitter.
+	 */
+	uint64_t getVariation() const {
+		return variation_;
+	}
+
+	uint64_t getSampleCount() const {
+		return sampleCount_;
+	}
+
+private:
+	uint64_t last_ = 0u;
+	uint64_t min_ = 0u;
+	uint64_t smoothed_ = 0u;
+	uint64_t variation_ = 0u;
+	uint64_t sampleCount_ = 0u;
+};
+
+}
+
+#endif /* INCLUDE_NET_ROUNDTRIPSTATS_HPP_ */
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_NET_SNAPSHOT_HPP_
+#define INCLUDE_NET_SNAPSHOT_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "util/BitStream.hpp"
+
+namespace PlayPG {
+
+/**
+ * The replicated state of one entity at one tick.
+ */
+struct EntityState final {
+	uint64_t guid;
+	glm::ivec2 tile;
+};
+
+inline bool operator==(const EntityState &lhs, const EntityState &rhs) {
+	return lhs.guid == rhs.guid && lhs.tile == rhs.tile;
+}
+
+/**
+ * How positions are quantized on the wire. Tiles are already integers, so each coordinate only needs enough bits
+ * for the map's size. The server derives this from its map and sends it with every snapshot, so the client never
+ * has to agree on the map's size, e.g. while a reloaded map is on its way.
+ */
+struct SnapshotFormat final {
+	static constexpr const uint32_t MAX_COORDINATE_BITS = 31u;
+
+	static SnapshotFormat forMapSize(int32_t widthInTiles, int32_t heightInTiles);
+
+	/**
+	 * Unpacks a format packed by pack(), returning false if it's one the server could never have sent.
+	 */
+	static bool unpack(uint16_t packed, SnapshotFormat *format);
+
+	/**
+	 * xBits in the high byte and yBits in the low byte.
+	 */
+	uint16_t pack() const {
+		return static_cast<uint16_t>((xBits << 8u) | yBits);
+	}
+
+	uint32_t xBits;
+	uint32_t yBits;
+};
+
+/**
+ * Writes the difference between two snapshots, each sorted by GUID. Entities which haven't changed since
+ * baseline cost nothing; an empty baseline writes current in full.
+ */
+void encodeSnapshotDelta(const std::vector<EntityState> &baseline, const std::vector<EntityState> &current,
+        const SnapshotFormat &format, BitWriter &out);
+
+/**
+ * The inverse of encodeSnapshotDelta, given the same baseline. current is replaced and comes out sorted by GUID.
+ * Returns false if the data was truncated or inconsistent with baseline.
+ */
+bool decodeSnapshotDelta(const std::vector<EntityState> &baseline, BitReader &in, const SnapshotFormat &format,
+        std::vector<EntityState> &current);
+
+/**
+ * Replaces out with the states in all, sorted by GUID, whose GUIDs are in guids, also sorted.
+ */
+void filterSnapshot(const std::vector<EntityState> &all, const std::vector<uint64_t> &guids,
+        std::vector<EntityState> &out);
+
+/**
+ * Remembers the last capacity things recorded against increasing sequence numbers, such as recent snapshots.
+ * Slots are reused in place, so vectors recorded here keep their storage between ticks.
+ */
+template<typename T> class SnapshotRing final {
+public:
+	explicit SnapshotRing(std::size_t capacity) :
+			        slots_(capacity) {
+	}
+
+	~SnapshotRing() = default;
+
+	/**
+	 * Returns the slot for sequence, replacing the oldest one, for the caller to fill in.
+	 */
+	T &record(uint32_t sequence) {
+		auto &slot = slots_[sequence % slots_.size()];
+		slot.sequence = sequence;
+		return slot.value;
+	}
+
+	/**
+	 * nullptr if sequence was never recorded or has been replaced since.
+	 */
+	const T *find(uint32_t sequence) const {
+		if (sequence == 0u) {
+			return nullptr;
+		}
+
+		const auto &slot = slots_[sequence % slots_.size()];
+		return slot.sequence == sequence ? &slot.value : nullptr;
+	}
+
+	std::size_t capacity() const {
+		return slots_.size();
+	}
+
+private:
+	struct Slot {
+		// 0 is never a valid sequence number.
+		uint32_t sequence = 0u;
+		T value;
+	};
+
+	std::vector<Slot> slots_;
+};
+
+}
+
+#endif /* INCLUDE_NET_SNAPSHOT_HPP_ */
@@ -28,13 +28,158 @@
 #ifndef INCLUDE_NET_WORLDSESSION_HPP_
 #define INCLUDE_NET_WORLDSESSION_HPP_
 
+#include <cstdint>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <APG/APGNet.hpp>
+#include <APG/core/APGeasylogging.hpp>
+
+#include "net/Opcodes.hpp"
+#include "net/Packet.hpp"
+#include "net/RoundTripStats.hpp"
+#include "util/SPSCQueue.hpp"
+
 namespace PlayPG {
 
 /**
- * Manages a world session for a player, including packet handling and detail storage.
+ * A client packet decoded by the I/O thread. Every field is widened to 64 bits; the opcode decides what each one
+ * means and how wide it was on the wire.
+ */
+struct InboundMessage final {
+	static constexpr const uint32_t MAX_FIELDS = 4u;
+
+	opcode_type_t opcode = 0u;
+	std::array<uint64_t, MAX_FIELDS> fields { { 0u, 0u, 0u, 0u } };
+};
+
+/**
+ * What a session does when one of its queues is full.
  */
-class WorldSession {
+enum class QueueFullPolicy
+	: uint8_t {
+		DROP = 0x00,
+	DISCONNECT = 0x01
+};
+
+/**
+ * Manages a world session for a player on a map server.
+ *
+ * The socket belongs to the I/O thread, which decodes whole packets into a bounded inbound queue with
+ * pumpInbound() and sends from a bounded outbound queue with flushOutbound(). The map's tick thread consumes
+ * with receive() and produces with send(). Both queues are single-producer single-consumer rings, so no lock is
+ * taken per packet, and a session never holds more than its queue capacities in memory.
+ *
+ * Time pings never reach the tick thread: the I/O thread answers them straight away and measures the player's
+ * round trip from them, which any thread can read.
+ */
+class WorldSession final {
+public:
+	static constexpr const uint32_t DEFAULT_INBOUND_CAPACITY = 64u;
+	static constexpr const uint32_t DEFAULT_OUTBOUND_CAPACITY = 256u;
+
+	// Stops one chatty player from starving every other session of I/O time.
+	static constexpr const uint32_t MAX_PACKETS_PER_PUMP = 64u;
+
+	explicit WorldSession(uint64_t guid_, std::unique_ptr<APG::Socket> &&socket,
+	        QueueFullPolicy inboundPolicy_ = QueueFullPolicy::DROP,
+	        QueueFullPolicy outboundPolicy_ = QueueFullPolicy::DISCONNECT,
+	        uint32_t inboundCapacity = DEFAULT_INBOUND_CAPACITY, uint32_t outboundCapacity = DEFAULT_OUTBOUND_CAPACITY);
+	~WorldSession() = default;
+
+	WorldSession(const WorldSession &other) = delete;
+	WorldSession &operator=(const WorldSession &other) = delete;
+
+	/**
+	 * I/O thread. Decodes waiting packets into the inbound queue; returns how many were decoded.
+	 */
+	uint32_t pumpInbound(el::Logger * const logger);
+
+	/**
+	 * I/O thread. Sends everything in the outbound queue; returns how many packets were sent.
+	 */
+	uint32_t flushOutbound(el::Logger * const logger);
+
+	/**
+	 * I/O thread. Drops the socket once the session is closed.
+	 */
+	void releaseSocket();
+
+	/**
+	 * Tick thread. Returns false when there's nothing left to read.
+	 */
+	bool receive(InboundMessage &message);
+
+	/**
+	 * Tick thread. Returns false if the packet was dropped because the outbound queue is full.
+	 */
+	bool send(std::unique_ptr<Packet> &&packet);
+
+	/**
+	 * Any thread. The I/O thread releases the socket when it next sees the session.
+	 */
+	void close() {
+		closed_.store(true, std::memory_order_release);
+	}
+
+	bool isClosed() const {
+		return closed_.load(std::memory_order_acquire);
+	}
+
+	uint64_t getDroppedInboundCount() const {
+		return droppedInbound_.load(std::memory_order_relaxed);
+	}
+
+	uint64_t getDroppedOutboundCount() const {
+		return droppedOutbound_.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Zero until the client has echoed a pong.
+	 */
+	std::chrono::microseconds getSmoothedRoundTrip() const {
+		return std::chrono::microseconds(smoothedRoundTrip_.load(std::memory_order_relaxed));
+	}
+
+	std::chrono::microseconds getRoundTripVariation() const {
+		return std::chrono::microseconds(roundTripVariation_.load(std::memory_order_relaxed));
+	}
+
+	std::chrono::microseconds getMinRoundTrip() const {
+		return std::chrono::microseconds(minRoundTrip_.load(std::memory_order_relaxed));
+	}
+
+	const uint64_t guid;
+	const std::string remoteHost;
+
+	const QueueFullPolicy inboundPolicy;
+	const QueueFullPolicy outboundPolicy;
+
+private:
+	bool decode(InboundMessage &message, el::Logger * const logger);
+	void answerPing(const InboundMessage &ping, el::Logger * const logger);
+
+	std::unique_ptr<APG::Socket> socket_;
+
+	SPSCQueue<InboundMessage> inbound_;
+	SPSCQueue<std::unique_ptr<Packet>> outbound_;
+
+	std::atomic<bool> closed_ { false };
+
+	std::atomic<uint64_t> droppedInbound_ { 0u };
+	std::atomic<uint64_t> droppedOutbound_ { 0u };
+
+	// Only touched by the I/O thread; the atomics below publish it.
+	RoundTripStats roundTrip_;
+	uint64_t lastPongSentAt_ = 0u;
 
+	std::atomic<uint64_t> smoothedRoundTrip_ { 0u };
+	std::atomic<uint64_t> roundTripVariation_ { 0u };
+	std::atomic<uint64_t> minRoundTrip_ { 0u };
 };
 
 }
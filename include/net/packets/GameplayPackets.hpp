@@ -28,32 +28,88 @@
 #ifndef INCLUDE_NET_PACKETS_GAMEPLAYPACKETS_HPP_
 #define INCLUDE_NET_PACKETS_GAMEPLAYPACKETS_HPP_
 
+#include <cstdint>
+
+#include <glm/vec2.hpp>
+
 #include "net/Packet.hpp"
 
 namespace PlayPG {
 
 /**
  * Sent by a client to the server to signal a move request. Note that this could be rejected.
+ * Sequence numbers start at 1 and increase with every move, so the server can say which moves it has dealt with.
  */
 class MovementPacket final : public ClientPacket {
 public:
-	/**
-	 * Create a MovementPacket by copying an existing move.
-	 */
-	explicit MovementPacket(const Move &move_) :
-			        MovementPacket(Move(move_)) {
+	explicit MovementPacket(uint32_t sequence_, int16_t xTiles_, int16_t yTiles_) :
+			        ClientPacket(ClientOpcode::MOVE),
+			        sequence { sequence_ },
+			        xTiles { xTiles_ },
+			        yTiles { yTiles_ } {
+		buffer.putInt(sequence);
+		buffer.putShort(static_cast<uint16_t>(xTiles));
+		buffer.putShort(static_cast<uint16_t>(yTiles));
 	}
 
-	/**
-	 * Create a MovementPacket by moving from an existing move.
-	 */
-	explicit MovementPacket(Move &&move_) :
-			        ClientPacket(ClientOpcode::MOVE),
-			        move { std::move(move_) } {
+	const uint32_t sequence;
+	const int16_t xTiles;
+	const int16_t yTiles;
+};
+
+/**
+ * Sent by a client when the player interacts with the tile at (x, y). renderTime is the server time, in
+ * microseconds, of the world the client was showing at the time, so the server can judge the interaction against
+ * that rather than the present.
+ */
+class InteractPacket final : public ClientPacket {
+public:
+	explicit InteractPacket(uint64_t renderTime_, int16_t x_, int16_t y_) :
+			        ClientPacket(ClientOpcode::INTERACT),
+			        renderTime { renderTime_ },
+			        x { x_ },
+			        y { y_ } {
+		buffer.putLong(renderTime);
+		buffer.putShort(static_cast<uint16_t>(x));
+		buffer.putShort(static_cast<uint16_t>(y));
+	}
+
+	const uint64_t renderTime;
+	const int16_t x;
+	const int16_t y;
+};
+
+/**
+ * Sent by a map server after a tick in which it accepted every move up to and including sequence.
+ */
+class MoveAckPacket final : public ServerPacket {
+public:
+	explicit MoveAckPacket(uint32_t sequence_) :
+			        ServerPacket(ServerOpcode::MOVE_ACK),
+			        sequence { sequence_ } {
+		buffer.putInt(sequence);
+	}
 
+	const uint32_t sequence;
+};
+
+/**
+ * Sent by a map server instead of an ack when it rejected a move. Every move up to and including sequence has
+ * been dealt with, and the player is at tile.
+ */
+class MoveCorrectionPacket final : public ServerPacket {
+public:
+	explicit MoveCorrectionPacket(uint32_t sequence_, const glm::ivec2 &tile_) :
+			        ServerPacket(ServerOpcode::MOVE_CORRECTION),
+			        sequence { sequence_ },
+			        tile { tile_ } {
+		buffer.putInt(sequence);
+		buffer.putInt(static_cast<uint32_t>(tile.x));
+		buffer.putInt(static_cast<uint32_t>(tile.y));
 	}
 
-	const Move move;
+	const uint32_t sequence;
+	const glm::ivec2 tile;
 };
 
 }
@@ -37,8 +37,6 @@
 #include "Map.hpp"
 #include "Location.hpp"
 
-#include <openssl/md5.h>
-
 namespace PlayPG {
 
 /**
@@ -128,6 +126,17 @@ public:
 	const std::vector<Location> mapHashes;
 };
 
+/**
+ * Sent by a registered map server when it reloads maps which changed on disk. The JSON body has the same
+ * layout as MapServerMapList.
+ */
+class MapServerMapUpdate final : public ServerPacket {
+public:
+	explicit MapServerMapUpdate(const std::vector<Location> &updatedMaps_);
+
+	const std::vector<Location> updatedMaps;
+};
+
 class VersionMismatch final : public ClientPacket {
 public:
 	explicit VersionMismatch();
@@ -283,9 +292,10 @@ public:
 			const std::string mapName = object["name"].GetString();
 			const std::string knownFileName = object["knownFileName"].GetString();
 			const std::string mapHash = object["hash"].GetString();
+			const std::string hashAlgorithm = object["hashAlgorithm"].GetString();
 			const uint64_t version = object["version"].GetInt64();
 
-			ret.emplace_back(PlayPG::Location(mapName, knownFileName, mapHash, version));
+			ret.emplace_back(PlayPG::Location(mapName, knownFileName, mapHash, version, hashAlgorithm));
 		}
 
 		return PlayPG::MapServerMapList(std::move(ret));
@@ -306,7 +316,10 @@ public:
 			writer->String(location.locationName.c_str());
 
 			writer->String("hash");
-			writer->String(location.knownMD5Hash.c_str());
+			writer->String(location.knownHash.c_str());
+
+			writer->String("hashAlgorithm");
+			writer->String(location.hashAlgorithm.c_str());
 
 			writer->String("knownFileName");
 			writer->String(location.knownFileName.c_str());
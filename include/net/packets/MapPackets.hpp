@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_NET_PACKETS_MAPPACKETS_HPP_
+#define INCLUDE_NET_PACKETS_MAPPACKETS_HPP_
+
+#include <cstdint>
+
+#include <string>
+
+#include "net/Packet.hpp"
+
+namespace PlayPG {
+
+/**
+ * The first packet a client sends after connecting to a map server, naming the map it wants to join. An
+ * instanceID of 0 joins the map's shared world; anything else joins the private instance with that ID, which
+ * everyone else joining it must also use.
+ */
+class MapJoinRequest final : public ClientPacket {
+public:
+	explicit MapJoinRequest(const std::string &mapName_, const uint64_t &characterID_,
+	        const uint64_t &instanceID_ = 0u) :
+			        ClientPacket(ClientOpcode::MAP_JOIN),
+			        mapNameLength { static_cast<uint16_t>(mapName_.length()) },
+			        mapName { mapName_ },
+			        characterID { characterID_ },
+			        instanceID { instanceID_ } {
+		buffer.putShort(mapNameLength);
+		buffer.putString(mapName);
+		buffer.putLong(characterID);
+		buffer.putLong(instanceID);
+	}
+
+	const uint16_t mapNameLength;
+	const std::string mapName;
+	const uint64_t characterID;
+	const uint64_t instanceID;
+};
+
+}
+
+#endif /* INCLUDE_NET_PACKETS_MAPPACKETS_HPP_ */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_NET_PACKETS_SNAPSHOTPACKETS_HPP_
+#define INCLUDE_NET_PACKETS_SNAPSHOTPACKETS_HPP_
+
+#include <cstdint>
+
+#include "net/Packet.hpp"
+#include "net/Snapshot.hpp"
+#include "util/BitStream.hpp"
+
+namespace PlayPG {
+
+/**
+ * The entities a player can see, as a bit-packed delta against the snapshot numbered baseline, or in full if
+ * baseline is 0. serverTime is when the snapshot was taken, in microseconds on the server's monotonic clock.
+ * format is how the delta's coordinates were packed, as SnapshotFormat::pack() gives it.
+ */
+class SnapshotPacket final : public ServerPacket {
+public:
+	explicit SnapshotPacket(uint32_t sequence_, uint32_t baseline_, uint64_t serverTime_,
+	        const SnapshotFormat &format_, const BitWriter &delta) :
+			        ServerPacket(ServerOpcode::SNAPSHOT),
+			        sequence { sequence_ },
+			        baseline { baseline_ },
+			        serverTime { serverTime_ },
+			        format { format_.pack() },
+			        deltaLength { static_cast<uint16_t>(delta.getBytes().size()) } {
+		buffer.putInt(sequence);
+		buffer.putInt(baseline);
+		buffer.putLong(serverTime);
+		buffer.putShort(format);
+		buffer.putShort(deltaLength);
+		buffer.put(delta.getBytes().data(), deltaLength);
+	}
+
+	const uint32_t sequence;
+	const uint32_t baseline;
+	const uint64_t serverTime;
+	const uint16_t format;
+	const uint16_t deltaLength;
+};
+
+/**
+ * Tells the server a snapshot arrived, so later snapshots can be sent as deltas against it.
+ */
+class SnapshotAckPacket final : public ClientPacket {
+public:
+	explicit SnapshotAckPacket(uint32_t sequence_) :
+			        ClientPacket(ClientOpcode::SNAPSHOT_ACK),
+			        sequence { sequence_ } {
+		buffer.putInt(sequence);
+	}
+
+	const uint32_t sequence;
+};
+
+}
+
+#endif /* INCLUDE_NET_PACKETS_SNAPSHOTPACKETS_HPP_ */
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_NET_PACKETS_TIMEPACKETS_HPP_
+#define INCLUDE_NET_PACKETS_TIMEPACKETS_HPP_
+
+#include <cstdint>
+
+#include "net/Packet.hpp"
+
+namespace PlayPG {
+
+/**
+ * Sent by a client every so often to measure its round trip time and clock offset to the map server. All times
+ * are microseconds on the sender's monotonic clock.
+ *
+ * echoedServerTime and heldMicros let the server measure the round trip too: they're the serverSendTime of the
+ * last pong the client received, or 0, and how long the client held it before sending this ping.
+ */
+class TimePingPacket final : public ClientPacket {
+public:
+	explicit TimePingPacket(uint64_t clientSendTime_, uint64_t echoedServerTime_, uint32_t heldMicros_) :
+			        ClientPacket(ClientOpcode::TIME_PING),
+			        clientSendTime { clientSendTime_ },
+			        echoedServerTime { echoedServerTime_ },
+			        heldMicros { heldMicros_ } {
+		buffer.putLong(clientSendTime);
+		buffer.putLong(echoedServerTime);
+		buffer.putInt(heldMicros);
+	}
+
+	const uint64_t clientSendTime;
+	const uint64_t echoedServerTime;
+	const uint32_t heldMicros;
+};
+
+/**
+ * The map server's immediate reply to a TimePingPacket, echoing the client's time alongside the server's clock when
+ * the ping arrived and when the pong was sent.
+ */
+class TimePongPacket final : public ServerPacket {
+public:
+	explicit TimePongPacket(uint64_t clientSendTime_, uint64_t serverReceiveTime_, uint64_t serverSendTime_) :
+			        ServerPacket(ServerOpcode::TIME_PONG),
+			        clientSendTime { clientSendTime_ },
+			        serverReceiveTime { serverReceiveTime_ },
+			        serverSendTime { serverSendTime_ } {
+		buffer.putLong(clientSendTime);
+		buffer.putLong(serverReceiveTime);
+		buffer.putLong(serverSendTime);
+	}
+
+	const uint64_t clientSendTime;
+	const uint64_t serverReceiveTime;
+	const uint64_t serverSendTime;
+};
+
+}
+
+#endif /* INCLUDE_NET_PACKETS_TIMEPACKETS_HPP_ */
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_PATHFINDING_GRIDSEARCH_HPP_
+#define INCLUDE_PATHFINDING_GRIDSEARCH_HPP_
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "util/BitGrid.hpp"
+
+namespace PlayPG {
+
+/*
+ * Pathfinding treats the collision grid as 8-connected: a step may be diagonal, but only if both of the
+ * tiles it passes between are walkable, so paths never cut the corner of a solid tile.
+ */
+namespace pathcost {
+
+constexpr const float STRAIGHT = 1.0f;
+constexpr const float DIAGONAL = 1.41421356f;
+constexpr const float UNREACHABLE = std::numeric_limits<float>::infinity();
+
+/**
+ * The cost of the cheapest path between two tiles if nothing were in the way.
+ */
+inline float octile(const glm::ivec2 &a, const glm::ivec2 &b) {
+	const int32_t dx = std::abs(a.x - b.x);
+	const int32_t dy = std::abs(a.y - b.y);
+
+	return STRAIGHT * static_cast<float>(std::max(dx, dy)) + (DIAGONAL - STRAIGHT) * static_cast<float>(std::min(dx, dy));
+}
+
+}
+
+/**
+ * An axis aligned rectangle of tiles.
+ */
+struct TileRect {
+	int32_t x;
+	int32_t y;
+	int32_t w;
+	int32_t h;
+
+	bool contains(int32_t tileX, int32_t tileY) const {
+		return tileX >= x && tileY >= y && tileX < x + w && tileY < y + h;
+	}
+};
+
+/**
+ * Dijkstra's algorithm confined to a small rectangle of tiles (e.g. one pathfinding cluster), giving the
+ * cost from one tile to every other reachable tile in the rectangle. Keeps its buffers between runs.
+ */
+class BoundedDijkstra final {
+public:
+	BoundedDijkstra() = default;
+	~BoundedDijkstra() = default;
+
+	/**
+	 * Tiles outside bounds are treated as solid.
+	 */
+	void run(const BitGrid &solid, const TileRect &bounds, const glm::ivec2 &source);
+
+	/**
+	 * The cost from the last source to tile, or pathcost::UNREACHABLE.
+	 */
+	float costTo(const glm::ivec2 &tile) const {
+		if (!bounds_.contains(tile.x, tile.y)) {
+			return pathcost::UNREACHABLE;
+		}
+
+		return costs_[(tile.y - bounds_.y) * bounds_.w + (tile.x - bounds_.x)];
+	}
+
+private:
+	TileRect bounds_ { 0, 0, 0, 0 };
+
+	std::vector<float> costs_;
+	std::vector<std::pair<float, int32_t>> open_;
+};
+
+}
+
+#endif /* INCLUDE_PATHFINDING_GRIDSEARCH_HPP_ */
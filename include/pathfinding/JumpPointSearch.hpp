@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_PATHFINDING_JUMPPOINTSEARCH_HPP_
+#define INCLUDE_PATHFINDING_JUMPPOINTSEARCH_HPP_
+
+#include <cstdint>
+
+#include <utility>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "pathfinding/GridSearch.hpp"
+#include "util/BitGrid.hpp"
+
+namespace PlayPG {
+
+/**
+ * Optimal pathfinding over a collision grid using Jump Point Search: A* which skips over runs of open tiles
+ * in a straight line, so it only ever puts a few "jump points" on its open list.
+ *
+ * Each instance keeps per-tile buffers for the whole grid between searches so that searching doesn't
+ * allocate, which means an instance must only be used by one thread at a time.
+ */
+class JumpPointSearch final {
+public:
+	explicit JumpPointSearch(const BitGrid &solid);
+	~JumpPointSearch() = default;
+
+	/**
+	 * Switches to a different grid (e.g. after a map reload). The grid must outlive this object.
+	 */
+	void setGrid(const BitGrid &solid);
+
+	/**
+	 * Finds the cheapest path from start to goal, filling path with every tile along the way including
+	 * both ends. Returns false (leaving path empty) if there's no path.
+	 */
+	bool findPath(const glm::ivec2 &start, const glm::ivec2 &goal, std::vector<glm::ivec2> &path);
+
+	/**
+	 * As findPath, but only using tiles inside bounds.
+	 */
+	bool findPathWithin(const glm::ivec2 &start, const glm::ivec2 &goal, const TileRect &bounds,
+	        std::vector<glm::ivec2> &path);
+
+	float getLastPathCost() const {
+		return lastPathCost_;
+	}
+
+	/**
+	 * The number of jump points taken off the open list during the last search.
+	 */
+	uint32_t getLastExpandedCount() const {
+		return lastExpandedCount_;
+	}
+
+private:
+	inline bool isWalkable(int32_t x, int32_t y) const {
+		return bounds_.contains(x, y) && !solid_->get(x, y);
+	}
+
+	inline int32_t indexOf(int32_t x, int32_t y) const {
+		return y * width_ + x;
+	}
+
+	bool jump(int32_t x, int32_t y, int32_t dx, int32_t dy, glm::ivec2 * jumpPoint) const;
+	void addSuccessors(int32_t x, int32_t y, int32_t parentIndex);
+	void considerSuccessor(int32_t fromIndex, const glm::ivec2 &from, int32_t dx, int32_t dy);
+	void buildPath(int32_t goalIndex, std::vector<glm::ivec2> &path);
+	void startGeneration();
+
+	const BitGrid *solid_;
+	int32_t width_ = 0;
+	int32_t height_ = 0;
+
+	TileRect bounds_ { 0, 0, 0, 0 };
+	glm::ivec2 goal_;
+
+	// A tile's state is valid only if its stamp matches the current generation, which avoids clearing
+	// the buffers between searches. Even stamps are open, odd stamps are closed.
+	std::vector<uint32_t> stamps_;
+	std::vector<float> costs_;
+	std::vector<int32_t> parents_;
+	uint32_t generation_ = 0u;
+
+	std::vector<std::pair<float, int32_t>> open_;
+
+	float lastPathCost_ = 0.0f;
+	uint32_t lastExpandedCount_ = 0u;
+};
+
+}
+
+#endif /* INCLUDE_PATHFINDING_JUMPPOINTSEARCH_HPP_ */
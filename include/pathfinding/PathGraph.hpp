@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_PATHFINDING_PATHGRAPH_HPP_
+#define INCLUDE_PATHFINDING_PATHGRAPH_HPP_
+
+#include <cstdint>
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "pathfinding/GridSearch.hpp"
+#include "util/BitGrid.hpp"
+
+namespace PlayPG {
+
+/**
+ * The abstract graph used for hierarchical pathfinding (HPA*) on one version of a map.
+ *
+ * The map is split into square clusters. Wherever two neighbouring clusters share a walkable border, one
+ * or two transition tiles are chosen on each side and become nodes; nodes in the same cluster are joined
+ * by edges costing the shortest path between them inside that cluster. Long paths are found on this
+ * small graph and then filled in cluster by cluster.
+ *
+ * A PathGraph never changes after it's built, so one graph can be shared by every thread searching the
+ * same map. When a map is reloaded, updatedFor() produces a graph for the new version which only rebuilds
+ * the clusters whose tiles changed.
+ */
+class PathGraph final {
+public:
+	static constexpr const int32_t DEFAULT_CLUSTER_SIZE = 16;
+
+	// Borders with a walkable run at least this long get a transition at each end rather than one in the middle.
+	static constexpr const int32_t WIDE_ENTRANCE_SIZE = 6;
+
+	struct Edge {
+		uint32_t to;
+		float cost;
+
+		// true if this edge crosses into a neighbouring cluster.
+		bool inter;
+	};
+
+	struct Node {
+		glm::ivec2 tile;
+		uint32_t cluster;
+
+		std::vector<Edge> edges;
+
+		uint32_t transitionCount;
+		bool alive;
+	};
+
+	explicit PathGraph(const BitGrid &solid, int32_t clusterSize = DEFAULT_CLUSTER_SIZE);
+	~PathGraph() = default;
+
+	/**
+	 * Returns a graph for a new version of the collision grid, copying this graph and rebuilding only the
+	 * clusters whose tiles differ (plus their neighbours, whose transitions may have moved). Grids of a
+	 * different size are rebuilt from scratch.
+	 */
+	std::unique_ptr<PathGraph> updatedFor(const BitGrid &newSolid) const;
+
+	uint32_t clusterAt(const glm::ivec2 &tile) const {
+		return static_cast<uint32_t>((tile.y / clusterSize_) * clustersWide_ + tile.x / clusterSize_);
+	}
+
+	TileRect getClusterBounds(uint32_t cluster) const;
+
+	const std::vector<uint32_t> &getClusterNodes(uint32_t cluster) const {
+		return clusterNodes_[cluster];
+	}
+
+	const Node &getNode(uint32_t node) const {
+		return nodes_[node];
+	}
+
+	/**
+	 * The number of node slots, including any freed by updates; node IDs are always less than this.
+	 */
+	uint32_t getNodeSlotCount() const {
+		return static_cast<uint32_t>(nodes_.size());
+	}
+
+	uint32_t getLiveNodeCount() const;
+	std::size_t getEdgeCount() const;
+
+	const BitGrid &getSolidGrid() const {
+		return solid_;
+	}
+
+	int32_t getClusterSize() const {
+		return clusterSize_;
+	}
+
+	int32_t getClustersWide() const {
+		return clustersWide_;
+	}
+
+	int32_t getClustersHigh() const {
+		return clustersHigh_;
+	}
+
+	/**
+	 * How many clusters had their nodes and edges rebuilt when this graph was made.
+	 */
+	uint32_t getRebuiltClusterCount() const {
+		return rebuiltClusterCount_;
+	}
+
+private:
+	PathGraph(const PathGraph &other) = default;
+
+	bool isWalkable(int32_t x, int32_t y) const {
+		return x >= 0 && y >= 0 && x < width_ && y < height_ && !solid_.get(x, y);
+	}
+
+	void rebuildClusters(const std::vector<bool> &dirty);
+	void clearTransitions(std::vector<std::pair<uint32_t, uint32_t>> &transitions);
+	void findTransitions(uint32_t cluster, bool east);
+	void addTransition(const glm::ivec2 &a, const glm::ivec2 &b, std::vector<std::pair<uint32_t, uint32_t>> &transitions);
+	uint32_t getOrCreateNode(const glm::ivec2 &tile);
+	void freeNode(uint32_t node);
+	void connectClusterNodes(uint32_t cluster, BoundedDijkstra &search);
+
+	BitGrid solid_;
+	int32_t width_;
+	int32_t height_;
+
+	int32_t clusterSize_;
+	int32_t clustersWide_;
+	int32_t clustersHigh_;
+
+	std::vector<Node> nodes_;
+	std::vector<uint32_t> freeNodes_;
+	std::unordered_map<int32_t, uint32_t> nodeAtTile_;
+	std::vector<std::vector<uint32_t>> clusterNodes_;
+
+	// Pairs of nodes joined across the east and south border of each cluster.
+	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> eastTransitions_;
+	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> southTransitions_;
+
+	uint32_t rebuiltClusterCount_ = 0u;
+};
+
+}
+
+#endif /* INCLUDE_PATHFINDING_PATHGRAPH_HPP_ */
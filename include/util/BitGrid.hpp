@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_UTIL_BITGRID_HPP_
+#define INCLUDE_UTIL_BITGRID_HPP_
+
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+
+#include <memory>
+#include <vector>
+
+namespace PlayPG {
+
+/**
+ * A 2D grid of bits stored row by row in 64-bit words. Each row is padded to a whole number of words
+ * so that rows never share a word; padding bits are always 0.
+ *
+ * A BitGrid either owns its words or is a read-only view onto words owned by something else (e.g.
+ * a memory mapped compiled map), in which case it holds a reference to the owner to keep it alive.
+ */
+class BitGrid final {
+public:
+	static constexpr const uint32_t BITS_PER_WORD = 64u;
+
+	static uint32_t wordsPerRowFor(uint32_t width) {
+		return (width + BITS_PER_WORD - 1u) / BITS_PER_WORD;
+	}
+
+	/**
+	 * Creates a view of existing words which must be laid out as a BitGrid of the given size would be.
+	 * The view can't be modified.
+	 */
+	static BitGrid view(uint32_t width, uint32_t height, const uint64_t * words, std::shared_ptr<const void> owner);
+
+	/**
+	 * Creates an owning grid with every bit clear.
+	 */
+	explicit BitGrid(uint32_t width = 0u, uint32_t height = 0u);
+
+	inline bool get(uint32_t x, uint32_t y) const {
+		assert(x < width_ && y < height_);
+		return (words()[wordIndex(x, y)] >> (x % BITS_PER_WORD)) & 1u;
+	}
+
+	/**
+	 * Returns the bit at (x, y), or outside if (x, y) isn't in the grid. Compiles to conditional moves
+	 * rather than branches on common compilers.
+	 */
+	inline bool getOr(uint32_t x, uint32_t y, bool outside) const {
+		const bool inside = (x < width_) & (y < height_);
+		const std::size_t index = inside ? wordIndex(x, y) : 0u;
+		const bool bit = (words()[index] >> (x % BITS_PER_WORD)) & 1u;
+
+		return inside ? bit : outside;
+	}
+
+	inline void set(uint32_t x, uint32_t y, bool value = true) {
+		assert(isOwning() && x < width_ && y < height_);
+		const uint64_t mask = uint64_t { 1u } << (x % BITS_PER_WORD);
+		auto &word = storage_[wordIndex(x, y)];
+
+		word = value ? (word | mask) : (word & ~mask);
+	}
+
+	/**
+	 * Returns true if any bit in the rectangle with top-left (x, y) and the given size is set. The
+	 * rectangle is clipped to the grid.
+	 */
+	bool anyInRect(int32_t x, int32_t y, int32_t rectWidth, int32_t rectHeight) const;
+
+	/**
+	 * Returns the x coordinate of the first set bit in row y with xStart <= x < xEnd, or -1 if there
+	 * are none. The range is clipped to the grid.
+	 */
+	int32_t firstSetInRow(uint32_t y, int32_t xStart, int32_t xEnd) const;
+
+	/**
+	 * Calls func(x, y) for every set bit in row-major order.
+	 */
+	template<typename F> void forEachSet(F &&func) const;
+
+	std::size_t count() const;
+
+	inline uint32_t getWidth() const {
+		return width_;
+	}
+
+	inline uint32_t getHeight() const {
+		return height_;
+	}
+
+	inline uint32_t getWordsPerRow() const {
+		return wordsPerRow_;
+	}
+
+	inline std::size_t getWordCount() const {
+		return static_cast<std::size_t>(wordsPerRow_) * height_;
+	}
+
+	inline const uint64_t *getWords() const {
+		return words();
+	}
+
+	inline const uint64_t *getRow(uint32_t y) const {
+		return words() + static_cast<std::size_t>(y) * wordsPerRow_;
+	}
+
+	/**
+	 * Rows never share words, so different threads can safely write to different rows at once.
+	 */
+	inline uint64_t *getMutableRow(uint32_t y) {
+		assert(isOwning());
+		return storage_.data() + static_cast<std::size_t>(y) * wordsPerRow_;
+	}
+
+	inline bool isOwning() const {
+		return external_ == nullptr;
+	}
+
+	/**
+	 * The number of bytes used by the words of this grid, whether they're owned or not.
+	 */
+	inline std::size_t getByteSize() const {
+		return getWordCount() * sizeof(uint64_t);
+	}
+
+private:
+	inline std::size_t wordIndex(uint32_t x, uint32_t y) const {
+		return static_cast<std::size_t>(y) * wordsPerRow_ + x / BITS_PER_WORD;
+	}
+
+	inline const uint64_t *words() const {
+		return external_ == nullptr ? storage_.data() : external_;
+	}
+
+	uint32_t width_;
+	uint32_t height_;
+	uint32_t wordsPerRow_;
+
+	// Always holds at least one word so that getOr never reads from an empty grid.
+	std::vector<uint64_t> storage_;
+
+	const uint64_t * external_ = nullptr;
+	std::shared_ptr<const void> externalOwner_;
+};
+
+namespace util {
+
+int32_t countTrailingZeros(uint64_t word);
+
+}
+
+template<typename F> void BitGrid::forEachSet(F &&func) const {
+	for (uint32_t y = 0u; y < height_; ++y) {
+		const auto row = getRow(y);
+
+		for (uint32_t w = 0u; w < wordsPerRow_; ++w) {
+			uint64_t word = row[w];
+
+			while (word != 0u) {
+				const auto bit = util::countTrailingZeros(word);
+				func(w * BITS_PER_WORD + bit, y);
+				word &= word - 1u;
+			}
+		}
+	}
+}
+
+}
+
+#endif /* INCLUDE_UTIL_BITGRID_HPP_ */
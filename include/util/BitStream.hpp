@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_UTIL_BITSTREAM_HPP_
+#define INCLUDE_UTIL_BITSTREAM_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <vector>
+
+namespace PlayPG {
+
+/**
+ * Packs values into a byte array using only as many bits as each one needs, least significant bit first.
+ */
+class BitWriter final {
+public:
+	explicit BitWriter() = default;
+	~BitWriter() = default;
+
+	/**
+	 * Writes the low bits of value; bits must be at most 32.
+	 */
+	void write(uint32_t value, uint32_t bits);
+
+	void writeBool(bool value) {
+		write(value ? 1u : 0u, 1u);
+	}
+
+	/**
+	 * Small values take 6 bits, large ones up to 66.
+	 */
+	void writeVarUint(uint64_t value);
+
+	/**
+	 * Starts again from nothing, keeping the allocated storage.
+	 */
+	void clear();
+
+	const std::vector<uint8_t> &getBytes() const {
+		return bytes_;
+	}
+
+	std::size_t getBitCount() const {
+		return bitCount_;
+	}
+
+private:
+	std::vector<uint8_t> bytes_;
+	std::size_t bitCount_ = 0u;
+};
+
+/**
+ * Reads values written by a BitWriter. Reading past the end yields zeroes and sets a flag rather than failing
+ * each read, so a decoder can check once at the end.
+ */
+class BitReader final {
+public:
+	explicit BitReader(const uint8_t *data, std::size_t size);
+	~BitReader() = default;
+
+	uint32_t read(uint32_t bits);
+
+	bool readBool() {
+		return read(1u) != 0u;
+	}
+
+	uint64_t readVarUint();
+
+	bool hasOverrun() const {
+		return overrun_;
+	}
+
+private:
+	const uint8_t *data_;
+	const std::size_t bitCount_;
+
+	std::size_t position_ = 0u;
+	bool overrun_ = false;
+};
+
+}
+
+#endif /* INCLUDE_UTIL_BITSTREAM_HPP_ */
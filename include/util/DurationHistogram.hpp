@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_UTIL_DURATIONHISTOGRAM_HPP_
+#define INCLUDE_UTIL_DURATIONHISTOGRAM_HPP_
+
+#include <cstdint>
+
+#include <array>
+#include <chrono>
+
+namespace PlayPG {
+
+/**
+ * Counts durations in logarithmic buckets (four per power of two, so within 25% of the true value) for
+ * cheap percentiles without storing every sample. Durations are in microseconds, up to about an hour.
+ */
+class DurationHistogram final {
+public:
+	static constexpr const uint32_t BUCKET_COUNT = 128u;
+
+	DurationHistogram();
+
+	void record(std::chrono::microseconds duration);
+
+	/**
+	 * Adds every sample in other to this histogram.
+	 */
+	void merge(const DurationHistogram &other);
+
+	void reset();
+
+	/**
+	 * An upper bound for the given percentile (0 - 100) of recorded durations, or 0 if nothing's recorded.
+	 */
+	std::chrono::microseconds percentile(double percent) const;
+
+	std::chrono::microseconds getMax() const {
+		return std::chrono::microseconds { max_ };
+	}
+
+	std::chrono::microseconds getMean() const {
+		return std::chrono::microseconds { count_ == 0u ? 0u : total_ / count_ };
+	}
+
+	uint64_t getCount() const {
+		return count_;
+	}
+
+private:
+	static uint32_t bucketFor(uint64_t micros);
+	static uint64_t bucketUpperBound(uint32_t bucket);
+
+	std::array<uint64_t, BUCKET_COUNT> buckets_;
+
+	uint64_t count_ = 0u;
+	uint64_t total_ = 0u;
+	uint64_t max_ = 0u;
+};
+
+}
+
+#endif /* INCLUDE_UTIL_DURATIONHISTOGRAM_HPP_ */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_UTIL_MAPPEDFILE_HPP_
+#define INCLUDE_UTIL_MAPPEDFILE_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace PlayPG {
+
+/**
+ * A read-only view of an entire file.
+ *
+ * On POSIX platforms the file is mmap()ed, so separate processes mapping the same file share the same
+ * physical pages. Elsewhere the file is read into memory, which behaves identically but without the sharing.
+ */
+class MappedFile final {
+public:
+	/**
+	 * Returns nullptr if the file couldn't be opened or mapped.
+	 */
+	static std::unique_ptr<MappedFile> fromFile(const std::string &fileName);
+
+	~MappedFile();
+
+	MappedFile(const MappedFile &other) = delete;
+	MappedFile &operator=(const MappedFile &other) = delete;
+
+	const uint8_t *data() const {
+		return data_;
+	}
+
+	std::size_t size() const {
+		return size_;
+	}
+
+	const std::string &getFileName() const {
+		return fileName_;
+	}
+
+private:
+	explicit MappedFile(const std::string &fileName);
+
+	std::string fileName_;
+
+	const uint8_t *data_ = nullptr;
+	std::size_t size_ = 0u;
+
+	// Only used where mmap isn't available.
+	std::vector<uint8_t> fallbackBuffer_;
+	bool mapped_ = false;
+};
+
+}
+
+#endif /* INCLUDE_UTIL_MAPPEDFILE_HPP_ */
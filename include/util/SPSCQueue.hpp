@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_UTIL_SPSCQUEUE_HPP_
+#define INCLUDE_UTIL_SPSCQUEUE_HPP_
+
+#include <cstddef>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace PlayPG {
+
+/**
+ * A fixed-capacity ring buffer which is safe for exactly one thread to push and one other thread to pop, without
+ * locking.
+ *
+ * Slots are allocated up front so T must be default constructible and move assignable; a popped slot is left in a
+ * moved-from state until it's reused.
+ */
+template<typename T> class SPSCQueue final {
+public:
+	/**
+	 * capacity is rounded up to a power of two.
+	 */
+	explicit SPSCQueue(std::size_t capacity);
+	~SPSCQueue() = default;
+
+	SPSCQueue(const SPSCQueue &other) = delete;
+	SPSCQueue &operator=(const SPSCQueue &other) = delete;
+
+	/**
+	 * Producer only. Returns false and leaves value untouched if the queue is full.
+	 */
+	bool tryPush(T &&value);
+
+	/**
+	 * Consumer only. Returns false if the queue is empty.
+	 */
+	bool tryPop(T &value);
+
+	/**
+	 * Exact when called by either the producer or the consumer while the other is idle; otherwise a snapshot.
+	 */
+	std::size_t size() const {
+		return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+	}
+
+	bool empty() const {
+		return size() == 0u;
+	}
+
+	std::size_t capacity() const {
+		return slots_.size();
+	}
+
+private:
+	static std::size_t roundUpToPowerOfTwo(std::size_t value);
+
+	// Keeps the producer's and consumer's counters on separate cache lines.
+	static constexpr const std::size_t CACHE_LINE_SIZE = 64u;
+
+	std::vector<T> slots_;
+	const std::size_t mask_;
+
+	// Both counters only ever increase; the slot is counter & mask_.
+	std::atomic<std::size_t> head_ { 0u };
+	char headPadding_[CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>)];
+
+	std::atomic<std::size_t> tail_ { 0u };
+	char tailPadding_[CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>)];
+};
+
+template<typename T> SPSCQueue<T>::SPSCQueue(std::size_t capacity) :
+		        slots_(roundUpToPowerOfTwo(capacity)),
+		        mask_ { slots_.size() - 1u } {
+}
+
+template<typename T> bool SPSCQueue<T>::tryPush(T &&value) {
+	const auto tail = tail_.load(std::memory_order_relaxed);
+
+	if (tail - head_.load(std::memory_order_acquire) == slots_.size()) {
+		return false;
+	}
+
+	slots_[tail & mask_] = std::move(value);
+	tail_.store(tail + 1u, std::memory_order_release);
+
+	return true;
+}
+
+template<typename T> bool SPSCQueue<T>::tryPop(T &value) {
+	const auto head = head_.load(std::memory_order_relaxed);
+
+	if (head == tail_.load(std::memory_order_acquire)) {
+		return false;
+	}
+
+	value = std::move(slots_[head & mask_]);
+	head_.store(head + 1u, std::memory_order_release);
+
+	return true;
+}
+
+template<typename T> std::size_t SPSCQueue<T>::roundUpToPowerOfTwo(std::size_t value) {
+	std::size_t result = 1u;
+
+	while (result < value) {
+		result <<= 1u;
+	}
+
+	return result;
+}
+
+}
+
+#endif /* INCLUDE_UTIL_SPSCQUEUE_HPP_ */
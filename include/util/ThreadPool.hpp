@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_UTIL_THREADPOOL_HPP_
+#define INCLUDE_UTIL_THREADPOOL_HPP_
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace PlayPG {
+
+/**
+ * A fixed set of worker threads which run submitted tasks in the order they were submitted.
+ *
+ * Tasks must not block waiting on other tasks submitted to the same pool, since every worker could end
+ * up waiting.
+ */
+class ThreadPool final {
+public:
+	/**
+	 * The number of hardware threads on this machine, or fallback if that can't be determined.
+	 */
+	static unsigned int defaultThreadCount(unsigned int fallback = 4u);
+
+	explicit ThreadPool(unsigned int threadCount = ThreadPool::defaultThreadCount());
+
+	/**
+	 * Waits for any queued tasks to finish before joining the workers.
+	 */
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &other) = delete;
+	ThreadPool &operator=(const ThreadPool &other) = delete;
+
+	template<typename F> auto submit(F &&func) -> std::future<typename std::result_of<F()>::type>;
+
+	unsigned int getThreadCount() const {
+		return static_cast<unsigned int>(workers_.size());
+	}
+
+private:
+	void workerLoop();
+
+	std::vector<std::thread> workers_;
+
+	std::deque<std::function<void()>> tasks_;
+	std::mutex tasksMutex_;
+	std::condition_variable tasksCondition_;
+
+	bool stopping_ = false;
+};
+
+template<typename F> auto ThreadPool::submit(F &&func) -> std::future<typename std::result_of<F()>::type> {
+	using result_type = typename std::result_of<F()>::type;
+
+	// std::function must be copyable, but packaged_task isn't; share it instead.
+	auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(func));
+	auto future = task->get_future();
+
+	{
+		std::lock_guard<std::mutex> lock(tasksMutex_);
+		tasks_.emplace_back([task]() {(*task)();});
+	}
+
+	tasksCondition_.notify_one();
+
+	return future;
+}
+
+}
+
+#endif /* INCLUDE_UTIL_THREADPOOL_HPP_ */
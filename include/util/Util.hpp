@@ -28,6 +28,9 @@
 #ifndef INCLUDE_UTIL_UTIL_HPP_
 #define INCLUDE_UTIL_UTIL_HPP_
 
+#include <cstdint>
+
+#include <chrono>
 #include <string>
 #include <vector>
 #include <type_traits>
@@ -40,6 +43,14 @@ template<typename T> constexpr auto to_integral(T t) -> typename std::underlying
 	return static_cast<typename std::underlying_type_t<T>>(t);
 }
 
+/**
+ * Microseconds on a monotonic clock with an arbitrary epoch; used wherever times are sent over the network.
+ */
+inline uint64_t monotonicMicros() {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+	        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
 }
 
 class ByteArrayUtil {
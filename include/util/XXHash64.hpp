@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_UTIL_XXHASH64_HPP_
+#define INCLUDE_UTIL_XXHASH64_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <array>
+#include <string>
+
+namespace PlayPG {
+
+/**
+ * Streaming implementation of the 64-bit xxHash algorithm (XXH64).
+ *
+ * Much faster than a cryptographic hash and good enough to tell whether two map files are the same;
+ * it offers no protection against someone deliberately crafting a collision.
+ */
+class XXHash64 final {
+public:
+	/**
+	 * Hashes a complete buffer in one call.
+	 */
+	static uint64_t hash(const void *data, std::size_t length, uint64_t seed = 0u);
+
+	/**
+	 * Formats a hash as 16 lowercase hex digits, most significant first.
+	 */
+	static std::string toHex(uint64_t hash);
+
+	explicit XXHash64(uint64_t seed = 0u);
+	~XXHash64() = default;
+
+	void update(const void *data, std::size_t length);
+
+	/**
+	 * Returns the hash of everything passed to update() so far. Can be called more than once, and update()
+	 * may be called again afterwards.
+	 */
+	uint64_t digest() const;
+
+private:
+	static constexpr const std::size_t STRIPE_SIZE = 32u;
+
+	void consumeStripe(const uint8_t *stripe);
+
+	uint64_t seed_;
+	std::array<uint64_t, 4> accumulators_;
+
+	std::array<uint8_t, STRIPE_SIZE> buffer_;
+	std::size_t bufferSize_ = 0u;
+
+	uint64_t totalLength_ = 0u;
+};
+
+}
+
+#endif /* INCLUDE_UTIL_XXHASH64_HPP_ */
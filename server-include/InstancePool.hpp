@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SERVER_INSTANCEPOOL_HPP_
+#define INCLUDE_SERVER_INSTANCEPOOL_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <APG/core/APGeasylogging.hpp>
+
+#include "MapSimulation.hpp"
+#include "MapSlot.hpp"
+#include "TickScheduler.hpp"
+
+namespace PlayPG {
+
+/**
+ * Runs private copies of one map, e.g. a dungeon per party. Whoever sends players to the map picks an instance
+ * ID; everyone joining with the same ID plays in the same copy.
+ *
+ * Every instance is made up front and shares the slot's map, hibernating while unused, so handing one out is a
+ * lookup rather than a load. An instance goes back to the pool once it's empty and has hibernated.
+ */
+class InstancePool final {
+public:
+	static constexpr const uint32_t DEFAULT_SIZE = 64u;
+
+	explicit InstancePool(MapSlot &slot, uint32_t size = DEFAULT_SIZE,
+	        uint32_t tickRate = MapSimulation::DEFAULT_TICK_RATE);
+	~InstancePool() = default;
+
+	InstancePool(const InstancePool &other) = delete;
+	InstancePool &operator=(const InstancePool &other) = delete;
+
+	/**
+	 * Adds every instance to the scheduler, which must not outlive this pool.
+	 */
+	void addTo(TickScheduler &scheduler);
+
+	/**
+	 * Returns the instance running instanceID, taking a free one from the pool if there isn't one yet, or nullptr
+	 * if every instance is in use. acquire() and collect() must be called on the same thread.
+	 */
+	MapSimulation *acquire(uint64_t instanceID, el::Logger * const logger);
+
+	/**
+	 * Returns instances which have emptied and hibernated to the pool.
+	 */
+	void collect(el::Logger * const logger);
+
+	const std::string &getName() const {
+		return slot_.getName();
+	}
+
+	std::size_t getActiveCount() const {
+		return active_.size();
+	}
+
+	std::size_t getSize() const {
+		return instances_.size();
+	}
+
+private:
+	MapSlot &slot_;
+
+	std::vector<std::unique_ptr<MapSimulation>> instances_;
+	std::vector<MapSimulation *> free_;
+	std::unordered_map<uint64_t, MapSimulation *> active_;
+};
+
+}
+
+#endif /* INCLUDE_SERVER_INSTANCEPOOL_HPP_ */
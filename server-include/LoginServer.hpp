@@ -106,7 +106,9 @@ struct MapServerConnection {
 	}
 
 	std::unique_ptr<APG::Socket> connection;
-	const std::vector<Location> maps;
+
+	// Updated when the map server reloads a map.
+	std::vector<Location> maps;
 
 	const std::string friendlyName;
 
@@ -152,6 +154,11 @@ private:
 	void processCharacterRequest(const std::unique_ptr<PlayerSession> &session, el::Logger * const logger);
 	void processCharacterSelect(const std::unique_ptr<PlayerSession> &session, el::Logger * const logger);
 
+	// Methods used to process messages from registered map servers.
+	void processMapServerUpdates(el::Logger * const logger);
+	void processMapUpdate(MapServerConnection &mapServer, const Location &updatedLocation,
+	        el::Logger * const logger);
+
 	bool regenerateKeys_ = false;
 	std::unique_ptr<RSACrypto> crypto;
 	SHACrypto hasher { 32000 };
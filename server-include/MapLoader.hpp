@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SERVER_MAPLOADER_HPP_
+#define INCLUDE_SERVER_MAPLOADER_HPP_
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <tmxparser/TmxMap.h>
+
+#include <APG/core/APGeasylogging.hpp>
+
+#include "Map.hpp"
+#include "MapHeader.hpp"
+#include "MapHashCache.hpp"
+#include "pathfinding/PathGraph.hpp"
+#include "util/ThreadPool.hpp"
+
+namespace PlayPG {
+
+struct LoadedMap final {
+	std::string path;
+
+	// nullptr for compiled maps, which don't need tmxparser.
+	std::unique_ptr<Tmx::Map> tmxMap;
+
+	// nullptr if the map failed to load, in which case errorText says why.
+	std::unique_ptr<Map> map;
+	std::string errorText;
+
+	// Hash of the source TMX file as it was when loaded, for comparing against later versions.
+	std::string hash;
+
+	// Shared with any Pathfinder searching this map; nullptr if the map failed to load.
+	std::shared_ptr<const PathGraph> pathGraph;
+
+	std::chrono::microseconds loadTime { 0 };
+};
+
+struct ScannedMapHeader final {
+	MapHeader header;
+
+	std::chrono::microseconds scanTime { 0 };
+};
+
+/**
+ * Loads many maps at once on a thread pool, so that startup time depends on the largest map rather than on
+ * the total size of every map.
+ *
+ * Results are always returned (and logged) in the same order as the paths passed in, regardless of
+ * which maps finish loading first.
+ */
+class MapLoader final {
+public:
+	/**
+	 * Loads a single map on the calling thread, choosing between TMX and compiled maps by extension.
+	 * If a hash cache is given it's used (and updated) when hashing the map's source.
+	 *
+	 * If previous is an earlier version of the same map, its pathfinding graph is updated rather than
+	 * built from scratch, so only the clusters which changed are rebuilt.
+	 *
+	 * parseThreads bounds how many threads a large TMX map's tiles are parsed on.
+	 */
+	static LoadedMap loadMap(const std::string &path, el::Logger * const logger,
+	        MapHashCache * const hashCache = nullptr, const LoadedMap * const previous = nullptr,
+	        unsigned int parseThreads = 1u);
+
+	explicit MapLoader(ThreadPool &pool);
+	~MapLoader() = default;
+
+	std::vector<LoadedMap> loadMaps(const std::vector<std::string> &paths, el::Logger * const logger,
+	        MapHashCache * const hashCache = nullptr);
+	std::vector<ScannedMapHeader> scanHeaders(const std::vector<std::string> &paths, el::Logger * const logger,
+	        MapHashCache * const hashCache = nullptr);
+
+private:
+	ThreadPool &pool_;
+};
+
+}
+
+#endif /* INCLUDE_SERVER_MAPLOADER_HPP_ */
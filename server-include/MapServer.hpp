@@ -28,22 +28,34 @@
 #ifndef INCLUDE_SERVER_MAPSERVER_HPP_
 #define INCLUDE_SERVER_MAPSERVER_HPP_
 
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <memory>
-
-#include <tmxparser/TmxMap.h>
+#include <mutex>
+#include <thread>
 
 #include "ServerCommon.hpp"
-#include "Map.hpp"
+#include "MapSlot.hpp"
+#include "MapSimulation.hpp"
+#include "InstancePool.hpp"
+#include "TickScheduler.hpp"
+#include "Location.hpp"
 #include "net/crypto/RSACrypto.hpp"
+#include "net/WorldSession.hpp"
+#include "util/ThreadPool.hpp"
 
 namespace PlayPG {
 
 class MapServer final : public Server {
 public:
 	explicit MapServer(const ServerDetails &details, const DatabaseDetails &databaseDetails_, const std::string &masterServer_, const uint16_t &masterPort,
-	        const std::string &masterPublicKeyFile_, const std::string &masterPrivateKeyFile_);
+	        const std::string &masterPublicKeyFile_, const std::string &masterPrivateKeyFile_, bool reloadChangedMaps_ = true,
+	        uint32_t tickRate_ = MapSimulation::DEFAULT_TICK_RATE,
+	        std::chrono::seconds hibernateAfter_ = TickScheduler::DEFAULT_HIBERNATE_AFTER,
+	        std::vector<std::string> instancedMaps_ = std::vector<std::string>(),
+	        uint32_t instancePoolSize_ = InstancePool::DEFAULT_SIZE);
 	virtual ~MapServer() = default;
 
 	virtual void run() override final;
@@ -52,17 +64,66 @@ private:
 	bool parseMaps(el::Logger * const logger);
 	bool registerWithMasterServer(el::Logger * const logger);
 
-	std::vector<std::unique_ptr<Tmx::Map>> tmxparserMaps;
-	std::vector<PlayPG::Map> maps;
+	/**
+	 * Run on mapWatchThread; reloads maps when their files change and tells the master server.
+	 */
+	void watchMaps(el::Logger * const logger);
+	void reloadMap(const std::string &changedPath, el::Logger * const logger);
+	MapSlot *findSlotForPath(const std::string &path) const;
+	void sendMapUpdate(const Location &location, el::Logger * const logger);
+
+	void startSimulations(el::Logger * const logger);
+	MapSimulation *findSimulation(const std::string &mapName) const;
+	InstancePool *findInstancePool(const std::string &mapName) const;
+
+	/**
+	 * New players must say which map they're joining before they're handed over to that map's simulation.
+	 */
+	void processPendingJoins(el::Logger * const logger);
+	void processJoinRequest(std::unique_ptr<APG::Socket> &socket, el::Logger * const logger);
+
+	/**
+	 * Moves packets between every joined player's socket and their session queues.
+	 * Returns true if anything was read or written.
+	 */
+	bool serviceSessions(el::Logger * const logger);
+
+	std::vector<std::unique_ptr<MapSlot>> mapSlots;
+	std::unique_ptr<MapHashCache> hashCache;
+
+	const bool reloadChangedMaps;
+	std::thread mapWatchThread;
+
+	const uint32_t tickRate;
+	const std::chrono::seconds hibernateAfter;
+	std::vector<std::unique_ptr<MapSimulation>> simulations;
+
+	// Names of the maps which also run private instances, each with its own pool.
+	const std::vector<std::string> instancedMaps;
+	const uint32_t instancePoolSize;
+	std::vector<std::unique_ptr<InstancePool>> instancePools;
+	std::unique_ptr<ThreadPool> simulationPool;
+	std::unique_ptr<TickScheduler> tickScheduler;
+	std::thread simulationThread;
+
+	struct PendingJoin {
+		std::unique_ptr<APG::Socket> socket;
+		std::chrono::steady_clock::time_point acceptedAt;
+	};
 
 	std::unique_ptr<APG::AcceptorSocket> playerAcceptor;
-	std::unique_ptr<APG::Socket> connectedPlayers;
+	std::vector<PendingJoin> pendingJoins;
+	std::vector<std::shared_ptr<WorldSession>> sessions;
+	uint64_t nextPlayerGUID = 1u;
 
 	const std::string masterServerHostname;
 	const uint16_t masterServerPort;
 
 	std::unique_ptr<RSACrypto> masterServerCrypto;
 	std::unique_ptr<APG::Socket> masterServerConnection;
+	std::mutex masterServerMutex;
+
+	std::atomic<bool> done { false };
 };
 
 }
@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SERVER_MAPSIMULATION_HPP_
+#define INCLUDE_SERVER_MAPSIMULATION_HPP_
+
+#include <cstdint>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include <APG/core/APGeasylogging.hpp>
+
+#include "EntityGrid.hpp"
+#include "InterestManager.hpp"
+#include "MapSlot.hpp"
+#include "MovementValidator.hpp"
+#include "PositionHistory.hpp"
+#include "TerrainOverlay.hpp"
+#include "TriggerTracker.hpp"
+#include "net/Packet.hpp"
+#include "net/Snapshot.hpp"
+#include "net/WorldSession.hpp"
+
+namespace PlayPG {
+
+/**
+ * A move a client has asked for, as a tile offset.
+ */
+struct RequestedMove final {
+	uint32_t sequence;
+	glm::ivec2 delta;
+};
+
+/**
+ * A player connected to a map server and playing on one of its maps.
+ */
+struct SimulatedPlayer final {
+	// How many recent snapshots can still be used as a delta baseline.
+	static constexpr const uint32_t SNAPSHOT_HISTORY = 32u;
+
+	explicit SimulatedPlayer(uint64_t guid_, uint64_t characterID_, std::shared_ptr<WorldSession> session_) :
+			        guid { guid_ },
+			        characterID { characterID_ },
+			        session { std::move(session_) } {
+	}
+
+	const uint64_t guid;
+	const uint64_t characterID;
+
+	// Shared with the I/O thread, which owns the socket.
+	std::shared_ptr<WorldSession> session;
+
+	glm::ivec2 tile { 0, 0 };
+
+	// GUIDs of the entities in this player's area of interest, sorted.
+	std::vector<uint64_t> visible;
+
+	// What visible was when each recent snapshot was sent.
+	SnapshotRing<std::vector<uint64_t>> visibleHistory { SNAPSHOT_HISTORY };
+
+	// The newest snapshot the client has acknowledged, or 0.
+	uint32_t ackedSnapshot = 0u;
+
+	// Moves read this tick, waiting to be validated.
+	std::vector<RequestedMove> requestedMoves;
+
+	// The newest move the server has dealt with, one way or another.
+	uint32_t lastMoveSequence = 0u;
+	bool movesHandled = false;
+
+	// Set when a move is rejected, so the client is told where the player really is.
+	bool needsCorrection = false;
+
+	// Packets produced by the update phase, sent during the output phase.
+	std::vector<std::unique_ptr<Packet>> outgoing;
+
+	bool disconnected = false;
+};
+
+/**
+ * Simulates one map at a fixed tick rate. Each tick runs three phases:
+ *
+ * - input: admit joining players and drain every player's inbound queue,
+ * - update: advance the world by one tick and work out who needs to hear about what,
+ * - output: queue what the update produced for the I/O thread to send.
+ *
+ * The map is acquired from its slot once per tick, so a hot swap takes effect between ticks.
+ * tick() is driven by a TickScheduler and must never be called on two threads at once; addPlayer()
+ * can be called from anywhere.
+ *
+ * The scheduler slows down or stops ticking a map nobody is on, so a tick may come long after the last one.
+ * Anything which depends on the time between ticks is brought up to date before such a tick runs. A map left
+ * empty long enough hibernates, freeing the map and everything built from it until a player joins.
+ *
+ * Instance 0 is a map's shared world. Other instances are private copies of the same map, e.g. one per party
+ * in a dungeon; they share the slot's map and only keep their own players, indices and any tiles they change.
+ * An instance starts out hibernating, so one nobody has used yet costs little more than this object.
+ */
+class MapSimulation final {
+public:
+	static constexpr const uint32_t DEFAULT_TICK_RATE = 20u;
+
+	// Stops one chatty player from holding up the whole tick.
+	static constexpr const uint32_t MAX_MESSAGES_PER_PLAYER_PER_TICK = 32u;
+
+	// How far from their own tile a player can interact, along either axis.
+	static constexpr const int32_t MAX_INTERACTION_RANGE = 1;
+
+	// Instances are meant for small groups, so each keeps a smaller lag-compensation history.
+	static constexpr const uint32_t INSTANCE_HISTORY_ENTITIES = 32u;
+
+	explicit MapSimulation(MapSlot &slot, uint32_t tickRate = DEFAULT_TICK_RATE, uint32_t instance = 0u);
+	~MapSimulation() = default;
+
+	MapSimulation(const MapSimulation &other) = delete;
+	MapSimulation &operator=(const MapSimulation &other) = delete;
+
+	/**
+	 * Queues a player to join at the start of the next tick.
+	 */
+	void addPlayer(std::unique_ptr<SimulatedPlayer> &&player);
+
+	void tick();
+
+	/**
+	 * Frees the map and everything derived from it; the next tick with a player joining loads it again. Does
+	 * nothing if anyone is on the map. Like tick(), never call it on two threads at once.
+	 */
+	void hibernate();
+
+	bool isHibernating() const {
+		return hibernating_.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Changes a tile's collision in this simulation only, e.g. to open a door in one instance of a dungeon. Other
+	 * instances of the map aren't affected. Changes last until the map is reloaded or hibernates. Call only from
+	 * the tick.
+	 */
+	void setSolidAtTile(const glm::ivec2 &tile, bool solid) {
+		terrain_.setSolidAtTile(tile, solid);
+	}
+
+	/**
+	 * The map's name, followed by "#" and the instance number for instances other than 0.
+	 */
+	const std::string &getName() const {
+		return name_;
+	}
+
+	uint32_t getInstance() const {
+		return instance_;
+	}
+
+	std::chrono::microseconds getTickPeriod() const {
+		return tickPeriod_;
+	}
+
+	uint64_t getTickCount() const {
+		return tickCount_.load(std::memory_order_relaxed);
+	}
+
+	std::size_t getPlayerCount() const {
+		return playerCount_.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * True from addPlayer() until the player has joined, so a map can be woken for them.
+	 */
+	bool hasJoiningPlayers() const {
+		return hasJoining_.load(std::memory_order_acquire);
+	}
+
+private:
+	void inputPhase(el::Logger * const logger);
+	void updatePhase(el::Logger * const logger);
+	void outputPhase(el::Logger * const logger);
+
+	void readMessages(SimulatedPlayer &player, el::Logger * const logger);
+
+	/**
+	 * Builds the collision, interest and trigger indices and the lag-compensation history for map_.
+	 */
+	void buildWorld();
+
+	/**
+	 * Loads the map again after hibernating. Returns false if it can't be loaded.
+	 */
+	bool wake(el::Logger * const logger);
+
+	/**
+	 * Turns away everyone waiting to join, e.g. when the map can't be woken for them.
+	 */
+	void rejectJoining(el::Logger * const logger);
+
+	/**
+	 * Catches up after missing ticks while the map was idle or suspended.
+	 */
+	void reconcile(std::chrono::microseconds sinceLastTick, el::Logger * const logger);
+
+	/**
+	 * Rebuilds everything derived from the map after a new version is published.
+	 */
+	void changeMap(std::shared_ptr<const LoadedMap> &&newMap, el::Logger * const logger);
+
+	/**
+	 * Validates and applies every move requested this tick, in batches.
+	 */
+	void moveStage();
+
+	/**
+	 * Judges an interaction against where everything was at renderTime, as the player saw it.
+	 */
+	void interact(SimulatedPlayer &player, uint64_t renderTime, const glm::ivec2 &target, el::Logger * const logger);
+
+	void spawnPlayer(SimulatedPlayer &player);
+	void movePlayer(SimulatedPlayer &player, const glm::ivec2 &tile);
+	void updateTriggers(SimulatedPlayer &player);
+
+	/**
+	 * Remembers where everyone is at the end of this tick, for lag compensation.
+	 */
+	void recordHistory(uint64_t serverTime, el::Logger * const logger);
+
+	/**
+	 * Records this tick's snapshot and queues each player a delta of what they can see against the last snapshot
+	 * they acknowledged.
+	 */
+	void replicate(uint64_t serverTime, el::Logger * const logger);
+	void updateVisible(const InterestEvent &event);
+
+	SimulatedPlayer *findPlayer(uint64_t guid) const;
+
+	MapSlot &slot_;
+	const uint32_t instance_;
+	const std::string name_;
+	const uint32_t tickRate_;
+	const std::chrono::microseconds tickPeriod_;
+
+	std::shared_ptr<const LoadedMap> map_;
+	uint64_t mapGeneration_;
+	TerrainOverlay terrain_;
+
+	std::unique_ptr<EntityGrid> entities_;
+	std::unique_ptr<InterestManager> interest_;
+	std::vector<InterestEvent> interestEvents_;
+
+	SnapshotFormat snapshotFormat_;
+	SnapshotRing<std::vector<EntityState>> snapshots_ { SimulatedPlayer::SNAPSHOT_HISTORY };
+	uint32_t snapshotSequence_ = 0u;
+
+	// Reused every tick to avoid allocating.
+	std::vector<EntityState> baselineStates_;
+	std::vector<EntityState> visibleStates_;
+	BitWriter delta_;
+	std::unique_ptr<TriggerTracker> triggers_;
+
+	const MovementValidator movement_;
+	MoveBatch moveBatch_;
+
+	std::unique_ptr<PositionHistory> history_;
+
+	std::vector<TriggerEvent> triggerEvents_;
+
+	std::vector<std::unique_ptr<SimulatedPlayer>> players_;
+	std::unordered_map<uint64_t, SimulatedPlayer *> playersByGUID_;
+
+	std::vector<std::unique_ptr<SimulatedPlayer>> joining_;
+	std::mutex joiningMutex_;
+
+	// Only touched by the tick.
+	std::chrono::steady_clock::time_point lastTickAt_;
+
+	std::atomic<uint64_t> tickCount_ { 0u };
+	std::atomic<std::size_t> playerCount_ { 0u };
+	std::atomic<bool> hasJoining_ { false };
+	std::atomic<bool> hibernating_ { false };
+};
+
+}
+
+#endif /* INCLUDE_SERVER_MAPSIMULATION_HPP_ */
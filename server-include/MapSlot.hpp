@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SERVER_MAPSLOT_HPP_
+#define INCLUDE_SERVER_MAPSLOT_HPP_
+
+#include <cstdint>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <APG/core/APGeasylogging.hpp>
+
+#include "MapHashCache.hpp"
+#include "MapLoader.hpp"
+
+namespace PlayPG {
+
+/**
+ * Holds the current version of one map, which can be replaced while other threads are using it.
+ *
+ * Readers call acquire() once (e.g. at the start of a tick) and use the returned map until they're done
+ * with it. publish() swaps in a new version without waiting for readers; the old version is freed when
+ * the last reader holding it lets go, so a reader never sees a map change part way through.
+ *
+ * Several simulations can run the same slot's map, e.g. instances of a dungeon, all sharing one copy. Once none
+ * of them are using it the slot hibernates, letting go of its map entirely until one needs it again.
+ *
+ * A hibernating slot keeps a compiled copy of the last version it accepted. Waking loads the map from disk again,
+ * but a version which has changed is only used if it passes the same checks as a reload; otherwise, or if the
+ * file no longer loads, the compiled copy is used instead.
+ */
+class MapSlot final {
+public:
+	enum class ReloadCheck
+		: uint8_t {
+			ACCEPT = 0x00,
+		UNCHANGED = 0x01,
+		REJECT = 0x02
+	};
+
+	/**
+	 * Called after waking picks up a new version of the map from disk, so that it can be announced as if it had
+	 * been reloaded. Can be called from any thread which wakes the slot.
+	 */
+	using version_listener = std::function<void(const MapSlot &slot, el::Logger * const logger)>;
+
+	/**
+	 * hashCache can be nullptr, and must otherwise outlive the slot.
+	 */
+	explicit MapSlot(std::shared_ptr<const LoadedMap> &&initial, MapHashCache * const hashCache = nullptr);
+	~MapSlot();
+
+	MapSlot(const MapSlot &other) = delete;
+	MapSlot &operator=(const MapSlot &other) = delete;
+
+	/**
+	 * Must be set before anything uses the slot.
+	 */
+	void setVersionListener(version_listener listener) {
+		versionListener_ = std::move(listener);
+	}
+
+	/**
+	 * nullptr while hibernating.
+	 */
+	std::shared_ptr<const LoadedMap> acquire() const;
+
+	/**
+	 * Checks whether a freshly loaded copy of this slot's map can replace the current version, logging why not.
+	 * Renamed maps and older versions are rejected.
+	 */
+	ReloadCheck checkReload(const LoadedMap &reloaded, el::Logger * const logger) const;
+
+	/**
+	 * Replaces the current map, returning the new generation number. next must have passed checkReload(). While
+	 * hibernating only the new version's details and a compiled copy are kept; it's loaded again on waking.
+	 */
+	uint64_t publish(std::shared_ptr<const LoadedMap> &&next, el::Logger * const logger);
+
+	/**
+	 * Called by each simulation which starts running the map, loading it again if hibernating. Returns false,
+	 * still hibernating, if neither the file nor the compiled copy can be loaded.
+	 */
+	bool addUser(el::Logger * const logger);
+
+	/**
+	 * Called by a simulation which no longer needs the map. Once none do the slot hibernates, letting go of the
+	 * current map, which is freed once the last reader holding it is done.
+	 */
+	void removeUser(el::Logger * const logger);
+
+	bool isHibernating() const {
+		return hibernating_.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Where the current version was loaded from, its hash and its version; still known while hibernating.
+	 */
+	std::string getPath() const;
+	std::string getHash() const;
+	uint32_t getVersion() const;
+
+	/**
+	 * Starts at 0 and increases by one each time a new version is published.
+	 */
+	uint64_t getGeneration() const {
+		return generation_.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * The name of the map held in this slot, which never changes when reloading.
+	 */
+	const std::string &getName() const {
+		return name_;
+	}
+
+private:
+	/**
+	 * Loads the map from disk if it's still acceptable, or from the compiled copy otherwise.
+	 */
+	LoadedMap loadForWaking(const std::string &path, bool *changed, el::Logger * const logger) const;
+
+	/**
+	 * Replaces the compiled copy of the last accepted version, unless the copy already has its hash.
+	 */
+	void saveFallback(const LoadedMap &map, el::Logger * const logger);
+
+	std::shared_ptr<const LoadedMap> current_;
+	std::atomic<uint64_t> generation_ { 0u };
+
+	const std::string name_;
+	MapHashCache * const hashCache_;
+	version_listener versionListener_;
+
+	// Held for the whole of hibernating, waking and publishing, which can take a while. Always taken before mutex_.
+	std::mutex transitionMutex_;
+	std::string fallbackPath_;
+	std::string fallbackHash_;
+
+	// Guards the details of the current version and changes to whether the slot is hibernating.
+	mutable std::mutex mutex_;
+	std::string path_;
+	std::string hash_;
+	uint32_t version_;
+	uint32_t users_ = 0u;
+	std::atomic<bool> hibernating_ { false };
+};
+
+}
+
+#endif /* INCLUDE_SERVER_MAPSLOT_HPP_ */
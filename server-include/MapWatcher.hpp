@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SERVER_MAPWATCHER_HPP_
+#define INCLUDE_SERVER_MAPWATCHER_HPP_
+
+#include <ctime>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <APG/core/APGeasylogging.hpp>
+
+namespace PlayPG {
+
+/**
+ * Watches directories for map files (.tmx or .ppg) which are written or moved into place.
+ *
+ * Uses inotify on Linux. On other platforms modification times are polled instead, which is slower
+ * to notice changes but otherwise behaves the same.
+ */
+class MapWatcher final {
+public:
+	explicit MapWatcher(const std::vector<std::string> &directories, el::Logger * const logger);
+	~MapWatcher();
+
+	MapWatcher(const MapWatcher &other) = delete;
+	MapWatcher &operator=(const MapWatcher &other) = delete;
+
+	/**
+	 * Waits up to timeoutMS milliseconds for map files to change, returning the path of each changed file
+	 * once. Several events for one file in quick succession (as most editors produce when saving) are
+	 * merged into one.
+	 */
+	std::vector<std::string> waitForChanges(int timeoutMS);
+
+	bool isWatching() const {
+		return watching_;
+	}
+
+private:
+	static bool isMapFile(const std::string &fileName);
+
+	el::Logger * const logger_;
+	bool watching_ = false;
+
+#ifdef __linux__
+	std::vector<std::string> readEvents(int timeoutMS);
+
+	int inotifyFD_ = -1;
+	std::unordered_map<int, std::string> watchedDirectories_;
+#else
+	void scanModificationTimes(std::vector<std::string> * changed);
+
+	std::vector<std::string> directories_;
+	std::unordered_map<std::string, std::time_t> modificationTimes_;
+#endif
+};
+
+}
+
+#endif /* INCLUDE_SERVER_MAPWATCHER_HPP_ */
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SERVER_MOVEMENTVALIDATOR_HPP_
+#define INCLUDE_SERVER_MOVEMENTVALIDATOR_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "util/BitGrid.hpp"
+
+namespace PlayPG {
+
+/**
+ * A batch of move requests in structure-of-arrays form, so validation streams through a few flat arrays instead of
+ * chasing a pointer per player.
+ */
+struct MoveBatch final {
+	void clear();
+	void add(uint32_t mover, const glm::ivec2 &from, int32_t dx, int32_t dy);
+
+	std::size_t size() const {
+		return movers.size();
+	}
+
+	// Whatever the caller uses to find the mover again, e.g. an index into its player list.
+	std::vector<uint32_t> movers;
+
+	std::vector<int32_t> fromX;
+	std::vector<int32_t> fromY;
+	std::vector<int32_t> dx;
+	std::vector<int32_t> dy;
+
+	// Filled in by MovementValidator::validate. A rejected move's destination is where it started.
+	std::vector<int32_t> toX;
+	std::vector<int32_t> toY;
+	std::vector<uint8_t> accepted;
+};
+
+/**
+ * Checks requested moves against a map's collision grid and a speed limit.
+ *
+ * A move is accepted if neither axis changes by more than maxStep tiles and the destination is an open tile inside
+ * the map. A player can move at most maxMovesPerTick times a tick; each of a player's moves in a tick goes in a
+ * separate batch, in order, since each starts where the last finished.
+ */
+class MovementValidator final {
+public:
+	static constexpr const int32_t DEFAULT_MAX_STEP = 1;
+	static constexpr const uint32_t DEFAULT_MAX_MOVES_PER_TICK = 2u;
+
+	explicit MovementValidator(int32_t maxStep = DEFAULT_MAX_STEP,
+	        uint32_t maxMovesPerTick = DEFAULT_MAX_MOVES_PER_TICK);
+	~MovementValidator() = default;
+
+	/**
+	 * Validates every move in batch at once, filling in its destinations and results. Returns how many were
+	 * accepted.
+	 */
+	std::size_t validate(const BitGrid &solid, MoveBatch &batch) const;
+
+	int32_t getMaxStep() const {
+		return maxStep_;
+	}
+
+	uint32_t getMaxMovesPerTick() const {
+		return maxMovesPerTick_;
+	}
+
+private:
+	const int32_t maxStep_;
+	const uint32_t maxMovesPerTick_;
+};
+
+}
+
+#endif /* INCLUDE_SERVER_MOVEMENTVALIDATOR_HPP_ */
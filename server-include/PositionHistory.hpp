@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SERVER_POSITIONHISTORY_HPP_
+#define INCLUDE_SERVER_POSITIONHISTORY_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <chrono>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+namespace PlayPG {
+
+/**
+ * Where every entity was at one recorded tick; a view into a PositionHistory, valid until the next tick is
+ * recorded.
+ */
+class RewoundTick final {
+public:
+	explicit RewoundTick() = default;
+	explicit RewoundTick(uint64_t tick, uint64_t serverTime, std::size_t count, const uint64_t *guids, const int32_t *x,
+	        const int32_t *y) :
+			        tick_ { tick },
+			        serverTime_ { serverTime },
+			        count_ { count },
+			        guids_ { guids },
+			        x_ { x },
+			        y_ { y } {
+	}
+
+	~RewoundTick() = default;
+
+	/**
+	 * Returns false if guid wasn't on the map at this tick.
+	 */
+	bool find(uint64_t guid, glm::ivec2 * const tile) const;
+
+	/**
+	 * Calls f(guid, tile) for each entity no more than radius tiles from centre along either axis.
+	 */
+	template<typename F> void forEachWithin(const glm::ivec2 &centre, int32_t radius, F &&f) const;
+
+	uint64_t getTick() const {
+		return tick_;
+	}
+
+	uint64_t getServerTime() const {
+		return serverTime_;
+	}
+
+	std::size_t size() const {
+		return count_;
+	}
+
+private:
+	uint64_t tick_ = 0u;
+	uint64_t serverTime_ = 0u;
+	std::size_t count_ = 0u;
+
+	const uint64_t *guids_ = nullptr;
+	const int32_t *x_ = nullptr;
+	const int32_t *y_ = nullptr;
+};
+
+/**
+ * Remembers where every entity on a map was at each of the last few ticks, so interactions can be judged against
+ * what a client saw when it acted rather than against the present.
+ *
+ * Every tick's positions are stored as structure-of-arrays in storage allocated up front, so recording never
+ * allocates and rewound queries scan a few packed arrays. Memory is fixed at tick rate × window × maxEntities.
+ */
+class PositionHistory final {
+public:
+	static constexpr const std::chrono::microseconds DEFAULT_WINDOW { 1000000 };
+	static constexpr const uint32_t DEFAULT_MAX_ENTITIES = 256u;
+
+	explicit PositionHistory(uint32_t tickRate, std::chrono::microseconds window = DEFAULT_WINDOW,
+	        uint32_t maxEntities = DEFAULT_MAX_ENTITIES);
+	~PositionHistory() = default;
+
+	/**
+	 * Starts recording a new tick taken at serverTime, replacing the oldest once the history is full. Times must
+	 * increase.
+	 */
+	void beginTick(uint64_t tick, uint64_t serverTime);
+
+	/**
+	 * Adds an entity to the tick being recorded. Returns false if the tick already has maxEntities.
+	 */
+	bool record(uint64_t guid, const glm::ivec2 &tile);
+
+	/**
+	 * The newest tick taken at or before serverTime. Times before the window are judged against the oldest tick,
+	 * and times in the future against the newest. Returns false if nothing has been recorded.
+	 */
+	bool rewind(uint64_t serverTime, RewoundTick * const rewound) const;
+
+	void clear();
+
+	std::size_t getTickCapacity() const {
+		return tickCapacity_;
+	}
+
+	std::size_t getTickCount() const {
+		return count_;
+	}
+
+	uint32_t getMaxEntities() const {
+		return maxEntities_;
+	}
+
+private:
+	std::size_t slotFor(std::size_t index) const {
+		return (first_ + index) % tickCapacity_;
+	}
+
+	const std::size_t tickCapacity_;
+	const uint32_t maxEntities_;
+
+	// Per tick.
+	std::vector<uint64_t> ticks_;
+	std::vector<uint64_t> serverTimes_;
+	std::vector<uint32_t> counts_;
+
+	// Per tick per entity; tick slot s owns [s * maxEntities_, (s + 1) * maxEntities_).
+	std::vector<uint64_t> guids_;
+	std::vector<int32_t> x_;
+	std::vector<int32_t> y_;
+
+	std::size_t first_ = 0u;
+	std::size_t count_ = 0u;
+};
+
+template<typename F> void RewoundTick::forEachWithin(const glm::ivec2 &centre, int32_t radius, F &&f) const {
+	for (std::size_t i = 0u; i < count_; ++i) {
+		const auto dx = x_[i] - centre.x;
+		const auto dy = y_[i] - centre.y;
+
+		if (dx >= -radius && dx <= radius && dy >= -radius && dy <= radius) {
+			f(guids_[i], glm::ivec2 { x_[i], y_[i] });
+		}
+	}
+}
+
+}
+
+#endif /* INCLUDE_SERVER_POSITIONHISTORY_HPP_ */
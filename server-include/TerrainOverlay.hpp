@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SERVER_TERRAINOVERLAY_HPP_
+#define INCLUDE_SERVER_TERRAINOVERLAY_HPP_
+
+#include <cstddef>
+
+#include <memory>
+
+#include <glm/vec2.hpp>
+
+#include "MapLoader.hpp"
+#include "util/BitGrid.hpp"
+
+namespace PlayPG {
+
+/**
+ * One simulation's collision for a map which other simulations may be sharing. Reads go straight to the shared
+ * map's solid grid until a tile is changed, at which point the grid is copied once and the copy is used from then
+ * on, so an instance which never changes anything costs nothing.
+ */
+class TerrainOverlay final {
+public:
+	/**
+	 * An empty overlay, in which every tile is solid.
+	 */
+	explicit TerrainOverlay() = default;
+	explicit TerrainOverlay(std::shared_ptr<const LoadedMap> terrain);
+
+	/**
+	 * Throws away any changes and shares terrain's collision instead; terrain can be nullptr to let go of it.
+	 */
+	void reset(std::shared_ptr<const LoadedMap> terrain);
+
+	/**
+	 * Tiles outside the map are solid, as for Map::isSolidAtTile.
+	 */
+	bool isSolidAtTile(const glm::ivec2 &tile) const {
+		return solid_.getOr(tile.x, tile.y, true);
+	}
+
+	/**
+	 * Copies the shared collision the first time it's called. Tiles outside the map are ignored.
+	 */
+	void setSolidAtTile(const glm::ivec2 &tile, bool solid);
+
+	const BitGrid &getSolidGrid() const {
+		return solid_;
+	}
+
+	/**
+	 * True until a tile is changed.
+	 */
+	bool isShared() const {
+		return !solid_.isOwning();
+	}
+
+	/**
+	 * The memory used by this overlay's own copy of the collision, or 0 while it's shared.
+	 */
+	std::size_t getPrivateByteSize() const {
+		return isShared() ? 0u : solid_.getByteSize();
+	}
+
+private:
+	BitGrid solid_;
+};
+
+}
+
+#endif /* INCLUDE_SERVER_TERRAINOVERLAY_HPP_ */
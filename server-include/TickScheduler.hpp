@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_SERVER_TICKSCHEDULER_HPP_
+#define INCLUDE_SERVER_TICKSCHEDULER_HPP_
+
+#include <cstdint>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <APG/core/APGeasylogging.hpp>
+
+#include "MapSimulation.hpp"
+#include "util/DurationHistogram.hpp"
+#include "util/ThreadPool.hpp"
+
+namespace PlayPG {
+
+/**
+ * Ticks every MapSimulation at its own fixed rate on a thread pool.
+ *
+ * Maps are scheduled independently: a map whose tick runs long only delays its own next tick, while other
+ * maps keep ticking on the remaining workers. A map that falls more than MAX_CATCH_UP_TICKS behind skips
+ * the missed ticks rather than running them back to back.
+ *
+ * Maps are only ticked as hard as their population needs. A map with players ticks at its full rate; once it's
+ * empty it drops to an idle rate for EMPTY_GRACE_PERIOD in case someone comes straight back, then is suspended
+ * until a player joins it. The map catches up on anything time-dependent on its first tick after waking.
+ * A map suspended for longer than hibernateAfter hibernates, freeing its memory until someone joins.
+ *
+ * Tick durations are recorded per map and logged every REPORT_INTERVAL, along with overruns (ticks which
+ * took longer than the tick period) and skipped ticks.
+ */
+class TickScheduler final {
+public:
+	enum class TickMode
+		: uint8_t {
+			FULL = 0x00,
+		IDLE = 0x01,
+		SUSPENDED = 0x02
+	};
+
+	static constexpr const uint32_t MAX_CATCH_UP_TICKS = 2u;
+	static constexpr const std::chrono::seconds REPORT_INTERVAL { 30 };
+
+	// An idle map ticks this many times less often than a full one.
+	static constexpr const uint32_t IDLE_RATE_DIVISOR = 10u;
+	static constexpr const std::chrono::seconds EMPTY_GRACE_PERIOD { 30 };
+	static constexpr const std::chrono::seconds DEFAULT_HIBERNATE_AFTER { 300 };
+
+	/**
+	 * A hibernateAfter of zero never hibernates maps, other than instances, which hibernate as soon as they're
+	 * suspended.
+	 */
+	explicit TickScheduler(ThreadPool &pool, std::chrono::seconds hibernateAfter = DEFAULT_HIBERNATE_AFTER);
+	~TickScheduler() = default;
+
+	TickScheduler(const TickScheduler &other) = delete;
+	TickScheduler &operator=(const TickScheduler &other) = delete;
+
+	/**
+	 * Adds a simulation, which must outlive the scheduler. Not safe to call while run() is running.
+	 */
+	void add(MapSimulation &simulation);
+
+	/**
+	 * Ticks every simulation until done becomes true, then waits for any running ticks to finish.
+	 */
+	void run(const std::atomic<bool> &done, el::Logger * const logger);
+
+private:
+	using tick_clock = std::chrono::steady_clock;
+
+	struct ScheduledMap {
+		explicit ScheduledMap(MapSimulation &simulation_) :
+				        simulation { simulation_ } {
+		}
+
+		MapSimulation &simulation;
+
+		tick_clock::time_point nextTick;
+		std::future<void> running;
+
+		TickMode mode = TickMode::FULL;
+		tick_clock::time_point lastOccupied;
+		tick_clock::time_point suspendedAt;
+
+		// Written by whichever worker ran the tick, read when reporting.
+		std::mutex statsMutex;
+		DurationHistogram tickDurations;
+		uint64_t overruns = 0u;
+
+		// Only touched by the scheduling thread.
+		uint64_t skippedTicks = 0u;
+		uint64_t lateTicks = 0u;
+		bool waitingForTick = false;
+	};
+
+	TickMode chooseMode(ScheduledMap &scheduled, tick_clock::time_point now) const;
+	void startTick(ScheduledMap &scheduled);
+	void startHibernating(ScheduledMap &scheduled);
+	void report(el::Logger * const logger);
+
+	ThreadPool &pool_;
+	const std::chrono::seconds hibernateAfter_;
+	std::vector<std::unique_ptr<ScheduledMap>> maps_;
+};
+
+}
+
+#endif /* INCLUDE_SERVER_TICKSCHEDULER_HPP_ */
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "InstancePool.hpp"
+
+namespace PlayPG {
+
+constexpr const uint32_t InstancePool::DEFAULT_SIZE;
+
+InstancePool::InstancePool(MapSlot &slot, uint32_t size, uint32_t tickRate) :
+		        slot_ { slot } {
+	instances_.reserve(size);
+	free_.reserve(size);
+
+	// Instance 0 is the map's shared world, which isn't pooled.
+	for (uint32_t i = 1u; i <= size; ++i) {
+		instances_.emplace_back(std::make_unique<MapSimulation>(slot_, tickRate, i));
+	}
+
+	// Hand out low numbers first, which keeps the logs easy to follow.
+	for (auto it = instances_.rbegin(); it != instances_.rend(); ++it) {
+		free_.emplace_back(it->get());
+	}
+}
+
+void InstancePool::addTo(TickScheduler &scheduler) {
+	for (const auto &instance : instances_) {
+		scheduler.add(*instance);
+	}
+}
+
+MapSimulation *InstancePool::acquire(uint64_t instanceID, el::Logger * const logger) {
+	const auto found = active_.find(instanceID);
+
+	if (found != active_.end()) {
+		return found->second;
+	}
+
+	if (free_.empty()) {
+		logger->warn("All %v instances of %v are in use; can't start instance %v.", instances_.size(), getName(),
+		        instanceID);
+		return nullptr;
+	}
+
+	auto instance = free_.back();
+	free_.pop_back();
+	active_.emplace(instanceID, instance);
+
+	logger->verbose(5, "Running instance %v of %v as %v; %v of %v instances in use.", instanceID, getName(),
+	        instance->getName(), active_.size(), instances_.size());
+
+	return instance;
+}
+
+void InstancePool::collect(el::Logger * const logger) {
+	for (auto it = active_.begin(); it != active_.end();) {
+		const auto instance = it->second;
+
+		// A player joining hasn't woken it yet.
+		if (!instance->isHibernating() || instance->hasJoiningPlayers()) {
+			++it;
+			continue;
+		}
+
+		logger->verbose(5, "Instance %v of %v has finished; %v is free again.", it->first, getName(),
+		        instance->getName());
+
+		free_.emplace_back(instance);
+		it = active_.erase(it);
+	}
+}
+
+}
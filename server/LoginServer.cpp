@@ -46,6 +46,11 @@
 #include "Location.hpp"
 #include "odb/Location_odb.hpp"
 
+#include "MapHeader.hpp"
+#include "MapHashCache.hpp"
+#include "MapLoader.hpp"
+#include "util/ThreadPool.hpp"
+
 namespace PlayPG {
 
 LoginServer::LoginServer(const ServerDetails &serverDetails_, const DatabaseDetails &databaseDetails_,
@@ -123,18 +128,30 @@ void LoginServer::run() {
 void LoginServer::processMaps(el::Logger * const logger) {
 	auto &mapPaths = serverDetails.maps.get();
 
-	for (const auto & mapPath : mapPaths) {
-		auto map = std::make_unique<Tmx::Map>();
+	// The login server never needs tile data, so only the headers are read rather than doing a full parse.
+	// Scanning (and hashing) happens in parallel; the database is then updated in the original map order.
+	// Maps which haven't changed since the last run have cached hashes and aren't read past their headers.
+	std::vector<ScannedMapHeader> scannedHeaders;
+
+	if (!mapPaths.empty()) {
+		MapHashCache hashCache(MapHashCache::defaultCacheFileFor(mapPaths.front()), logger);
+		ThreadPool scanningPool(ThreadPool::defaultThreadCount(PLAYPG_CORES_AVIAILABLE));
+		MapLoader loader(scanningPool);
+
+		scannedHeaders = loader.scanHeaders(mapPaths, logger, &hashCache);
+		hashCache.save();
+	}
 
-		map->ParseFile(mapPath);
+	for (const auto &scannedHeader : scannedHeaders) {
+		const auto &header = scannedHeader.header;
+		const auto &mapPath = header.fileName;
 
-		if (map->HasError()) {
-			logger->error("Couldn't parse %v: %v.", mapPath, map->GetErrorText());
+		if (!header.valid) {
+			logger->error("Couldn't parse %v: %v.", mapPath, header.errorText);
 			continue;
 		}
 
-		auto loadedLocation = Location(Map::resolveNameFromMap(map.get(), logger), mapPath,
-		        Location::makeMD5Hash(map->GetFilehash()), Map::resolveVersionFromMap(map.get(), logger));
+		auto loadedLocation = Location(header.name, mapPath, header.hash, header.version);
 
 		odb::transaction t(db->begin());
 
@@ -164,7 +181,15 @@ void LoginServer::processMaps(el::Logger * const logger) {
 			loadedLocation.id = databaseLocation.id;
 
 			if (loadedLocation.version == databaseLocation.version) {
-				if (locIterator->knownMD5Hash != loadedLocation.knownMD5Hash) {
+				if (databaseLocation.hashAlgorithm != loadedLocation.hashAlgorithm) {
+					// Stored by an older server using a different hash algorithm; nothing has really changed.
+					databaseLocation.knownHash = loadedLocation.knownHash;
+					databaseLocation.hashAlgorithm = loadedLocation.hashAlgorithm;
+
+					db->update<Location>(databaseLocation);
+					logger->verbose(1, "Updated hash of map %v to %v in the database.", loadedLocation.locationName,
+					        loadedLocation.hashAlgorithm);
+				} else if (locIterator->knownHash != loadedLocation.knownHash) {
 					/*
 					 * As implemented, this is incredibly unlikely because changing the version number will change the hash.
 					 *
@@ -180,7 +205,8 @@ void LoginServer::processMaps(el::Logger * const logger) {
 				if (loadedLocation.version > databaseLocation.version) {
 					// We have a newer version of the map; update in the database.
 
-					databaseLocation.knownMD5Hash = loadedLocation.knownMD5Hash;
+					databaseLocation.knownHash = loadedLocation.knownHash;
+					databaseLocation.hashAlgorithm = loadedLocation.hashAlgorithm;
 					databaseLocation.version = loadedLocation.version;
 
 					db->update<Location>(databaseLocation);
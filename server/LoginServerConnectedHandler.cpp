@@ -25,17 +25,22 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <utility>
 #include <memory>
 
 #include <odb/transaction.hxx>
 
+#include <APG/APGS11N.hpp>
+
 #include "LoginServer.hpp"
+#include "MapHeader.hpp"
 #include "net/packets/CharacterPackets.hpp"
 #include "net/packets/ErrorPackets.hpp"
 
 #include "Character.hpp"
 #include "odb/Character_odb.hpp"
+#include "odb/Location_odb.hpp"
 
 namespace PlayPG {
 
@@ -118,10 +123,116 @@ void LoginServer::processConnected() {
 
 				logger->info("Purged %v connected sockets.", (sizeBefore - sizeAfter));
 			}
+
+			processMapServerUpdates(logger);
 		}
 	}
 }
 
+void LoginServer::processMapServerUpdates(el::Logger * const logger) {
+	std::lock_guard<std::mutex> mapServersLock(mapServersMutex);
+
+	for (auto &mapServer : mapServers) {
+		if (mapServer.connection->hasError() || !mapServer.connection->hasActivity()) {
+			continue;
+		}
+
+		if (mapServer.connection->recv() == 0) {
+			logger->verbose(1, "Couldn't read from map server \"%v\" despite activity.", mapServer.friendlyName);
+			continue;
+		}
+
+		const auto opcode = mapServer.connection->getShort();
+
+		if (opcode != util::to_integral(ServerOpcode::MAP_SERVER_MAP_UPDATE)) {
+			logger->verbose(8, "Unhandled opcode received from map server \"%v\": %v", mapServer.friendlyName, opcode);
+			mapServer.connection->clear();
+			continue;
+		}
+
+		const auto jsonLength = mapServer.connection->getShort();
+		const auto json = mapServer.connection->getStringByLength(jsonLength);
+		mapServer.connection->clear();
+
+		// MapServerMapUpdate uses the same JSON layout as MapServerMapList.
+		APG::JSONSerializer<MapServerMapList> jsonSerializer;
+		const auto updatedMaps = jsonSerializer.fromJSON(json.c_str());
+
+		for (const auto &updatedLocation : updatedMaps.mapHashes) {
+			processMapUpdate(mapServer, updatedLocation, logger);
+		}
+	}
+}
+
+void LoginServer::processMapUpdate(MapServerConnection &mapServer, const Location &updatedLocation,
+        el::Logger * const logger) {
+	const auto &mapName = updatedLocation.locationName;
+	const auto handlerIt = mapNameToConnection.find(mapName);
+
+	if (handlerIt == mapNameToConnection.end() || handlerIt->second != &mapServer) {
+		logger->verbose(1, "Map server \"%v\" sent an update for %v, which it doesn't handle; ignoring.",
+		        mapServer.friendlyName, mapName);
+		return;
+	}
+
+	auto ourMap = std::find_if(allMaps.begin(), allMaps.end(),
+	        [&mapName](const Location &location) {return location.locationName == mapName;});
+
+	if (ourMap == allMaps.end()) {
+		return;
+	}
+
+	// Players are only sent to map servers whose maps match ours, so check our copy has changed in the same way.
+	const auto header = MapHeader::scanFile(ourMap->knownFileName, logger);
+
+	if (!header.valid || updatedLocation.hashAlgorithm != MapHeader::HASH_ALGORITHM
+	        || header.hash != updatedLocation.knownHash) {
+		logger->error("Map server \"%v\" reloaded %v but our copy in %v doesn't match; no longer sending players there.",
+		        mapServer.friendlyName, mapName, ourMap->knownFileName);
+
+		mapNameToConnection.erase(handlerIt);
+		return;
+	}
+
+	ourMap->knownHash = header.hash;
+	ourMap->hashAlgorithm = MapHeader::HASH_ALGORITHM;
+	ourMap->version = header.version;
+
+	for (auto &serverMap : mapServer.maps) {
+		if (serverMap.locationName == mapName) {
+			serverMap.knownHash = header.hash;
+			serverMap.hashAlgorithm = MapHeader::HASH_ALGORITHM;
+			serverMap.version = header.version;
+		}
+	}
+
+	odb::transaction t(db->begin());
+
+	odb::query<Location> q(odb::query<Location>::locationName == odb::query<Location>::_ref(mapName));
+	auto results = db->query<Location>(q);
+
+	if (!results.empty()) {
+		Location databaseLocation = *results.begin();
+
+		if (header.version > databaseLocation.version) {
+			databaseLocation.knownHash = header.hash;
+			databaseLocation.hashAlgorithm = MapHeader::HASH_ALGORITHM;
+			databaseLocation.version = header.version;
+
+			db->update<Location>(databaseLocation);
+			logger->verbose(1, "Updated map %v to new version %v in the database.", mapName, header.version);
+		} else if (header.version == databaseLocation.version && header.hash != databaseLocation.knownHash) {
+			logger->error("Map hash difference for %v (id %v), despite matching version number: %v.", mapName,
+			        databaseLocation.id, header.version);
+		}
+	}
+
+	t.commit();
+
+	logger->info("Map server \"%v\" reloaded %v; now at version %v.", mapServer.friendlyName, mapName,
+	        header.version);
+}
+
 void LoginServer::processCharacterRequest(const std::unique_ptr<PlayerSession> &session, el::Logger * const logger) {
 	odb::transaction t(db->begin());
 
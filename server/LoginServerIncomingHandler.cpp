@@ -315,7 +315,7 @@ void LoginServer::processMapListSocket(IncomingConnection &connection, el::Logge
 
 		for (const auto &ourMap : allMaps) {
 			if (mapID.locationName == ourMap.locationName) {
-				if (mapID.knownMD5Hash == ourMap.knownMD5Hash) {
+				if (mapID.hashAlgorithm == ourMap.hashAlgorithm && mapID.knownHash == ourMap.knownHash) {
 					weSupport = true;
 
 					if (mapNameToConnection.find(mapID.locationName) == mapNameToConnection.end()) {
@@ -335,7 +335,7 @@ void LoginServer::processMapListSocket(IncomingConnection &connection, el::Logge
 		}
 
 		logger->verbose(7, "Map server supports \"%v\" with hash: %v (%v by this login server) (%v by this server)",
-		        mapID.locationName, mapID.knownMD5Hash, (weSupport ? "recognised" : "not recognised"),
+		        mapID.locationName, mapID.knownHash, (weSupport ? "recognised" : "not recognised"),
 		        (weIgnore ? "ignored" : "not ignored"));
 	}
 
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <future>
+#include <utility>
+
+#include <tmxparser/Tmx.h>
+
+#include "MapLoader.hpp"
+#include "CompiledMap.hpp"
+
+namespace PlayPG {
+
+namespace {
+
+using load_clock = std::chrono::steady_clock;
+
+std::chrono::microseconds timeSince(const load_clock::time_point &start) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(load_clock::now() - start);
+}
+
+}
+
+MapLoader::MapLoader(ThreadPool &pool) :
+		        pool_ { pool } {
+}
+
+LoadedMap MapLoader::loadMap(const std::string &path, el::Logger * const logger, MapHashCache * const hashCache,
+        const LoadedMap * const previous, unsigned int parseThreads) {
+	const auto start = load_clock::now();
+
+	LoadedMap ret;
+	ret.path = path;
+
+	if (CompiledMap::hasCompiledExtension(path)) {
+		// Compiled maps need neither tmxparser nor tinyxml2.
+		const auto compiledMap = CompiledMap::fromFile(path, logger);
+
+		if (compiledMap == nullptr) {
+			ret.errorText = "invalid compiled map";
+		} else {
+			ret.map = std::make_unique<Map>(*compiledMap);
+		}
+	} else {
+		auto tmxMap = std::make_unique<Tmx::Map>();
+
+		tmxMap->ParseFile(path);
+
+		if (tmxMap->HasError()) {
+			ret.errorText = tmxMap->GetErrorText();
+		} else {
+			ret.map = std::make_unique<Map>(tmxMap.get(), parseThreads);
+			ret.tmxMap = std::move(tmxMap);
+		}
+	}
+
+	if (ret.map != nullptr) {
+		ret.hash = ret.map->getSourceHash().empty() ? MapHeader::hashFile(path, hashCache) : ret.map->getSourceHash();
+
+		const auto graphStart = load_clock::now();
+
+		if (previous != nullptr && previous->pathGraph != nullptr) {
+			ret.pathGraph = previous->pathGraph->updatedFor(ret.map->getSolidGrid());
+		} else {
+			ret.pathGraph = std::make_shared<PathGraph>(ret.map->getSolidGrid());
+		}
+
+		logger->verbose(9, "Built path graph for %v in %vms: %v nodes, %v edges, %v clusters rebuilt.", path,
+		        timeSince(graphStart).count() / 1000.0, ret.pathGraph->getLiveNodeCount(),
+		        ret.pathGraph->getEdgeCount(), ret.pathGraph->getRebuiltClusterCount());
+	}
+
+	ret.loadTime = timeSince(start);
+	return ret;
+}
+
+std::vector<LoadedMap> MapLoader::loadMaps(const std::vector<std::string> &paths, el::Logger * const logger,
+        MapHashCache * const hashCache) {
+	const auto start = load_clock::now();
+
+	std::vector<std::future<LoadedMap>> futures;
+	futures.reserve(paths.size());
+
+	// Split the pool's threads between the maps rather than letting each map parse on every core; a
+	// lone large map still gets the whole budget.
+	const auto parseThreads = std::max(1u,
+	        pool_.getThreadCount() / static_cast<unsigned int>(std::max<std::size_t>(1u, paths.size())));
+
+	for (const auto &path : paths) {
+		futures.emplace_back(pool_.submit([path, logger, hashCache, parseThreads]() {
+			return MapLoader::loadMap(path, logger, hashCache, nullptr, parseThreads);
+		}));
+	}
+
+	std::vector<LoadedMap> results;
+	results.reserve(paths.size());
+
+	for (auto &future : futures) {
+		results.emplace_back(future.get());
+
+		const auto &result = results.back();
+
+		if (result.map == nullptr) {
+			logger->error("Couldn't parse %v: %v.", result.path, result.errorText);
+		} else {
+			logger->verbose(5, "Loaded \"%v\" from %v in %vms.", result.map->getName(), result.path,
+			        result.loadTime.count() / 1000.0);
+		}
+	}
+
+	logger->info("Loaded %v maps in %vms using %v threads.", paths.size(), timeSince(start).count() / 1000.0,
+	        pool_.getThreadCount());
+
+	return results;
+}
+
+std::vector<ScannedMapHeader> MapLoader::scanHeaders(const std::vector<std::string> &paths,
+        el::Logger * const logger, MapHashCache * const hashCache) {
+	const auto start = load_clock::now();
+
+	std::vector<std::future<ScannedMapHeader>> futures;
+	futures.reserve(paths.size());
+
+	for (const auto &path : paths) {
+		futures.emplace_back(pool_.submit([path, logger, hashCache]() {
+			const auto scanStart = load_clock::now();
+
+			ScannedMapHeader ret;
+			ret.header = MapHeader::scanFile(path, logger, hashCache);
+			ret.scanTime = timeSince(scanStart);
+
+			return ret;
+		}));
+	}
+
+	std::vector<ScannedMapHeader> results;
+	results.reserve(paths.size());
+
+	for (auto &future : futures) {
+		results.emplace_back(future.get());
+
+		const auto &result = results.back();
+
+		if (result.header.valid) {
+			logger->verbose(5, "Scanned \"%v\" from %v in %vms.", result.header.name, result.header.fileName,
+			        result.scanTime.count() / 1000.0);
+		}
+	}
+
+	logger->info("Scanned %v map headers in %vms using %v threads.", paths.size(), timeSince(start).count() / 1000.0,
+	        pool_.getThreadCount());
+
+	return results;
+}
+
+}
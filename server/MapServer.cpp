@@ -27,23 +27,36 @@
 
 #include <cstring>
 
+#include <algorithm>
 #include <utility>
 
+#include <boost/filesystem.hpp>
+
 #include <APG/APGS11N.hpp>
 #include <APG/core/APGeasylogging.hpp>
 
 #include <tmxparser/Tmx.h>
 
 #include "net/packets/LoginPackets.hpp"
+#include "net/packets/MapPackets.hpp"
 #include "MapServer.hpp"
+#include "MapLoader.hpp"
+#include "MapWatcher.hpp"
+#include "util/ThreadPool.hpp"
 #include "PlayPGVersion.hpp"
 
 namespace PlayPG {
 
 MapServer::MapServer(const ServerDetails &serverDetails_, const DatabaseDetails &databaseDetails_,
         const std::string &masterServer_, const uint16_t &masterPort_, const std::string &masterPublicKeyFile_,
-        const std::string &masterPrivateKeyFile_) :
+        const std::string &masterPrivateKeyFile_, bool reloadChangedMaps_, uint32_t tickRate_,
+        std::chrono::seconds hibernateAfter_, std::vector<std::string> instancedMaps_, uint32_t instancePoolSize_) :
 		        Server(serverDetails_, databaseDetails_),
+		        reloadChangedMaps { reloadChangedMaps_ },
+		        tickRate { tickRate_ },
+		        hibernateAfter { hibernateAfter_ },
+		        instancedMaps { std::move(instancedMaps_) },
+		        instancePoolSize { instancePoolSize_ },
 		        masterServerHostname { masterServer_ },
 		        masterServerPort { masterPort_ },
 		        masterServerCrypto { RSACrypto::fromFiles(masterPublicKeyFile_, masterPrivateKeyFile_) },
@@ -75,19 +88,217 @@ void MapServer::run() {
 
 	logger->info("Listening on port %v.", serverDetails.port);
 
-	while (true) {
+	if (reloadChangedMaps) {
+		mapWatchThread = std::thread([this, logger]() {this->watchMaps(logger);});
+	}
+
+	startSimulations(logger);
+
+	// Nothing here blocks, so don't spin when nobody's connecting or talking.
+	static constexpr const std::chrono::milliseconds IO_POLL_INTERVAL { 1 };
+
+	while (!done) {
 		auto newPlayerSocket = playerAcceptor->acceptSocket();
 
 		if (newPlayerSocket != nullptr) {
-			logger->verbose(9, "Accepted a connection from: %v. Sending to processing thread.",
+			logger->verbose(9, "Accepted a connection from: %v. Waiting for it to join a map.",
 			        newPlayerSocket->remoteHost);
-		} else {
-			if (playerAcceptor->hasError()) {
-				logger->error("Error in playerAcceptor, exiting.");
-				break;
-			}
+			pendingJoins.emplace_back(PendingJoin { std::move(newPlayerSocket), std::chrono::steady_clock::now() });
+		} else if (playerAcceptor->hasError()) {
+			logger->error("Error in playerAcceptor, exiting.");
+			break;
+		}
+
+		for (auto &pool : instancePools) {
+			pool->collect(logger);
+		}
+
+		processPendingJoins(logger);
+
+		if (!serviceSessions(logger) && newPlayerSocket == nullptr) {
+			std::this_thread::sleep_for(IO_POLL_INTERVAL);
+		}
+	}
+
+	done = true;
+
+	if (simulationThread.joinable()) {
+		simulationThread.join();
+	}
+
+	if (mapWatchThread.joinable()) {
+		mapWatchThread.join();
+	}
+}
+
+void MapServer::startSimulations(el::Logger * const logger) {
+	simulationPool = std::make_unique<ThreadPool>(ThreadPool::defaultThreadCount(PLAYPG_CORES_AVIAILABLE));
+	tickScheduler = std::make_unique<TickScheduler>(*simulationPool, hibernateAfter);
+
+	for (const auto &slot : mapSlots) {
+		simulations.emplace_back(std::make_unique<MapSimulation>(*slot, tickRate));
+		tickScheduler->add(*simulations.back());
+	}
+
+	for (const auto &mapName : instancedMaps) {
+		const auto slot = std::find_if(mapSlots.begin(), mapSlots.end(),
+		        [&mapName](const std::unique_ptr<MapSlot> &candidate) {return candidate->getName() == mapName;});
+
+		if (slot == mapSlots.end()) {
+			logger->warn("Can't run instances of \"%v\", which this server doesn't run.", mapName);
+			continue;
+		}
+
+		instancePools.emplace_back(std::make_unique<InstancePool>(**slot, instancePoolSize, tickRate));
+		instancePools.back()->addTo(*tickScheduler);
+
+		logger->info("Running up to %v instances of %v.", instancePoolSize, mapName);
+	}
+
+	logger->info("Simulating %v maps at %vHz on %v threads.", simulations.size(), tickRate,
+	        simulationPool->getThreadCount());
+
+	simulationThread = std::thread([this, logger]() {this->tickScheduler->run(done, logger);});
+}
+
+MapSimulation *MapServer::findSimulation(const std::string &mapName) const {
+	for (const auto &simulation : simulations) {
+		if (simulation->getName() == mapName) {
+			return simulation.get();
+		}
+	}
+
+	return nullptr;
+}
+
+InstancePool *MapServer::findInstancePool(const std::string &mapName) const {
+	for (const auto &pool : instancePools) {
+		if (pool->getName() == mapName) {
+			return pool.get();
+		}
+	}
+
+	return nullptr;
+}
+
+void MapServer::processPendingJoins(el::Logger * const logger) {
+	static constexpr const std::chrono::seconds JOIN_TIMEOUT { 10 };
+
+	const auto now = std::chrono::steady_clock::now();
+
+	for (auto &pending : pendingJoins) {
+		if (pending.socket->hasError()) {
+			pending.socket = nullptr;
+		} else if (pending.socket->hasActivity()) {
+			// Either the socket is handed to a simulation or the request was bad; both leave it pending no longer.
+			processJoinRequest(pending.socket, logger);
+			pending.socket = nullptr;
+		} else if (now - pending.acceptedAt > JOIN_TIMEOUT) {
+			logger->verbose(1, "Connection from %v didn't join a map in time; disconnecting.", pending.socket->remoteHost);
+			pending.socket = nullptr;
 		}
 	}
+
+	pendingJoins.erase(std::remove_if(pendingJoins.begin(), pendingJoins.end(), [](const PendingJoin &pending) {
+		return pending.socket == nullptr;
+	}), pendingJoins.end());
+}
+
+void MapServer::processJoinRequest(std::unique_ptr<APG::Socket> &socket, el::Logger * const logger) {
+	socket->clear();
+
+	if (socket->recv(2) != 2 || socket->getShort() != util::to_integral(ClientOpcode::MAP_JOIN)) {
+		logger->verbose(1, "Connection from %v sent something other than a map join request.", socket->remoteHost);
+		return;
+	}
+
+	if (socket->recv(2) != 2) {
+		return;
+	}
+
+	const uint16_t mapNameLength = socket->getShort();
+
+	if (socket->recv(mapNameLength) != mapNameLength) {
+		return;
+	}
+
+	const auto mapName = socket->getStringByLength(mapNameLength);
+
+	if (socket->recv(8) != 8) {
+		return;
+	}
+
+	const uint64_t characterID = socket->getLong();
+
+	if (socket->recv(8) != 8) {
+		return;
+	}
+
+	const uint64_t instanceID = socket->getLong();
+
+	MapSimulation *simulation = nullptr;
+
+	if (instanceID == 0u) {
+		simulation = findSimulation(mapName);
+
+		if (simulation == nullptr) {
+			logger->verbose(1, "Connection from %v tried to join map \"%v\" which this server doesn't run.",
+			        socket->remoteHost, mapName);
+			return;
+		}
+	} else {
+		const auto pool = findInstancePool(mapName);
+
+		if (pool == nullptr) {
+			logger->verbose(1, "Connection from %v tried to join instance %v of \"%v\", which isn't instanced.",
+			        socket->remoteHost, instanceID, mapName);
+			return;
+		}
+
+		// The pool says why if every instance is taken.
+		simulation = pool->acquire(instanceID, logger);
+
+		if (simulation == nullptr) {
+			return;
+		}
+	}
+
+	const auto guid = nextPlayerGUID++;
+
+	logger->verbose(5, "Character %v from %v is joining %v as player %v.", characterID, socket->remoteHost,
+	        simulation->getName(), guid);
+
+	auto session = std::make_shared<WorldSession>(guid, std::move(socket));
+	sessions.emplace_back(session);
+
+	simulation->addPlayer(std::make_unique<SimulatedPlayer>(guid, characterID, std::move(session)));
+}
+
+bool MapServer::serviceSessions(el::Logger * const logger) {
+	bool busy = false;
+
+	for (auto &session : sessions) {
+		busy |= session->pumpInbound(logger) > 0u;
+		busy |= session->flushOutbound(logger) > 0u;
+
+		// The simulation notices a closed session on its next tick and lets go of its own reference.
+		session->releaseSocket();
+	}
+
+	const auto finished = [logger](const std::shared_ptr<WorldSession> &session) {
+		if (!session->isClosed()) {
+			return false;
+		}
+
+		logger->verbose(5, "Player %v (%v) left; round trip was %vus (min %vus, variation %vus).", session->guid,
+		        session->remoteHost, session->getSmoothedRoundTrip().count(), session->getMinRoundTrip().count(),
+		        session->getRoundTripVariation().count());
+		return true;
+	};
+
+	sessions.erase(std::remove_if(sessions.begin(), sessions.end(), finished), sessions.end());
+
+	return busy;
 }
 
 bool MapServer::registerWithMasterServer(el::Logger * const logger) {
@@ -179,7 +390,13 @@ bool MapServer::registerWithMasterServer(el::Logger * const logger) {
 		return false;
 	}
 
-	auto mapHashes = MapServerMapList::listFromMaps(maps);
+	std::vector<Location> locations;
+
+	for (const auto &slot : mapSlots) {
+		locations.emplace_back(slot->getName(), slot->getPath(), slot->getHash(), slot->getVersion());
+	}
+
+	MapServerMapList mapHashes(locations);
 
 	masterServerConnection->clear();
 	masterServerConnection->put(&mapHashes.buffer);
@@ -232,35 +449,156 @@ bool MapServer::registerWithMasterServer(el::Logger * const logger) {
 bool MapServer::parseMaps(el::Logger * const logger) {
 	auto &mapPaths = serverDetails.maps.get();
 
-	for (const auto & mapPath : mapPaths) {
-		auto map = std::make_unique<Tmx::Map>();
+	if (!mapPaths.empty()) {
+		hashCache = std::make_unique<MapHashCache>(MapHashCache::defaultCacheFileFor(mapPaths.front()), logger);
+	}
+
+	ThreadPool loadingPool(ThreadPool::defaultThreadCount(PLAYPG_CORES_AVIAILABLE));
+	MapLoader loader(loadingPool);
 
-		map->ParseFile(mapPath);
+	auto loadedMaps = loader.loadMaps(mapPaths, logger, hashCache.get());
+
+	if (hashCache != nullptr) {
+		hashCache->save();
+	}
 
-		if (map->HasError()) {
-			logger->error("Couldn't parse %v: %v.", mapPath, map->GetErrorText());
+	for (auto &loadedMap : loadedMaps) {
+		if (loadedMap.map == nullptr) {
 			continue;
 		}
 
-		tmxparserMaps.emplace_back(std::move(map));
+		mapSlots.emplace_back(std::make_unique<MapSlot>(std::make_shared<const LoadedMap>(std::move(loadedMap)),
+		        hashCache.get()));
+
+		// A map which wakes up with a new version needs announcing just like one which was reloaded.
+		mapSlots.back()->setVersionListener([this](const MapSlot &slot, el::Logger * const listenerLogger) {
+			if (hashCache != nullptr) {
+				hashCache->save();
+			}
+
+			sendMapUpdate(Location(slot.getName(), slot.getPath(), slot.getHash(), slot.getVersion()), listenerLogger);
+		});
 	}
 
-	if (tmxparserMaps.size() < mapPaths.size()) {
+	if (mapSlots.size() < mapPaths.size()) {
 		// some maps failed to load
-		logger->error("Couldn't load %v maps.", (mapPaths.size() - tmxparserMaps.size()));
+		logger->error("Couldn't load %v maps.", (mapPaths.size() - mapSlots.size()));
 
-		if (tmxparserMaps.size() == 0) {
+		if (mapSlots.size() == 0) {
 			return false;
 		}
 	} else {
-		logger->verbose(5, "Parsed all tmxparser maps successfully.");
+		logger->verbose(5, "Parsed all maps successfully.");
 	}
 
-	for (const auto &map : tmxparserMaps) {
-		maps.emplace_back(Map(map.get()));
+	return true;
+}
+
+void MapServer::watchMaps(el::Logger * const logger) {
+	static constexpr const int WATCH_TIMEOUT_MS = 500;
+
+	std::vector<std::string> directories;
+
+	for (const auto &slot : mapSlots) {
+		auto directory = boost::filesystem::path(slot->getPath()).parent_path().string();
+
+		if (directory.empty()) {
+			directory = ".";
+		}
+
+		if (std::find(directories.begin(), directories.end(), directory) == directories.end()) {
+			directories.emplace_back(std::move(directory));
+		}
 	}
 
-	return true;
+	MapWatcher watcher(directories, logger);
+
+	if (!watcher.isWatching()) {
+		logger->warn("Not watching any map directories; maps won't be reloaded when they change.");
+		return;
+	}
+
+	while (!done) {
+		for (const auto &changedPath : watcher.waitForChanges(WATCH_TIMEOUT_MS)) {
+			reloadMap(changedPath, logger);
+		}
+	}
+}
+
+void MapServer::reloadMap(const std::string &changedPath, el::Logger * const logger) {
+	auto slot = findSlotForPath(changedPath);
+
+	if (slot == nullptr) {
+		logger->verbose(5, "Ignoring change to %v, which isn't a map this server runs.", changedPath);
+		return;
+	}
+
+	// nullptr if the map is hibernating, in which case the path graph is built from scratch.
+	const auto current = slot->acquire();
+	auto reloaded = MapLoader::loadMap(changedPath, logger, hashCache.get(), current.get());
+
+	if (reloaded.map == nullptr) {
+		logger->error("Couldn't reload %v: %v. Keeping the current version.", changedPath, reloaded.errorText);
+		return;
+	}
+
+	switch (slot->checkReload(reloaded, logger)) {
+	case MapSlot::ReloadCheck::REJECT: {
+		return;
+	}
+
+	case MapSlot::ReloadCheck::UNCHANGED: {
+		logger->verbose(5, "%v was written but hasn't changed; not reloading.", changedPath);
+		return;
+	}
+
+	case MapSlot::ReloadCheck::ACCEPT: {
+		break;
+	}
+	}
+
+	const auto newVersion = reloaded.map->getVersion();
+	const Location location(slot->getName(), reloaded.path, reloaded.hash, newVersion);
+	const auto loadTime = reloaded.loadTime;
+
+	const auto generation = slot->publish(std::make_shared<const LoadedMap>(std::move(reloaded)), logger);
+
+	logger->info("Reloaded \"%v\" (version %v) from %v in %vms; now on generation %v.", slot->getName(), newVersion,
+	        changedPath, loadTime.count() / 1000.0, generation);
+
+	if (hashCache != nullptr) {
+		hashCache->save();
+	}
+
+	sendMapUpdate(location, logger);
+}
+
+MapSlot *MapServer::findSlotForPath(const std::string &path) const {
+	// A map may be loaded from either its .tmx or .ppg file, so match on the path without an extension.
+	const auto changedStem = boost::filesystem::path(path).replace_extension().string();
+
+	for (const auto &slot : mapSlots) {
+		const auto slotStem = boost::filesystem::path(slot->getPath()).replace_extension().string();
+
+		if (slotStem == changedStem) {
+			return slot.get();
+		}
+	}
+
+	return nullptr;
+}
+
+void MapServer::sendMapUpdate(const Location &location, el::Logger * const logger) {
+	MapServerMapUpdate update( { location });
+
+	std::lock_guard<std::mutex> masterServerLock(masterServerMutex);
+
+	masterServerConnection->clear();
+	masterServerConnection->put(&update.buffer);
+
+	if (masterServerConnection->send() == 0) {
+		logger->error("Couldn't tell the master server about the new version of %v.", location.locationName);
+	}
 }
 
 }
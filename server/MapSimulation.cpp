@@ -0,0 +1,590 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "MapSimulation.hpp"
+#include "Map.hpp"
+#include "net/packets/GameplayPackets.hpp"
+#include "net/packets/SnapshotPackets.hpp"
+#include "util/Util.hpp"
+
+namespace PlayPG {
+
+constexpr const uint32_t SimulatedPlayer::SNAPSHOT_HISTORY;
+
+constexpr const uint32_t MapSimulation::DEFAULT_TICK_RATE;
+constexpr const uint32_t MapSimulation::MAX_MESSAGES_PER_PLAYER_PER_TICK;
+constexpr const int32_t MapSimulation::MAX_INTERACTION_RANGE;
+constexpr const uint32_t MapSimulation::INSTANCE_HISTORY_ENTITIES;
+
+MapSimulation::MapSimulation(MapSlot &slot, uint32_t tickRate, uint32_t instance) :
+		        slot_ { slot },
+		        instance_ { instance },
+		        name_ { instance == 0u ? slot.getName() : slot.getName() + "#" + std::to_string(instance) },
+		        tickRate_ { std::max(tickRate, 1u) },
+		        tickPeriod_ { std::chrono::microseconds { 1000000u / tickRate_ } },
+		        mapGeneration_ { slot.getGeneration() } {
+	// Instances wait, hibernating, until someone joins one.
+	if (instance_ != 0u || !slot_.addUser(el::Loggers::getLogger("ServPG"))) {
+		hibernating_.store(true, std::memory_order_release);
+		return;
+	}
+
+	map_ = slot_.acquire();
+	buildWorld();
+}
+
+void MapSimulation::addPlayer(std::unique_ptr<SimulatedPlayer> &&player) {
+	std::lock_guard<std::mutex> lock(joiningMutex_);
+	joining_.emplace_back(std::move(player));
+	hasJoining_.store(true, std::memory_order_release);
+}
+
+void MapSimulation::tick() {
+	const auto logger = el::Loggers::getLogger("ServPG");
+
+	if (isHibernating()) {
+		// An idle tick on a hibernating map has nothing to do.
+		if (!hasJoiningPlayers()) {
+			return;
+		}
+
+		if (!wake(logger)) {
+			rejectJoining(logger);
+			return;
+		}
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	const auto sinceLastTick = std::chrono::duration_cast<std::chrono::microseconds>(now - lastTickAt_);
+	lastTickAt_ = now;
+
+	// A late tick on an empty map means the scheduler let it sleep; the very first tick has nothing to catch up.
+	if (players_.empty() && tickCount_.load(std::memory_order_relaxed) > 0u && sinceLastTick > tickPeriod_ * 2) {
+		reconcile(sinceLastTick, logger);
+	}
+
+	const auto generation = slot_.getGeneration();
+
+	if (generation != mapGeneration_) {
+		mapGeneration_ = generation;
+		changeMap(slot_.acquire(), logger);
+	}
+
+	// Everyone "enters" the objects they're inside on a new map version; that's not news.
+	triggerEvents_.clear();
+
+	inputPhase(logger);
+	updatePhase(logger);
+	outputPhase(logger);
+
+	tickCount_.fetch_add(1u, std::memory_order_relaxed);
+	playerCount_.store(players_.size(), std::memory_order_relaxed);
+}
+
+void MapSimulation::inputPhase(el::Logger * const logger) {
+	{
+		std::lock_guard<std::mutex> lock(joiningMutex_);
+
+		for (auto &player : joining_) {
+			spawnPlayer(*player);
+			logger->verbose(5, "Player %v joined %v at (%v, %v).", player->guid, getName(), player->tile.x,
+			        player->tile.y);
+
+			playersByGUID_[player->guid] = player.get();
+			players_.emplace_back(std::move(player));
+		}
+
+		joining_.clear();
+		hasJoining_.store(false, std::memory_order_release);
+	}
+
+	for (auto &player : players_) {
+		if (player->session->isClosed()) {
+			player->disconnected = true;
+			continue;
+		}
+
+		readMessages(*player, logger);
+	}
+}
+
+void MapSimulation::updatePhase(el::Logger * const logger) {
+	moveStage();
+
+	for (auto &player : players_) {
+		if (player->disconnected) {
+			player->session->close();
+			entities_->remove(player->guid);
+			interest_->entityRemoved(player->guid, player->tile, interestEvents_);
+			interest_->removeSubscriber(player->guid);
+			triggers_->remove(player->guid, triggerEvents_);
+		}
+	}
+
+	for (const auto &event : triggerEvents_) {
+		logger->verbose(9, "Player %v %v object \"%v\" on %v.", event.entity,
+		        event.type == TriggerEvent::Type::ENTER ? "entered" : "left",
+		        map_->map->getObjects()[event.object].name, getName());
+	}
+
+	const auto sizeBefore = players_.size();
+
+	players_.erase(std::remove_if(players_.begin(), players_.end(), [](const std::unique_ptr<SimulatedPlayer> &player) {
+		return player->disconnected;
+	}), players_.end());
+
+	if (players_.size() != sizeBefore) {
+		logger->verbose(5, "%v players left %v.", sizeBefore - players_.size(), getName());
+
+		playersByGUID_.clear();
+
+		for (const auto &player : players_) {
+			playersByGUID_[player->guid] = player.get();
+		}
+	}
+
+	const auto serverTime = util::monotonicMicros();
+
+	recordHistory(serverTime, logger);
+	replicate(serverTime, logger);
+}
+
+void MapSimulation::outputPhase(el::Logger * const logger) {
+	for (auto &player : players_) {
+		for (auto &packet : player->outgoing) {
+			if (!player->session->send(std::move(packet))) {
+				logger->verbose(9, "Dropped a packet for player %v on %v; their outbound queue is full.", player->guid,
+				        getName());
+			}
+		}
+
+		player->outgoing.clear();
+
+		// Only notice now; the player leaves properly at the next update phase.
+		if (player->session->isClosed()) {
+			player->disconnected = true;
+		}
+	}
+}
+
+void MapSimulation::readMessages(SimulatedPlayer &player, el::Logger * const logger) {
+	InboundMessage message;
+
+	for (uint32_t i = 0u; i < MAX_MESSAGES_PER_PLAYER_PER_TICK && player.session->receive(message); ++i) {
+		switch (message.opcode) {
+		case util::to_integral(ClientOpcode::MOVE): {
+			const auto sequence = static_cast<uint32_t>(message.fields[0]);
+
+			// A move we've already dealt with, or one from before a correction arrived.
+			if (sequence <= player.lastMoveSequence
+			        || (!player.requestedMoves.empty() && sequence <= player.requestedMoves.back().sequence)) {
+				break;
+			}
+
+			if (player.requestedMoves.size() < movement_.getMaxMovesPerTick()) {
+				player.requestedMoves.emplace_back(RequestedMove { sequence, glm::ivec2 {
+				        static_cast<int16_t>(message.fields[1]), static_cast<int16_t>(message.fields[2]) } });
+			} else {
+				logger->verbose(9, "Player %v on %v is moving too often; ignoring a move.", player.guid, getName());
+				player.lastMoveSequence = sequence;
+				player.movesHandled = true;
+				player.needsCorrection = true;
+			}
+
+			break;
+		}
+
+		case util::to_integral(ClientOpcode::SNAPSHOT_ACK): {
+			const auto sequence = static_cast<uint32_t>(message.fields[0]);
+
+			// Acks arrive out of order and can't be for snapshots we haven't sent.
+			if (sequence > player.ackedSnapshot && sequence <= snapshotSequence_) {
+				player.ackedSnapshot = sequence;
+			}
+
+			break;
+		}
+
+		case util::to_integral(ClientOpcode::INTERACT): {
+			interact(player, message.fields[0], glm::ivec2 { static_cast<int16_t>(message.fields[1]),
+			        static_cast<int16_t>(message.fields[2]) }, logger);
+			break;
+		}
+
+		default: {
+			logger->verbose(8, "Unhandled opcode received from player %v: %v", player.guid, message.opcode);
+			break;
+		}
+		}
+	}
+}
+
+void MapSimulation::interact(SimulatedPlayer &player, uint64_t renderTime, const glm::ivec2 &target,
+        el::Logger * const logger) {
+	// Reach is judged from where the player is now, since their own position is never behind.
+	const auto reach = target - player.tile;
+
+	if (std::abs(reach.x) > MAX_INTERACTION_RANGE || std::abs(reach.y) > MAX_INTERACTION_RANGE) {
+		logger->verbose(9, "Player %v on %v tried to interact with (%v, %v), which is out of reach.", player.guid,
+		        getName(), target.x, target.y);
+		return;
+	}
+
+	RewoundTick rewound;
+
+	// Anything claimed further back than the history reaches is judged against the oldest tick we have.
+	if (!history_->rewind(renderTime, &rewound)) {
+		return;
+	}
+
+	rewound.forEachWithin(target, 0, [&](uint64_t guid, const glm::ivec2 &tile) {
+		if (guid != player.guid) {
+			logger->verbose(9, "Player %v on %v interacted with %v at (%v, %v) as of tick %v.", player.guid,
+			        getName(), guid, tile.x, tile.y, rewound.getTick());
+		}
+	});
+}
+
+void MapSimulation::hibernate() {
+	const auto logger = el::Loggers::getLogger("ServPG");
+
+	if (isHibernating() || !players_.empty()) {
+		return;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	// With nobody on the map every index is empty; only the map and the memory reserved for it remain.
+	interest_ = nullptr;
+	entities_ = nullptr;
+	triggers_ = nullptr;
+	history_ = nullptr;
+	terrain_.reset(nullptr);
+	map_ = nullptr;
+
+	snapshots_ = SnapshotRing<std::vector<EntityState>>(SimulatedPlayer::SNAPSHOT_HISTORY);
+	std::vector<InterestEvent>().swap(interestEvents_);
+	std::vector<TriggerEvent>().swap(triggerEvents_);
+	std::vector<EntityState>().swap(baselineStates_);
+	std::vector<EntityState>().swap(visibleStates_);
+	std::vector<std::unique_ptr<SimulatedPlayer>>().swap(players_);
+	std::unordered_map<uint64_t, SimulatedPlayer *>().swap(playersByGUID_);
+	delta_ = BitWriter();
+	moveBatch_ = MoveBatch();
+
+	// Frees the map itself once no other instance needs it, unless the map watcher is part way through reading it.
+	slot_.removeUser(logger);
+	hibernating_.store(true, std::memory_order_release);
+
+	const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()
+	        - start);
+	logger->info("%v hibernated in %vms.", getName(), duration.count() / 1000.0);
+}
+
+bool MapSimulation::wake(el::Logger * const logger) {
+	const auto start = std::chrono::steady_clock::now();
+
+	if (!slot_.addUser(logger)) {
+		return false;
+	}
+
+	// Read before acquiring, as in the constructor, so a publish in between is caught by the next tick.
+	mapGeneration_ = slot_.getGeneration();
+	map_ = slot_.acquire();
+	buildWorld();
+
+	hibernating_.store(false, std::memory_order_release);
+
+	const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()
+	        - start);
+	logger->info("%v woke from hibernation for a joining player in %vms.", getName(), duration.count() / 1000.0);
+
+	return true;
+}
+
+void MapSimulation::rejectJoining(el::Logger * const logger) {
+	std::lock_guard<std::mutex> lock(joiningMutex_);
+
+	for (auto &player : joining_) {
+		logger->warn("Turning away player %v; %v couldn't be loaded.", player->guid, getName());
+		player->session->close();
+	}
+
+	joining_.clear();
+	hasJoining_.store(false, std::memory_order_release);
+}
+
+void MapSimulation::buildWorld() {
+	snapshotFormat_ = SnapshotFormat::forMapSize(map_->map->getWidth(), map_->map->getHeight());
+	entities_ = std::make_unique<EntityGrid>(*map_->map);
+	interest_ = std::make_unique<InterestManager>(*entities_);
+	triggers_ = std::make_unique<TriggerTracker>(*map_->map);
+	history_ = std::make_unique<PositionHistory>(tickRate_, PositionHistory::DEFAULT_WINDOW,
+	        instance_ == 0u ? PositionHistory::DEFAULT_MAX_ENTITIES : INSTANCE_HISTORY_ENTITIES);
+
+	// Any tiles changed on the previous version are lost.
+	terrain_.reset(map_);
+}
+
+void MapSimulation::reconcile(std::chrono::microseconds sinceLastTick, el::Logger * const logger) {
+	// Tick numbers keep counting time even when no ticks ran, so they stay comparable across a sleep.
+	const auto missedTicks = static_cast<uint64_t>(sinceLastTick / tickPeriod_) - 1u;
+	tickCount_.fetch_add(missedTicks, std::memory_order_relaxed);
+
+	// Nobody can be judged against where players were before the map went quiet.
+	history_->clear();
+
+	logger->verbose(9, "%v woke after %vms; skipped %v ticks.", getName(), sinceLastTick.count() / 1000,
+	        missedTicks);
+}
+
+void MapSimulation::changeMap(std::shared_ptr<const LoadedMap> &&newMap, el::Logger * const logger) {
+	map_ = std::move(newMap);
+
+	// The grid's size might change, so everyone loses sight of everything and regains what's still in range.
+	for (const auto &player : players_) {
+		interest_->removeSubscriber(player->guid, &interestEvents_);
+	}
+
+	interest_ = nullptr;
+	buildWorld();
+
+	for (auto &player : players_) {
+		// The map might have shrunk, or had a wall built where the player was standing.
+		if (terrain_.isSolidAtTile(player->tile)) {
+			spawnPlayer(*player);
+
+			// Their client still thinks they're where they were.
+			player->needsCorrection = true;
+		} else {
+			entities_->insert(player->guid, player->tile);
+			interest_->entityAdded(player->guid, player->tile, interestEvents_);
+			interest_->updateSubscriber(player->guid, player->tile, interestEvents_);
+			updateTriggers(*player);
+		}
+	}
+
+	logger->info("%v is now running map version %v.", getName(), map_->map->getVersion());
+}
+
+void MapSimulation::moveStage() {
+	const auto &solid = terrain_.getSolidGrid();
+
+	// Round n holds everyone's nth move, since each move starts where the previous one finished.
+	for (uint32_t round = 0u; round < movement_.getMaxMovesPerTick(); ++round) {
+		moveBatch_.clear();
+
+		for (uint32_t i = 0u; i < players_.size(); ++i) {
+			const auto &player = *players_[i];
+
+			if (round < player.requestedMoves.size() && !player.disconnected) {
+				const auto &move = player.requestedMoves[round];
+				moveBatch_.add(i, player.tile, move.delta.x, move.delta.y);
+			}
+		}
+
+		if (moveBatch_.size() == 0u) {
+			break;
+		}
+
+		movement_.validate(solid, moveBatch_);
+
+		for (std::size_t i = 0u; i < moveBatch_.size(); ++i) {
+			auto &player = *players_[moveBatch_.movers[i]];
+
+			player.movesHandled = true;
+
+			if (moveBatch_.accepted[i]) {
+				player.lastMoveSequence = std::max(player.lastMoveSequence, player.requestedMoves[round].sequence);
+				movePlayer(player, glm::ivec2 { moveBatch_.toX[i], moveBatch_.toY[i] });
+			} else {
+				// Later moves were made from somewhere the player isn't, so they're dropped too.
+				player.lastMoveSequence = std::max(player.lastMoveSequence, player.requestedMoves.back().sequence);
+				player.requestedMoves.clear();
+				player.needsCorrection = true;
+			}
+		}
+	}
+
+	// One packet per player per tick, and only for players who moved.
+	for (auto &player : players_) {
+		player->requestedMoves.clear();
+
+		if (player->needsCorrection) {
+			player->outgoing.emplace_back(std::make_unique<MoveCorrectionPacket>(player->lastMoveSequence,
+			        player->tile));
+		} else if (player->movesHandled) {
+			player->outgoing.emplace_back(std::make_unique<MoveAckPacket>(player->lastMoveSequence));
+		}
+
+		player->needsCorrection = false;
+		player->movesHandled = false;
+	}
+}
+
+void MapSimulation::spawnPlayer(SimulatedPlayer &player) {
+	const auto &map = *map_->map;
+
+	glm::ivec2 spawn;
+
+	if (!map.findNearestSpawn(player.tile, &spawn)) {
+		spawn = map.getSpawnPoint();
+	}
+
+	if (entities_->contains(player.guid)) {
+		movePlayer(player, spawn);
+		return;
+	}
+
+	player.tile = spawn;
+
+	entities_->insert(player.guid, player.tile);
+	interest_->entityAdded(player.guid, player.tile, interestEvents_);
+	interest_->updateSubscriber(player.guid, player.tile, interestEvents_);
+
+	updateTriggers(player);
+}
+
+void MapSimulation::movePlayer(SimulatedPlayer &player, const glm::ivec2 &tile) {
+	const auto from = player.tile;
+
+	if (!entities_->move(player.guid, tile)) {
+		return;
+	}
+
+	player.tile = tile;
+
+	interest_->entityMoved(player.guid, from, tile, interestEvents_);
+	interest_->updateSubscriber(player.guid, tile, interestEvents_);
+
+	updateTriggers(player);
+}
+
+void MapSimulation::updateTriggers(SimulatedPlayer &player) {
+	const auto &map = *map_->map;
+
+	// Objects are in pixels; use the centre of the player's tile.
+	const glm::vec2 position { (player.tile.x + 0.5f) * map.getTileWidth(), (player.tile.y + 0.5f) * map.getTileHeight() };
+
+	triggers_->update(player.guid, position, triggerEvents_);
+}
+
+void MapSimulation::recordHistory(uint64_t serverTime, el::Logger * const logger) {
+	history_->beginTick(tickCount_.load(std::memory_order_relaxed), serverTime);
+
+	for (const auto &player : players_) {
+		if (!history_->record(player->guid, player->tile)) {
+			logger->verbose(5, "%v has more than %v players; some can't be lag compensated.", getName(),
+			        history_->getMaxEntities());
+			break;
+		}
+	}
+}
+
+void MapSimulation::replicate(uint64_t serverTime, el::Logger * const logger) {
+	for (const auto &event : interestEvents_) {
+		updateVisible(event);
+	}
+
+	interestEvents_.clear();
+
+	++snapshotSequence_;
+
+	auto &snapshot = snapshots_.record(snapshotSequence_);
+	snapshot.clear();
+
+	for (const auto &player : players_) {
+		snapshot.emplace_back(EntityState { player->guid, player->tile });
+	}
+
+	std::sort(snapshot.begin(), snapshot.end(), [](const EntityState &lhs, const EntityState &rhs) {
+		return lhs.guid < rhs.guid;
+	});
+
+	for (auto &player : players_) {
+		uint32_t baseline = 0u;
+		baselineStates_.clear();
+
+		const auto ackedStates = snapshots_.find(player->ackedSnapshot);
+		const auto ackedVisible = player->visibleHistory.find(player->ackedSnapshot);
+
+		// If the ack is too old to still be in the history, start again with everything.
+		if (ackedStates != nullptr && ackedVisible != nullptr) {
+			filterSnapshot(*ackedStates, *ackedVisible, baselineStates_);
+			baseline = player->ackedSnapshot;
+		}
+
+		filterSnapshot(snapshot, player->visible, visibleStates_);
+
+		delta_.clear();
+		encodeSnapshotDelta(baselineStates_, visibleStates_, snapshotFormat_, delta_);
+
+		player->visibleHistory.record(snapshotSequence_) = player->visible;
+
+		if (delta_.getBytes().size() > std::numeric_limits<uint16_t>::max()) {
+			logger->warn("Snapshot %v for player %v on %v is %v bytes; too big to send.", snapshotSequence_,
+			        player->guid, getName(), delta_.getBytes().size());
+			continue;
+		}
+
+		player->outgoing.emplace_back(std::make_unique<SnapshotPacket>(snapshotSequence_, baseline, serverTime,
+		        snapshotFormat_, delta_));
+	}
+}
+
+void MapSimulation::updateVisible(const InterestEvent &event) {
+	auto subscriber = findPlayer(event.subscriber);
+
+	// They might have left this tick.
+	if (subscriber == nullptr) {
+		return;
+	}
+
+	auto &visible = subscriber->visible;
+	const auto it = std::lower_bound(visible.begin(), visible.end(), event.entity);
+
+	if (event.type == InterestEvent::Type::ENTER) {
+		if (it == visible.end() || *it != event.entity) {
+			visible.insert(it, event.entity);
+		}
+	} else if (it != visible.end() && *it == event.entity) {
+		visible.erase(it);
+	}
+}
+
+SimulatedPlayer *MapSimulation::findPlayer(uint64_t guid) const {
+	const auto it = playersByGUID_.find(guid);
+	return it == playersByGUID_.end() ? nullptr : it->second;
+}
+
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <utility>
+
+#include <boost/filesystem.hpp>
+
+#include "MapSlot.hpp"
+#include "CompiledMap.hpp"
+
+namespace PlayPG {
+
+MapSlot::MapSlot(std::shared_ptr<const LoadedMap> &&initial, MapHashCache * const hashCache) :
+		        current_ { std::move(initial) },
+		        name_ { current_->map->getName() },
+		        hashCache_ { hashCache },
+		        path_ { current_->path },
+		        hash_ { current_->hash },
+		        version_ { current_->map->getVersion() } {
+}
+
+MapSlot::~MapSlot() {
+	if (!fallbackPath_.empty()) {
+		boost::system::error_code error;
+		boost::filesystem::remove(fallbackPath_, error);
+	}
+}
+
+std::shared_ptr<const LoadedMap> MapSlot::acquire() const {
+	return std::atomic_load_explicit(&current_, std::memory_order_acquire);
+}
+
+MapSlot::ReloadCheck MapSlot::checkReload(const LoadedMap &reloaded, el::Logger * const logger) const {
+	if (reloaded.map->getName() != name_) {
+		logger->error("Reloaded %v has been renamed from \"%v\" to \"%v\"; restart the server to rename maps.",
+		        reloaded.path, name_, reloaded.map->getName());
+		return ReloadCheck::REJECT;
+	}
+
+	std::string currentHash;
+	uint32_t currentVersion;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		currentHash = hash_;
+		currentVersion = version_;
+	}
+
+	if (reloaded.hash == currentHash) {
+		return ReloadCheck::UNCHANGED;
+	}
+
+	const auto newVersion = reloaded.map->getVersion();
+
+	if (newVersion < currentVersion) {
+		logger->error("Reloaded %v has version %v, older than the running version %v; keeping the current version.",
+		        reloaded.path, newVersion, currentVersion);
+		return ReloadCheck::REJECT;
+	} else if (newVersion == currentVersion) {
+		logger->warn("%v changed without a version change; the login server may reject it.", reloaded.path);
+	}
+
+	return ReloadCheck::ACCEPT;
+}
+
+uint64_t MapSlot::publish(std::shared_ptr<const LoadedMap> &&next, el::Logger * const logger) {
+	std::lock_guard<std::mutex> transition(transitionMutex_);
+
+	uint64_t generation;
+	std::shared_ptr<const LoadedMap> hibernatingVersion;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		path_ = next->path;
+		hash_ = next->hash;
+		version_ = next->map->getVersion();
+
+		if (isHibernating()) {
+			hibernatingVersion = std::move(next);
+		} else {
+			std::atomic_store_explicit(&current_, std::move(next), std::memory_order_release);
+		}
+
+		generation = generation_.fetch_add(1u, std::memory_order_acq_rel) + 1u;
+	}
+
+	// This version has passed the checks, so it's what to fall back to from now on.
+	if (hibernatingVersion != nullptr) {
+		saveFallback(*hibernatingVersion, logger);
+	}
+
+	return generation;
+}
+
+void MapSlot::removeUser(el::Logger * const logger) {
+	std::lock_guard<std::mutex> transition(transitionMutex_);
+	std::shared_ptr<const LoadedMap> last;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (users_ > 0u && --users_ > 0u) {
+			return;
+		}
+
+		last = std::atomic_load_explicit(&current_, std::memory_order_acquire);
+
+		hibernating_.store(true, std::memory_order_release);
+		std::atomic_store_explicit(&current_, std::shared_ptr<const LoadedMap>(), std::memory_order_release);
+	}
+
+	if (last != nullptr) {
+		saveFallback(*last, logger);
+	}
+}
+
+bool MapSlot::addUser(el::Logger * const logger) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (!isHibernating()) {
+			++users_;
+			return true;
+		}
+	}
+
+	std::unique_lock<std::mutex> transition(transitionMutex_);
+	std::string path;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		// Another simulation woke it while this one was waiting.
+		if (!isHibernating()) {
+			++users_;
+			return true;
+		}
+
+		path = path_;
+	}
+
+	// Loading can take a while, so only transitionMutex_ is held; getPath() and friends don't wait for it.
+	bool changed = false;
+	auto loaded = loadForWaking(path, &changed, logger);
+
+	if (loaded.map == nullptr) {
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		hash_ = loaded.hash;
+		version_ = loaded.map->getVersion();
+
+		std::atomic_store_explicit(&current_, std::make_shared<const LoadedMap>(std::move(loaded)),
+		        std::memory_order_release);
+		hibernating_.store(false, std::memory_order_release);
+		generation_.fetch_add(1u, std::memory_order_acq_rel);
+		++users_;
+	}
+
+	transition.unlock();
+
+	if (changed && versionListener_ != nullptr) {
+		versionListener_(*this, logger);
+	}
+
+	return true;
+}
+
+LoadedMap MapSlot::loadForWaking(const std::string &path, bool *changed, el::Logger * const logger) const {
+	auto loaded = MapLoader::loadMap(path, logger, hashCache_);
+
+	if (loaded.map == nullptr) {
+		logger->error("Couldn't load \"%v\" from %v to wake it: %v.", name_, path, loaded.errorText);
+	} else {
+		switch (checkReload(loaded, logger)) {
+		case ReloadCheck::UNCHANGED: {
+			return loaded;
+		}
+
+		case ReloadCheck::ACCEPT: {
+			logger->info("%v changed while \"%v\" was hibernating; waking with version %v.", path, name_,
+			        loaded.map->getVersion());
+			*changed = true;
+			return loaded;
+		}
+
+		case ReloadCheck::REJECT: {
+			break;
+		}
+		}
+	}
+
+	if (fallbackPath_.empty()) {
+		logger->error("No good version of \"%v\" to fall back to; it can't be woken.", name_);
+		return LoadedMap();
+	}
+
+	auto fallback = MapLoader::loadMap(fallbackPath_, logger);
+
+	if (fallback.map == nullptr) {
+		logger->error("Couldn't load the last good version of \"%v\" from %v: %v.", name_, fallbackPath_,
+		        fallback.errorText);
+		return LoadedMap();
+	}
+
+	logger->warn("Waking \"%v\" with the last good version (%v) instead of %v.", name_, fallback.map->getVersion(),
+	        path);
+
+	// Still watched, and reloaded, under its real path.
+	fallback.path = path;
+	return fallback;
+}
+
+void MapSlot::saveFallback(const LoadedMap &map, el::Logger * const logger) {
+	// Most hibernations are of the version that was last saved, so there's nothing to write.
+	if (!fallbackPath_.empty() && fallbackHash_ == map.hash) {
+		return;
+	}
+
+	if (fallbackPath_.empty()) {
+		boost::system::error_code error;
+		const auto directory = boost::filesystem::temp_directory_path(error);
+
+		if (error) {
+			logger->warn("Nowhere to keep a copy of \"%v\" while it hibernates: %v.", name_, error.message());
+			return;
+		}
+
+		fallbackPath_ = (directory / boost::filesystem::unique_path("playpg-%%%%-%%%%-%%%%-%%%%")).string()
+		        + CompiledMap::FILE_EXTENSION;
+	}
+
+	if (!CompiledMap::compile(*map.map, map.hash, fallbackPath_, logger)) {
+		logger->warn("Couldn't keep a copy of \"%v\" while it hibernates; it can't be woken if %v stops loading.",
+		        name_, map.path);
+
+		boost::system::error_code error;
+		boost::filesystem::remove(fallbackPath_, error);
+		fallbackPath_.clear();
+		fallbackHash_.clear();
+		return;
+	}
+
+	fallbackHash_ = map.hash;
+}
+
+std::string MapSlot::getPath() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return path_;
+}
+
+std::string MapSlot::getHash() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return hash_;
+}
+
+uint32_t MapSlot::getVersion() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return version_;
+}
+
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <chrono>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#else
+#include <boost/filesystem.hpp>
+#endif
+
+#include "MapWatcher.hpp"
+#include "CompiledMap.hpp"
+
+namespace PlayPG {
+
+namespace {
+
+// How long to keep collecting events after the first one, so that one save counts as one change.
+constexpr const int SETTLE_TIME_MS = 250;
+
+void addUnique(std::vector<std::string> &paths, const std::string &path) {
+	if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+		paths.emplace_back(path);
+	}
+}
+
+}
+
+bool MapWatcher::isMapFile(const std::string &fileName) {
+	static const std::string tmxExtension { ".tmx" };
+
+	return CompiledMap::hasCompiledExtension(fileName)
+	        || (fileName.size() >= tmxExtension.size()
+	                && fileName.compare(fileName.size() - tmxExtension.size(), tmxExtension.size(), tmxExtension) == 0);
+}
+
+#ifdef __linux__
+
+MapWatcher::MapWatcher(const std::vector<std::string> &directories, el::Logger * const logger) :
+		        logger_ { logger } {
+	inotifyFD_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if (inotifyFD_ == -1) {
+		logger_->error("Couldn't initialise inotify; maps won't be reloaded when they change.");
+		return;
+	}
+
+	for (const auto &directory : directories) {
+		const int wd = ::inotify_add_watch(inotifyFD_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+		if (wd == -1) {
+			logger_->error("Couldn't watch map directory %v.", directory);
+			continue;
+		}
+
+		watchedDirectories_.emplace(wd, directory);
+		logger_->info("Watching %v for map changes.", directory);
+	}
+
+	watching_ = !watchedDirectories_.empty();
+}
+
+MapWatcher::~MapWatcher() {
+	if (inotifyFD_ != -1) {
+		::close(inotifyFD_);
+	}
+}
+
+std::vector<std::string> MapWatcher::waitForChanges(int timeoutMS) {
+	auto changed = readEvents(timeoutMS);
+
+	if (!changed.empty()) {
+		const auto settleEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(SETTLE_TIME_MS);
+
+		while (std::chrono::steady_clock::now() < settleEnd) {
+			for (const auto &path : readEvents(SETTLE_TIME_MS / 5)) {
+				addUnique(changed, path);
+			}
+		}
+	}
+
+	return changed;
+}
+
+std::vector<std::string> MapWatcher::readEvents(int timeoutMS) {
+	std::vector<std::string> changed;
+
+	if (inotifyFD_ == -1) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMS));
+		return changed;
+	}
+
+	pollfd pfd { inotifyFD_, POLLIN, 0 };
+
+	if (::poll(&pfd, 1, timeoutMS) <= 0) {
+		return changed;
+	}
+
+	alignas(inotify_event) std::array<char, 4096> buffer;
+
+	while (true) {
+		const auto bytesRead = ::read(inotifyFD_, buffer.data(), buffer.size());
+
+		if (bytesRead <= 0) {
+			break;
+		}
+
+		for (ssize_t offset = 0; offset < bytesRead;) {
+			const auto event = reinterpret_cast<const inotify_event *>(buffer.data() + offset);
+			offset += sizeof(inotify_event) + event->len;
+
+			if (event->len == 0u) {
+				continue;
+			}
+
+			const std::string fileName { event->name };
+			const auto dirIt = watchedDirectories_.find(event->wd);
+
+			if (dirIt == watchedDirectories_.end() || !MapWatcher::isMapFile(fileName)) {
+				continue;
+			}
+
+			const auto &directory = dirIt->second;
+			const bool needsSeparator = !directory.empty() && directory.back() != '/';
+
+			addUnique(changed, directory + (needsSeparator ? "/" : "") + fileName);
+		}
+	}
+
+	return changed;
+}
+
+#else
+
+// PLATFORM SPECIFIC: no inotify, so fall back to polling modification times.
+MapWatcher::MapWatcher(const std::vector<std::string> &directories, el::Logger * const logger) :
+		        logger_ { logger },
+		        directories_ { directories } {
+	scanModificationTimes(nullptr);
+	watching_ = true;
+}
+
+MapWatcher::~MapWatcher() {
+}
+
+std::vector<std::string> MapWatcher::waitForChanges(int timeoutMS) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMS));
+
+	std::vector<std::string> changed;
+	scanModificationTimes(&changed);
+
+	return changed;
+}
+
+void MapWatcher::scanModificationTimes(std::vector<std::string> * changed) {
+	namespace fs = boost::filesystem;
+
+	for (const auto &directory : directories_) {
+		boost::system::error_code ec;
+
+		for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+			const auto path = it->path().string();
+
+			if (!MapWatcher::isMapFile(path)) {
+				continue;
+			}
+
+			const auto modificationTime = fs::last_write_time(it->path(), ec);
+
+			if (ec) {
+				continue;
+			}
+
+			const auto known = modificationTimes_.find(path);
+
+			if (known == modificationTimes_.end() || known->second != modificationTime) {
+				modificationTimes_[path] = modificationTime;
+
+				if (changed != nullptr) {
+					addUnique(*changed, path);
+				}
+			}
+		}
+	}
+}
+
+#endif
+
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "MovementValidator.hpp"
+
+namespace PlayPG {
+
+constexpr const int32_t MovementValidator::DEFAULT_MAX_STEP;
+constexpr const uint32_t MovementValidator::DEFAULT_MAX_MOVES_PER_TICK;
+
+void MoveBatch::clear() {
+	movers.clear();
+	fromX.clear();
+	fromY.clear();
+	dx.clear();
+	dy.clear();
+	toX.clear();
+	toY.clear();
+	accepted.clear();
+}
+
+void MoveBatch::add(uint32_t mover, const glm::ivec2 &from, int32_t dx_, int32_t dy_) {
+	movers.emplace_back(mover);
+	fromX.emplace_back(from.x);
+	fromY.emplace_back(from.y);
+	dx.emplace_back(dx_);
+	dy.emplace_back(dy_);
+}
+
+MovementValidator::MovementValidator(int32_t maxStep, uint32_t maxMovesPerTick) :
+		        maxStep_ { std::max(maxStep, 0) },
+		        maxMovesPerTick_ { maxMovesPerTick } {
+}
+
+std::size_t MovementValidator::validate(const BitGrid &solid, MoveBatch &batch) const {
+	const auto count = batch.size();
+
+	batch.toX.resize(count);
+	batch.toY.resize(count);
+	batch.accepted.resize(count);
+
+	const int32_t * const fromX = batch.fromX.data();
+	const int32_t * const fromY = batch.fromY.data();
+	const int32_t * const dx = batch.dx.data();
+	const int32_t * const dy = batch.dy.data();
+	int32_t * const toX = batch.toX.data();
+	int32_t * const toY = batch.toY.data();
+	uint8_t * const accepted = batch.accepted.data();
+
+	const int32_t maxStep = maxStep_;
+
+	// Kept as separate branch-free loops so the arithmetic vectorizes; only the grid lookup can't.
+	for (std::size_t i = 0u; i < count; ++i) {
+		toX[i] = fromX[i] + dx[i];
+		toY[i] = fromY[i] + dy[i];
+		accepted[i] = static_cast<uint8_t>((dx[i] >= -maxStep) & (dx[i] <= maxStep) & (dy[i] >= -maxStep)
+		        & (dy[i] <= maxStep));
+	}
+
+	// Negative coordinates wrap to huge unsigned ones, so getOr treats them as outside the map.
+	for (std::size_t i = 0u; i < count; ++i) {
+		const bool blocked = solid.getOr(static_cast<uint32_t>(toX[i]), static_cast<uint32_t>(toY[i]), true);
+		accepted[i] = static_cast<uint8_t>(accepted[i] & !blocked);
+	}
+
+	std::size_t acceptedCount = 0u;
+
+	for (std::size_t i = 0u; i < count; ++i) {
+		toX[i] = accepted[i] ? toX[i] : fromX[i];
+		toY[i] = accepted[i] ? toY[i] : fromY[i];
+		acceptedCount += accepted[i];
+	}
+
+	return acceptedCount;
+}
+
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "PositionHistory.hpp"
+
+namespace PlayPG {
+
+constexpr const std::chrono::microseconds PositionHistory::DEFAULT_WINDOW;
+constexpr const uint32_t PositionHistory::DEFAULT_MAX_ENTITIES;
+
+namespace {
+
+std::size_t ticksInWindow(uint32_t tickRate, std::chrono::microseconds window) {
+	const auto ticks = (static_cast<uint64_t>(std::max(tickRate, 1u)) * window.count() + 999999u) / 1000000u;
+
+	// One more so the whole window is covered between the oldest and newest tick.
+	return static_cast<std::size_t>(ticks) + 1u;
+}
+
+}
+
+bool RewoundTick::find(uint64_t guid, glm::ivec2 * const tile) const {
+	for (std::size_t i = 0u; i < count_; ++i) {
+		if (guids_[i] == guid) {
+			*tile = glm::ivec2 { x_[i], y_[i] };
+			return true;
+		}
+	}
+
+	return false;
+}
+
+PositionHistory::PositionHistory(uint32_t tickRate, std::chrono::microseconds window, uint32_t maxEntities) :
+		        tickCapacity_ { ticksInWindow(tickRate, window) },
+		        maxEntities_ { maxEntities },
+		        ticks_(tickCapacity_),
+		        serverTimes_(tickCapacity_),
+		        counts_(tickCapacity_),
+		        guids_(tickCapacity_ * maxEntities),
+		        x_(tickCapacity_ * maxEntities),
+		        y_(tickCapacity_ * maxEntities) {
+}
+
+void PositionHistory::beginTick(uint64_t tick, uint64_t serverTime) {
+	if (count_ == tickCapacity_) {
+		first_ = slotFor(1u);
+		--count_;
+	}
+
+	const auto slot = slotFor(count_);
+	ticks_[slot] = tick;
+	serverTimes_[slot] = serverTime;
+	counts_[slot] = 0u;
+
+	++count_;
+}
+
+bool PositionHistory::record(uint64_t guid, const glm::ivec2 &tile) {
+	if (count_ == 0u) {
+		return false;
+	}
+
+	const auto slot = slotFor(count_ - 1u);
+	auto &entityCount = counts_[slot];
+
+	if (entityCount == maxEntities_) {
+		return false;
+	}
+
+	const auto index = slot * maxEntities_ + entityCount;
+	guids_[index] = guid;
+	x_[index] = tile.x;
+	y_[index] = tile.y;
+
+	++entityCount;
+	return true;
+}
+
+bool PositionHistory::rewind(uint64_t serverTime, RewoundTick * const rewound) const {
+	if (count_ == 0u) {
+		return false;
+	}
+
+	// Binary search for the first tick after serverTime; the one before it is the answer.
+	std::size_t low = 0u;
+	std::size_t high = count_;
+
+	while (low < high) {
+		const auto middle = low + (high - low) / 2u;
+
+		if (serverTimes_[slotFor(middle)] <= serverTime) {
+			low = middle + 1u;
+		} else {
+			high = middle;
+		}
+	}
+
+	const auto slot = slotFor(low == 0u ? 0u : low - 1u);
+	const auto offset = slot * maxEntities_;
+
+	*rewound = RewoundTick(ticks_[slot], serverTimes_[slot], counts_[slot], &guids_[offset], &x_[offset],
+	        &y_[offset]);
+	return true;
+}
+
+void PositionHistory::clear() {
+	first_ = 0u;
+	count_ = 0u;
+}
+
+}
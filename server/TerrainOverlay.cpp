@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "TerrainOverlay.hpp"
+#include "Map.hpp"
+
+namespace PlayPG {
+
+TerrainOverlay::TerrainOverlay(std::shared_ptr<const LoadedMap> terrain) {
+	reset(std::move(terrain));
+}
+
+void TerrainOverlay::reset(std::shared_ptr<const LoadedMap> terrain) {
+	if (terrain == nullptr) {
+		solid_ = BitGrid();
+		return;
+	}
+
+	const auto &shared = terrain->map->getSolidGrid();
+
+	// The view keeps the whole map alive, not just the grid's words.
+	solid_ = BitGrid::view(shared.getWidth(), shared.getHeight(), shared.getWords(), std::move(terrain));
+}
+
+void TerrainOverlay::setSolidAtTile(const glm::ivec2 &tile, bool solid) {
+	if (tile.x < 0 || tile.y < 0 || static_cast<uint32_t>(tile.x) >= solid_.getWidth()
+	        || static_cast<uint32_t>(tile.y) >= solid_.getHeight()) {
+		return;
+	}
+
+	if (isShared()) {
+		BitGrid copy(solid_.getWidth(), solid_.getHeight());
+		std::copy(solid_.getWords(), solid_.getWords() + solid_.getWordCount(), copy.getMutableRow(0u));
+		solid_ = std::move(copy);
+	}
+
+	solid_.set(tile.x, tile.y, solid);
+}
+
+}
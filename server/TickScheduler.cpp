@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include "TickScheduler.hpp"
+
+namespace PlayPG {
+
+constexpr const uint32_t TickScheduler::MAX_CATCH_UP_TICKS;
+constexpr const std::chrono::seconds TickScheduler::REPORT_INTERVAL;
+constexpr const uint32_t TickScheduler::IDLE_RATE_DIVISOR;
+constexpr const std::chrono::seconds TickScheduler::EMPTY_GRACE_PERIOD;
+constexpr const std::chrono::seconds TickScheduler::DEFAULT_HIBERNATE_AFTER;
+
+namespace {
+
+bool isFinished(const std::future<void> &future) {
+	return !future.valid() || future.wait_for(std::chrono::seconds { 0 }) == std::future_status::ready;
+}
+
+const char *describeMode(TickScheduler::TickMode mode) {
+	switch (mode) {
+	case TickScheduler::TickMode::FULL: {
+		return "ticking at full rate";
+	}
+
+	case TickScheduler::TickMode::IDLE: {
+		return "idle";
+	}
+
+	default: {
+		return "suspended";
+	}
+	}
+}
+
+}
+
+TickScheduler::TickScheduler(ThreadPool &pool, std::chrono::seconds hibernateAfter) :
+		        pool_ { pool },
+		        hibernateAfter_ { hibernateAfter } {
+}
+
+void TickScheduler::add(MapSimulation &simulation) {
+	maps_.emplace_back(std::make_unique<ScheduledMap>(simulation));
+}
+
+void TickScheduler::run(const std::atomic<bool> &done, el::Logger * const logger) {
+	// Never sleep for longer than this, so that done is noticed promptly.
+	static constexpr const std::chrono::milliseconds MAX_SLEEP { 50 };
+
+	// How often to check whether a map which is late has finished its previous tick.
+	static constexpr const std::chrono::milliseconds LATE_POLL_INTERVAL { 1 };
+
+	const auto start = tick_clock::now();
+	auto nextReport = start + REPORT_INTERVAL;
+
+	for (auto &scheduled : maps_) {
+		scheduled->nextTick = start;
+		scheduled->lastOccupied = start;
+		// There can be a lot of instances, none of which are running yet.
+		if (scheduled->simulation.getInstance() == 0u) {
+			logger->info("Ticking %v every %vms.", scheduled->simulation.getName(),
+			        scheduled->simulation.getTickPeriod().count() / 1000.0);
+		}
+	}
+
+	while (!done) {
+		const auto now = tick_clock::now();
+		auto wakeAt = now + MAX_SLEEP;
+
+		for (auto &scheduled : maps_) {
+			const auto mode = chooseMode(*scheduled, now);
+
+			if (mode != scheduled->mode) {
+				logger->verbose(5, "%v is now %v.", scheduled->simulation.getName(), describeMode(mode));
+
+				// Someone's waiting to play; don't make them wait out an idle period, or count the time spent
+				// suspended as skipped ticks.
+				if (mode == TickMode::FULL) {
+					scheduled->nextTick =
+					        scheduled->mode == TickMode::SUSPENDED ? now : std::min(scheduled->nextTick, now);
+				}
+
+				if (mode == TickMode::SUSPENDED) {
+					scheduled->suspendedAt = now;
+				}
+
+				scheduled->mode = mode;
+			}
+
+			if (mode == TickMode::SUSPENDED) {
+				// Instances always hibernate, since that's how they go back to their pool.
+				const bool mayHibernate = hibernateAfter_.count() > 0 || scheduled->simulation.getInstance() != 0u;
+
+				if (mayHibernate && now - scheduled->suspendedAt >= hibernateAfter_
+				        && !scheduled->simulation.isHibernating() && isFinished(scheduled->running)) {
+					startHibernating(*scheduled);
+				}
+
+				continue;
+			}
+
+			auto period = scheduled->simulation.getTickPeriod();
+
+			if (mode == TickMode::IDLE) {
+				period *= IDLE_RATE_DIVISOR;
+			}
+
+			if (now >= scheduled->nextTick) {
+				if (!isFinished(scheduled->running)) {
+					// Still running the previous tick; don't pile up more work for this map.
+					if (!scheduled->waitingForTick) {
+						scheduled->waitingForTick = true;
+						++scheduled->lateTicks;
+					}
+
+					wakeAt = std::min(wakeAt, now + LATE_POLL_INTERVAL);
+					continue;
+				}
+
+				scheduled->waitingForTick = false;
+
+				const auto behind = static_cast<uint64_t>((now - scheduled->nextTick) / period);
+
+				if (behind > MAX_CATCH_UP_TICKS) {
+					scheduled->skippedTicks += behind;
+					scheduled->nextTick += behind * period;
+				}
+
+				startTick(*scheduled);
+				scheduled->nextTick += period;
+			}
+
+			wakeAt = std::min(wakeAt, scheduled->nextTick);
+		}
+
+		if (now >= nextReport) {
+			report(logger);
+			nextReport = now + REPORT_INTERVAL;
+		}
+
+		std::this_thread::sleep_until(wakeAt);
+	}
+
+	for (auto &scheduled : maps_) {
+		if (scheduled->running.valid()) {
+			scheduled->running.wait();
+		}
+	}
+}
+
+TickScheduler::TickMode TickScheduler::chooseMode(ScheduledMap &scheduled, tick_clock::time_point now) const {
+	const auto &simulation = scheduled.simulation;
+
+	if (simulation.getPlayerCount() > 0u || simulation.hasJoiningPlayers()) {
+		scheduled.lastOccupied = now;
+		return TickMode::FULL;
+	}
+
+	return now - scheduled.lastOccupied < EMPTY_GRACE_PERIOD ? TickMode::IDLE : TickMode::SUSPENDED;
+}
+
+void TickScheduler::startTick(ScheduledMap &scheduled) {
+	ScheduledMap * const scheduledPtr = &scheduled;
+
+	scheduled.running = pool_.submit([scheduledPtr]() {
+		const auto tickStart = tick_clock::now();
+
+		scheduledPtr->simulation.tick();
+
+		const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(tick_clock::now() - tickStart);
+
+		std::lock_guard<std::mutex> lock(scheduledPtr->statsMutex);
+		scheduledPtr->tickDurations.record(duration);
+
+		if (duration > scheduledPtr->simulation.getTickPeriod()) {
+			++scheduledPtr->overruns;
+		}
+	});
+}
+
+void TickScheduler::startHibernating(ScheduledMap &scheduled) {
+	MapSimulation * const simulation = &scheduled.simulation;
+
+	// Runs on the pool like a tick, so that it can't overlap one.
+	scheduled.running = pool_.submit([simulation]() {
+		simulation->hibernate();
+	});
+}
+
+void TickScheduler::report(el::Logger * const logger) {
+	std::size_t idleMaps = 0u;
+	std::size_t suspendedMaps = 0u;
+	std::size_t hibernatingMaps = 0u;
+
+	for (auto &scheduled : maps_) {
+		DurationHistogram durations;
+		uint64_t overruns;
+
+		{
+			std::lock_guard<std::mutex> lock(scheduled->statsMutex);
+			durations = scheduled->tickDurations;
+			overruns = scheduled->overruns;
+
+			scheduled->tickDurations.reset();
+			scheduled->overruns = 0u;
+		}
+
+		const auto &simulation = scheduled->simulation;
+
+		if (scheduled->mode == TickMode::IDLE) {
+			++idleMaps;
+		} else if (scheduled->mode == TickMode::SUSPENDED) {
+			++suspendedMaps;
+
+			if (simulation.isHibernating()) {
+				++hibernatingMaps;
+			}
+
+			// Nothing to say about a map which hasn't ticked.
+			if (durations.getCount() == 0u) {
+				continue;
+			}
+		}
+
+		logger->verbose(1, "%v: %v players, %v ticks, p50 %vus, p99 %vus, max %vus.", simulation.getName(),
+		        simulation.getPlayerCount(), durations.getCount(), durations.percentile(50.0).count(),
+		        durations.percentile(99.0).count(), durations.getMax().count());
+
+		if (overruns > 0u || scheduled->skippedTicks > 0u) {
+			logger->warn("%v: %v of %v ticks overran the %vus tick period (%v late starts, %v ticks skipped).",
+			        simulation.getName(), overruns, durations.getCount(), simulation.getTickPeriod().count(),
+			        scheduled->lateTicks, scheduled->skippedTicks);
+		}
+
+		scheduled->skippedTicks = 0u;
+		scheduled->lateTicks = 0u;
+	}
+
+	logger->verbose(1, "%v of %v maps idle, %v suspended (%v of them hibernating).", idleMaps, maps_.size(),
+	        suspendedMaps, hibernatingMaps);
+}
+
+}
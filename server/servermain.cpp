@@ -29,6 +29,7 @@
 #include <cmath>
 #include <ctime>
 
+#include <chrono>
 #include <memory>
 #include <iostream>
 #include <string>
@@ -45,6 +46,10 @@ INITIALIZE_EASYLOGGINGPP
 #include "ServerCommon.hpp"
 #include "LoginServer.hpp"
 #include "MapServer.hpp"
+#include "Map.hpp"
+#include "MapHeader.hpp"
+#include "MapHashCache.hpp"
+#include "CompiledMap.hpp"
 #include "net/Packet.hpp"
 
 #include "PlayPGVersion.hpp"
@@ -61,6 +66,7 @@ std::unique_ptr<PlayPG::LoginServer> startLoginServer(el::Logger * logger, const
 std::unique_ptr<PlayPG::MapServer> startWorldServer(el::Logger * logger, const po::variables_map& vm);
 
 std::vector<std::string> loadMaps(el::Logger * logger, const po::variables_map &vm);
+void compileMaps(el::Logger * logger, const po::variables_map &vm);
 
 void initSockets();
 void shutdownSockets();
@@ -109,7 +115,9 @@ std::unique_ptr<PlayPG::Server> initializeProgramOptions(int argc, char *argv[])
 	("regenerate-keys",
 	        "Instructs the server to regenerate any keys it creates. WARNING: This may overwrite any key files the server uses.") //
 	("map-dir", po::value<std::string>()->default_value("./maps/"),
-	        "A directory in which to search for maps. Defaults to \"./maps\"");
+	        "A directory in which to search for maps. Defaults to \"./maps\"") //
+	("compile-maps",
+	        "Compile every .tmx map in --map-dir into a .ppg map alongside it and then exit. Compiled maps load much faster.");
 
 	po::options_description databaseOptions("Database Options");
 
@@ -128,7 +136,18 @@ std::unique_ptr<PlayPG::Server> initializeProgramOptions(int argc, char *argv[])
 	("master-public", po::value<std::string>()->default_value("login.pub"),
 	        "The public key file for the master login server. Required to authenticate.") //
 	("master-private", po::value<std::string>()->default_value("login.prv"),
-	        "The private key file for the master login server. Required to authenticate.");
+	        "The private key file for the master login server. Required to authenticate.") //
+	("no-map-reload", "Don't reload maps when their files in --map-dir change.") //
+	("tick-rate", po::value<uint32_t>()->default_value(PlayPG::MapSimulation::DEFAULT_TICK_RATE),
+	        "How many times per second each map is simulated.") //
+	("hibernate-after",
+	        po::value<uint32_t>()->default_value(
+	                static_cast<uint32_t>(PlayPG::TickScheduler::DEFAULT_HIBERNATE_AFTER.count())),
+	        "How many seconds a map must be empty and suspended before its memory is freed, or 0 to keep every map loaded.") //
+	("instanced-map", po::value<std::vector<std::string>>()->composing(),
+	        "The name of a map which also runs private instances, e.g. a dungeon per party. Can be given more than once.") //
+	("instance-pool-size", po::value<uint32_t>()->default_value(PlayPG::InstancePool::DEFAULT_SIZE),
+	        "How many instances of each instanced map can run at once.");
 
 	po::options_description allOptions("Allowed Options");
 
@@ -155,6 +174,11 @@ std::unique_ptr<PlayPG::Server> initializeProgramOptions(int argc, char *argv[])
 		return nullptr;
 	}
 
+	if (vm.count("compile-maps")) {
+		compileMaps(logger, vm);
+		return nullptr;
+	}
+
 	std::unique_ptr<PlayPG::Server> ret;
 
 	if (vm.count("login-server") && vm.count("world-server")) {
@@ -269,8 +293,22 @@ std::unique_ptr<PlayPG::MapServer> startWorldServer(el::Logger * logger, const p
 	        std::move(mapNames));
 	PlayPG::DatabaseDetails dbDetails(dbServer, dbPort, dbUsername, dbPassword);
 
+	const bool reloadChangedMaps = !vm.count("no-map-reload");
+	const auto tickRate = vm["tick-rate"].as<uint32_t>();
+
+	if (tickRate == 0u || tickRate > 1000u) {
+		logger->error("--tick-rate must be between 1 and 1000, got %v.", tickRate);
+		return nullptr;
+	}
+
+	const auto hibernateAfter = std::chrono::seconds(vm["hibernate-after"].as<uint32_t>());
+
+	auto instancedMaps =
+	        vm.count("instanced-map") ? vm["instanced-map"].as<std::vector<std::string>>() : std::vector<std::string>();
+	const auto instancePoolSize = vm["instance-pool-size"].as<uint32_t>();
+
 	return std::make_unique<PlayPG::MapServer>(serverDetails, dbDetails, masterHostname, masterPort, publicKeyFile,
-	        privateKeyFile);
+	        privateKeyFile, reloadChangedMaps, tickRate, hibernateAfter, std::move(instancedMaps), instancePoolSize);
 }
 
 std::vector<std::string> loadMaps(el::Logger * logger, const po::variables_map &vm) {
@@ -294,11 +332,29 @@ std::vector<std::string> loadMaps(el::Logger * logger, const po::variables_map &
 		const auto fileName = it->path().leaf();
 		const auto extension = fileName.extension();
 
-		if (extension != ".tmx" && extension != ".ppg") {
+		if (extension != ".tmx" && extension != PlayPG::CompiledMap::FILE_EXTENSION) {
 			logger->verbose(1, "Skipping %v because it has an irrelevant extension.", fileName);
 			continue;
 		}
 
+		// Where a map exists in both forms, use whichever is newer; normally the compiled version.
+		if (extension == ".tmx") {
+			const auto compiledPath = fs::path(it->path()).replace_extension(PlayPG::CompiledMap::FILE_EXTENSION);
+
+			if (fs::exists(compiledPath) && fs::last_write_time(compiledPath) >= fs::last_write_time(it->path())) {
+				logger->verbose(1, "Skipping %v in favour of compiled map %v.", fileName, compiledPath.leaf());
+				continue;
+			}
+		} else {
+			const auto sourcePath = fs::path(it->path()).replace_extension(".tmx");
+
+			if (fs::exists(sourcePath) && fs::last_write_time(sourcePath) > fs::last_write_time(it->path())) {
+				logger->warn("Compiled map %v is older than %v; using the TMX map. Run with --compile-maps to update it.",
+				        fileName, sourcePath.leaf());
+				continue;
+			}
+		}
+
 		mapNames.emplace_back(it->path().string());
 	}
 
@@ -311,6 +367,52 @@ std::vector<std::string> loadMaps(el::Logger * logger, const po::variables_map &
 	return mapNames;
 }
 
+void compileMaps(el::Logger * logger, const po::variables_map &vm) {
+	const fs::path mapDir = vm["map-dir"].as<std::string>();
+
+	if (!fs::is_directory(mapDir)) {
+		logger->error("Map directory %v doesn't exist or is not a directory.", mapDir.c_str());
+		return;
+	}
+
+	uint32_t compiledCount = 0u;
+	uint32_t failedCount = 0u;
+
+	PlayPG::MapHashCache hashCache((mapDir / PlayPG::MapHashCache::DEFAULT_FILE_NAME).string(), logger);
+
+	fs::directory_iterator endIter;
+
+	for (fs::directory_iterator it(mapDir); it != endIter; ++it) {
+		if (it->path().extension() != ".tmx") {
+			continue;
+		}
+
+		const auto sourcePath = it->path().string();
+
+		Tmx::Map tmxMap;
+		tmxMap.ParseFile(sourcePath);
+
+		if (tmxMap.HasError()) {
+			logger->error("Couldn't parse %v: %v.", sourcePath, tmxMap.GetErrorText());
+			++failedCount;
+			continue;
+		}
+
+		const PlayPG::Map map(&tmxMap);
+		const auto outputPath = fs::path(it->path()).replace_extension(PlayPG::CompiledMap::FILE_EXTENSION).string();
+
+		if (PlayPG::CompiledMap::compile(map, PlayPG::MapHeader::hashFile(sourcePath, &hashCache), outputPath, logger)) {
+			++compiledCount;
+		} else {
+			++failedCount;
+		}
+	}
+
+	hashCache.save();
+
+	logger->info("Compiled %v maps, %v failed.", compiledCount, failedCount);
+}
+
 void initSockets() {
 #ifndef APG_NO_SDL
 	APG::SDLGame::initialiseSDL();
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include <fstream>
+#include <vector>
+#include <utility>
+
+#include <APG/core/APGeasylogging.hpp>
+
+#include "CompiledMap.hpp"
+#include "Map.hpp"
+#include "util/BitGrid.hpp"
+
+namespace PlayPG {
+
+constexpr const char * const CompiledMap::FILE_EXTENSION;
+constexpr const uint32_t CompiledMap::FORMAT_VERSION;
+constexpr const uint32_t CompiledMap::ENDIAN_CHECK;
+
+namespace {
+
+constexpr const char MAGIC[4] = { 'P', 'P', 'G', 'M' };
+constexpr const std::size_t SECTION_ALIGNMENT = 8u;
+
+/**
+ * Appends the given bytes to the output, after padding so that they start on a section boundary.
+ * Returns the offset at which the bytes were placed.
+ */
+uint64_t appendSection(std::vector<uint8_t> &out, const void * const bytes, std::size_t length) {
+	while (out.size() % SECTION_ALIGNMENT != 0u) {
+		out.push_back(0u);
+	}
+
+	const uint64_t offset = out.size();
+	const auto byteData = static_cast<const uint8_t *>(bytes);
+
+	out.insert(out.end(), byteData, byteData + length);
+
+	return offset;
+}
+
+bool sectionFits(uint64_t offset, uint64_t length, std::size_t fileSize) {
+	return offset % SECTION_ALIGNMENT == 0u && offset <= fileSize && length <= fileSize - offset;
+}
+
+bool headerIsCompatible(const CompiledMapHeader &header, const std::string &fileName, el::Logger * const logger) {
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+		logger->error("%v is not a compiled map.", fileName);
+		return false;
+	}
+
+	if (header.endianCheck != CompiledMap::ENDIAN_CHECK) {
+		logger->error("%v was compiled on a machine with a different byte order; recompile it.", fileName);
+		return false;
+	}
+
+	if (header.formatVersion != CompiledMap::FORMAT_VERSION) {
+		logger->error("%v has compiled map format version %v but version %v is required; recompile it.", fileName,
+		        header.formatVersion, CompiledMap::FORMAT_VERSION);
+		return false;
+	}
+
+	return true;
+}
+
+}
+
+CompiledMap::CompiledMap(std::shared_ptr<const MappedFile> &&file) :
+		        file_ { std::move(file) },
+		        header_ { reinterpret_cast<const CompiledMapHeader *>(file_->data()) } {
+}
+
+bool CompiledMap::hasCompiledExtension(const std::string &fileName) {
+	const std::string extension { FILE_EXTENSION };
+
+	return fileName.size() >= extension.size()
+	        && fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+bool CompiledMap::compile(const Map &map, const std::string &sourceHash, const std::string &outputFile,
+        el::Logger * const logger) {
+	const uint32_t width = map.getWidth();
+	const uint32_t height = map.getHeight();
+	const uint32_t wordsPerRow = BitGrid::wordsPerRowFor(width);
+
+	// The compiled grid uses exactly the same layout as a BitGrid, so it can be copied as-is.
+	const auto &solidGrid = map.getSolidGrid();
+	const std::vector<uint64_t> solidWords(solidGrid.getWords(), solidGrid.getWords() + solidGrid.getWordCount());
+
+	std::vector<uint32_t> interestingTiles;
+	std::vector<uint32_t> spawnTiles;
+
+	map.getInterestingGrid().forEachSet([&](uint32_t x, uint32_t y) {
+		interestingTiles.emplace_back(x + y * width);
+	});
+
+	map.getSpawnGrid().forEachSet([&](uint32_t x, uint32_t y) {
+		spawnTiles.emplace_back(x + y * width);
+	});
+
+	std::vector<CompiledMapObject> objects;
+	std::string stringTable;
+
+	for (const auto &object : map.getObjects()) {
+		objects.push_back(CompiledMapObject { object.position.x, object.position.y, object.size.x, object.size.y,
+		        static_cast<uint32_t>(stringTable.size()), static_cast<uint32_t>(object.name.size()) });
+
+		stringTable += object.name;
+	}
+
+	CompiledMapHeader header;
+	std::memset(&header, 0, sizeof(header));
+
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.endianCheck = ENDIAN_CHECK;
+	header.formatVersion = FORMAT_VERSION;
+	header.mapVersion = map.getVersion();
+
+	header.width = width;
+	header.height = height;
+	header.tileWidth = map.getTileWidth();
+	header.tileHeight = map.getTileHeight();
+	header.wordsPerRow = wordsPerRow;
+
+	header.interestingCount = interestingTiles.size();
+	header.spawnCount = spawnTiles.size();
+	header.objectCount = objects.size();
+
+	header.nameLength = map.getName().size();
+	header.sourceHashLength = sourceHash.size();
+	header.stringTableLength = stringTable.size();
+
+	std::vector<uint8_t> out(sizeof(CompiledMapHeader), 0u);
+
+	header.nameOffset = appendSection(out, map.getName().data(), map.getName().size());
+	header.sourceHashOffset = appendSection(out, sourceHash.data(), sourceHash.size());
+	header.solidOffset = appendSection(out, solidWords.data(), solidWords.size() * sizeof(uint64_t));
+	header.interestingOffset = appendSection(out, interestingTiles.data(),
+	        interestingTiles.size() * sizeof(uint32_t));
+	header.spawnOffset = appendSection(out, spawnTiles.data(), spawnTiles.size() * sizeof(uint32_t));
+	header.objectOffset = appendSection(out, objects.data(), objects.size() * sizeof(CompiledMapObject));
+	header.stringTableOffset = appendSection(out, stringTable.data(), stringTable.size());
+
+	std::memcpy(out.data(), &header, sizeof(header));
+
+	// Write to a temporary file and rename so that anything loading the map never sees a partial file.
+	const auto tempFile = outputFile + ".tmp";
+
+	{
+		std::ofstream file(tempFile, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!file) {
+			logger->error("Couldn't open %v for writing.", tempFile);
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char *>(out.data()), out.size());
+
+		if (!file) {
+			logger->error("Couldn't write compiled map to %v.", tempFile);
+			return false;
+		}
+	}
+
+	if (std::rename(tempFile.c_str(), outputFile.c_str()) != 0) {
+		logger->error("Couldn't move compiled map into place at %v.", outputFile);
+		std::remove(tempFile.c_str());
+		return false;
+	}
+
+	logger->info("Compiled \"%v\" to %v (%v bytes).", map.getName(), outputFile, out.size());
+
+	return true;
+}
+
+std::unique_ptr<CompiledMap> CompiledMap::fromFile(const std::string &fileName, el::Logger * const logger) {
+	std::shared_ptr<const MappedFile> file = MappedFile::fromFile(fileName);
+
+	if (file == nullptr) {
+		logger->error("Couldn't map compiled map file %v.", fileName);
+		return nullptr;
+	}
+
+	if (!CompiledMap::validate(*file, logger)) {
+		return nullptr;
+	}
+
+	return std::unique_ptr<CompiledMap>(new CompiledMap(std::move(file)));
+}
+
+bool CompiledMap::validate(const MappedFile &file, el::Logger * const logger) {
+	const auto &fileName = file.getFileName();
+
+	if (file.size() < sizeof(CompiledMapHeader)) {
+		logger->error("%v is too small to be a compiled map.", fileName);
+		return false;
+	}
+
+	const auto &header = *reinterpret_cast<const CompiledMapHeader *>(file.data());
+
+	if (!headerIsCompatible(header, fileName, logger)) {
+		return false;
+	}
+
+	const uint64_t area = static_cast<uint64_t>(header.width) * header.height;
+
+	if (area == 0u || header.tileWidth == 0u || header.tileHeight == 0u) {
+		logger->error("%v has no tiles.", fileName);
+		return false;
+	}
+
+	if (header.wordsPerRow != BitGrid::wordsPerRowFor(header.width)) {
+		logger->error("%v has an invalid collision grid row size.", fileName);
+		return false;
+	}
+
+	const bool sectionsFit = sectionFits(header.nameOffset, header.nameLength, file.size())
+	        && sectionFits(header.sourceHashOffset, header.sourceHashLength, file.size())
+	        && sectionFits(header.solidOffset, uint64_t { header.wordsPerRow } * header.height * sizeof(uint64_t),
+	                file.size())
+	        && sectionFits(header.interestingOffset, uint64_t { header.interestingCount } * sizeof(uint32_t),
+	                file.size())
+	        && sectionFits(header.spawnOffset, uint64_t { header.spawnCount } * sizeof(uint32_t), file.size())
+	        && sectionFits(header.objectOffset, uint64_t { header.objectCount } * sizeof(CompiledMapObject),
+	                file.size()) && sectionFits(header.stringTableOffset, header.stringTableLength, file.size());
+
+	if (!sectionsFit) {
+		logger->error("%v is truncated or corrupt.", fileName);
+		return false;
+	}
+
+	const auto interesting = reinterpret_cast<const uint32_t *>(file.data() + header.interestingOffset);
+	const auto spawns = reinterpret_cast<const uint32_t *>(file.data() + header.spawnOffset);
+
+	for (uint32_t i = 0; i < header.interestingCount; ++i) {
+		if (interesting[i] >= area) {
+			logger->error("%v has an interesting tile outside of the map.", fileName);
+			return false;
+		}
+	}
+
+	for (uint32_t i = 0; i < header.spawnCount; ++i) {
+		if (spawns[i] >= area) {
+			logger->error("%v has a spawn tile outside of the map.", fileName);
+			return false;
+		}
+	}
+
+	const auto objects = reinterpret_cast<const CompiledMapObject *>(file.data() + header.objectOffset);
+
+	for (uint32_t i = 0; i < header.objectCount; ++i) {
+		if (uint64_t { objects[i].nameOffset } + objects[i].nameLength > header.stringTableLength) {
+			logger->error("%v has an object with an invalid name.", fileName);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+MapHeader CompiledMap::readHeader(const std::string &fileName, el::Logger * const logger) {
+	MapHeader ret;
+	ret.fileName = fileName;
+
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+
+	if (!file) {
+		ret.errorText = "couldn't open file";
+		return ret;
+	}
+
+	CompiledMapHeader header;
+	file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+	if (file.gcount() != sizeof(header)) {
+		ret.errorText = "file is too small to be a compiled map";
+		return ret;
+	}
+
+	if (!headerIsCompatible(header, fileName, logger)) {
+		ret.errorText = "incompatible compiled map";
+		return ret;
+	}
+
+	// The lengths come from the file, so check them before allocating anything from them.
+	file.seekg(0, std::ios::end);
+	const auto fileSize = static_cast<std::size_t>(file.tellg());
+
+	if (!sectionFits(header.nameOffset, header.nameLength, fileSize)
+	        || !sectionFits(header.sourceHashOffset, header.sourceHashLength, fileSize)) {
+		ret.errorText = "compiled map is truncated or corrupt";
+		return ret;
+	}
+
+	std::string name(header.nameLength, '\0');
+	std::string sourceHash(header.sourceHashLength, '\0');
+
+	file.seekg(header.nameOffset);
+	file.read(&name[0], name.size());
+
+	file.seekg(header.sourceHashOffset);
+	file.read(&sourceHash[0], sourceHash.size());
+
+	if (!file) {
+		ret.errorText = "compiled map is truncated";
+		return ret;
+	}
+
+	ret.name = std::move(name);
+	ret.version = header.mapVersion;
+	ret.width = header.width;
+	ret.height = header.height;
+	ret.tileWidth = header.tileWidth;
+	ret.tileHeight = header.tileHeight;
+	ret.hash = std::move(sourceHash);
+	ret.valid = true;
+
+	return ret;
+}
+
+std::string CompiledMap::getName() const {
+	return std::string(sectionAt<char>(header_->nameOffset), header_->nameLength);
+}
+
+std::string CompiledMap::getSourceHash() const {
+	return std::string(sectionAt<char>(header_->sourceHashOffset), header_->sourceHashLength);
+}
+
+std::string CompiledMap::getObjectName(const CompiledMapObject &object) const {
+	return std::string(sectionAt<char>(header_->stringTableOffset + object.nameOffset), object.nameLength);
+}
+
+}
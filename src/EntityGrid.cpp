@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "EntityGrid.hpp"
+#include "Map.hpp"
+
+namespace PlayPG {
+
+constexpr const int32_t EntityGrid::DEFAULT_CELL_SIZE;
+
+EntityGrid::EntityGrid(const Map &map, int32_t cellSize) :
+		        EntityGrid(map.getWidth(), map.getHeight(), cellSize) {
+}
+
+EntityGrid::EntityGrid(int32_t widthInTiles, int32_t heightInTiles, int32_t cellSize) :
+		        widthInTiles_ { std::max(widthInTiles, 0) },
+		        heightInTiles_ { std::max(heightInTiles, 0) },
+		        cellSize_ { std::max(cellSize, 1) },
+		        cellsWide_ { std::max((widthInTiles_ + cellSize_ - 1) / cellSize_, 1) },
+		        cellsHigh_ { std::max((heightInTiles_ + cellSize_ - 1) / cellSize_, 1) },
+		        cells_(static_cast<std::size_t>(cellsWide_) * cellsHigh_) {
+}
+
+bool EntityGrid::insert(id_type id, const glm::ivec2 &tile) {
+	if (!isInside(tile)) {
+		return false;
+	}
+
+	const auto inserted = entries_.emplace(id, Entry { 0u, 0u });
+
+	if (!inserted.second) {
+		return false;
+	}
+
+	addToCell(id, tile, inserted.first->second);
+	return true;
+}
+
+bool EntityGrid::move(id_type id, const glm::ivec2 &tile) {
+	if (!isInside(tile)) {
+		return false;
+	}
+
+	const auto it = entries_.find(id);
+
+	if (it == entries_.end()) {
+		return false;
+	}
+
+	auto &entry = it->second;
+	const auto newCell = cellIndexFor(tile);
+
+	if (newCell == entry.cell) {
+		// By far the most common case: a step within the same cell.
+		cells_[entry.cell].tiles[entry.slot] = tile;
+	} else {
+		removeFromCell(entry);
+		addToCell(id, tile, entry);
+	}
+
+	return true;
+}
+
+bool EntityGrid::remove(id_type id) {
+	const auto it = entries_.find(id);
+
+	if (it == entries_.end()) {
+		return false;
+	}
+
+	removeFromCell(it->second);
+	entries_.erase(it);
+
+	return true;
+}
+
+void EntityGrid::clear() {
+	for (auto &cell : cells_) {
+		cell.ids.clear();
+		cell.tiles.clear();
+	}
+
+	entries_.clear();
+}
+
+bool EntityGrid::getPosition(id_type id, glm::ivec2 * tile) const {
+	const auto it = entries_.find(id);
+
+	if (it == entries_.end()) {
+		return false;
+	}
+
+	*tile = cells_[it->second.cell].tiles[it->second.slot];
+	return true;
+}
+
+EntityGrid::IdSpan EntityGrid::queryRect(int32_t x, int32_t y, int32_t w, int32_t h,
+        std::vector<id_type> &out) const {
+	out.clear();
+
+	forEachInRect(x, y, w, h, [&out](id_type id, const glm::ivec2 &) {
+		out.emplace_back(id);
+	});
+
+	return IdSpan(out.data(), out.size());
+}
+
+EntityGrid::IdSpan EntityGrid::queryRadius(const glm::ivec2 &centre, int32_t radius,
+        std::vector<id_type> &out) const {
+	out.clear();
+
+	forEachInRadius(centre, radius, [&out](id_type id, const glm::ivec2 &) {
+		out.emplace_back(id);
+	});
+
+	return IdSpan(out.data(), out.size());
+}
+
+EntityGrid::IdSpan EntityGrid::cellEntities(int32_t cellX, int32_t cellY) const {
+	if (cellX < 0 || cellY < 0 || cellX >= cellsWide_ || cellY >= cellsHigh_) {
+		return IdSpan();
+	}
+
+	const auto &cell = cells_[cellY * cellsWide_ + cellX];
+
+	return IdSpan(cell.ids.data(), cell.ids.size());
+}
+
+void EntityGrid::addToCell(id_type id, const glm::ivec2 &tile, Entry &entry) {
+	entry.cell = cellIndexFor(tile);
+
+	auto &cell = cells_[entry.cell];
+	entry.slot = static_cast<uint32_t>(cell.ids.size());
+
+	cell.ids.emplace_back(id);
+	cell.tiles.emplace_back(tile);
+}
+
+void EntityGrid::removeFromCell(const Entry &entry) {
+	auto &cell = cells_[entry.cell];
+	const auto lastSlot = static_cast<uint32_t>(cell.ids.size() - 1u);
+
+	if (entry.slot != lastSlot) {
+		// fill the gap with the last entity in the cell, and tell it where it's gone.
+		const auto movedID = cell.ids[lastSlot];
+
+		cell.ids[entry.slot] = movedID;
+		cell.tiles[entry.slot] = cell.tiles[lastSlot];
+
+		entries_[movedID].slot = entry.slot;
+	}
+
+	cell.ids.pop_back();
+	cell.tiles.pop_back();
+}
+
+}
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <future>
+
+#include "FieldOfView.hpp"
+
+namespace PlayPG {
+
+constexpr const int32_t FieldOfView::MAX_RADIUS;
+constexpr const std::size_t VisibilityCache::DEFAULT_CAPACITY;
+
+namespace {
+
+// Floor division which rounds towards negative infinity; den must be positive.
+int32_t floorDiv(int32_t num, int32_t den) {
+	return num / den - ((num % den != 0) && (num < 0));
+}
+
+int32_t ceilDiv(int32_t num, int32_t den) {
+	return -floorDiv(-num, den);
+}
+
+/*
+ * A row of tiles at some depth away from the origin within one quadrant, bounded by two slopes stored as
+ * exact fractions so that the result is the same on every platform.
+ */
+struct ShadowRow {
+	int32_t depth;
+
+	int32_t startNum;
+	int32_t startDen;
+	int32_t endNum;
+	int32_t endDen;
+
+	// depth * start, rounded with ties up
+	int32_t minCol() const {
+		return floorDiv(2 * depth * startNum + startDen, 2 * startDen);
+	}
+
+	// depth * end, rounded with ties down
+	int32_t maxCol() const {
+		return ceilDiv(2 * depth * endNum - endDen, 2 * endDen);
+	}
+
+	// Only floor tiles whose centre lies within the row's slopes are visible, which is what makes the
+	// algorithm symmetric.
+	bool isSymmetric(int32_t col) const {
+		return col * startDen >= depth * startNum && col * endDen <= depth * endNum;
+	}
+};
+
+}
+
+FieldOfView::FieldOfView(const BitGrid &opaque, const glm::ivec2 &origin, int32_t radius) :
+		        origin_ { origin },
+		        radius_ { std::min(std::max(radius, 0), MAX_RADIUS) },
+		        visible_(static_cast<uint32_t>(2 * radius_ + 1), static_cast<uint32_t>(2 * radius_ + 1)) {
+	const int32_t width = static_cast<int32_t>(opaque.getWidth());
+	const int32_t height = static_cast<int32_t>(opaque.getHeight());
+
+	if (origin.x < 0 || origin.y < 0 || origin.x >= width || origin.y >= height) {
+		return;
+	}
+
+	reveal(opaque, origin.x, origin.y);
+
+	// Directions (depth -> x/y, column -> x/y) for north, south, east and west.
+	static constexpr const int32_t quadrants[4][4] = { { 0, -1, 1, 0 }, { 0, 1, 1, 0 }, { 1, 0, 0, 1 }, { -1, 0, 0, 1 } };
+
+	std::vector<ShadowRow> rows;
+
+	for (const auto &quadrant : quadrants) {
+		const auto toMap = [&](int32_t depth, int32_t col) {
+			return glm::ivec2 { origin.x + depth * quadrant[0] + col * quadrant[2], origin.y + depth * quadrant[1]
+			        + col * quadrant[3] };
+		};
+
+		// Anything off the map blocks sight.
+		const auto isWall = [&](const glm::ivec2 &tile) {
+			return tile.x < 0 || tile.y < 0 || tile.x >= width || tile.y >= height || opaque.get(tile.x, tile.y);
+		};
+
+		rows.clear();
+		rows.emplace_back(ShadowRow { 1, -1, 1, 1, 1 });
+
+		while (!rows.empty()) {
+			auto row = rows.back();
+			rows.pop_back();
+
+			if (row.depth > radius_) {
+				continue;
+			}
+
+			const int32_t maxCol = row.maxCol();
+			int prev = -1; // -1: none yet, 0: floor, 1: wall
+
+			for (int32_t col = row.minCol(); col <= maxCol; ++col) {
+				const auto tile = toMap(row.depth, col);
+				const bool wall = isWall(tile);
+
+				if ((wall || row.isSymmetric(col)) && row.depth * row.depth + col * col <= radius_ * (radius_ + 1)) {
+					reveal(opaque, tile.x, tile.y);
+				}
+
+				if (prev == 1 && !wall) {
+					row.startNum = 2 * col - 1;
+					row.startDen = 2 * row.depth;
+				}
+
+				if (prev == 0 && wall) {
+					rows.emplace_back(ShadowRow { row.depth + 1, row.startNum, row.startDen, 2 * col - 1, 2 * row.depth });
+				}
+
+				prev = wall ? 1 : 0;
+			}
+
+			if (prev == 0) {
+				rows.emplace_back(ShadowRow { row.depth + 1, row.startNum, row.startDen, row.endNum, row.endDen });
+			}
+		}
+	}
+}
+
+void FieldOfView::reveal(const BitGrid &opaque, int32_t x, int32_t y) {
+	if (x < 0 || y < 0 || x >= static_cast<int32_t>(opaque.getWidth()) || y >= static_cast<int32_t>(opaque.getHeight())) {
+		return;
+	}
+
+	const auto localX = static_cast<uint32_t>(x - origin_.x + radius_);
+	const auto localY = static_cast<uint32_t>(y - origin_.y + radius_);
+
+	if (!visible_.get(localX, localY)) {
+		visible_.set(localX, localY, true);
+		++visibleCount_;
+	}
+}
+
+bool hasLineOfSight(const BitGrid &opaque, const glm::ivec2 &from, const glm::ivec2 &to) {
+	const int32_t width = static_cast<int32_t>(opaque.getWidth());
+	const int32_t height = static_cast<int32_t>(opaque.getHeight());
+
+	const auto inGrid = [&](const glm::ivec2 &tile) {
+		return tile.x >= 0 && tile.y >= 0 && tile.x < width && tile.y < height;
+	};
+
+	if (!inGrid(from) || !inGrid(to)) {
+		return false;
+	}
+
+	const int32_t dx = to.x - from.x;
+	const int32_t dy = to.y - from.y;
+	const int32_t steps = std::max(std::abs(dx), std::abs(dy));
+	const bool xMajor = std::abs(dx) >= std::abs(dy);
+
+	// Step one tile at a time along the major axis; the minor coordinate at step i is exactly
+	// minorStart + i * minorDelta / steps, kept as a numerator over steps to avoid rounding error.
+	const int32_t majorStart = xMajor ? from.x : from.y;
+	const int32_t majorStep = (xMajor ? dx : dy) < 0 ? -1 : 1;
+	const int32_t minorStart = xMajor ? from.y : from.x;
+	const int32_t minorDelta = xMajor ? dy : dx;
+
+	const auto isOpaque = [&](int32_t major, int32_t minor) {
+		return xMajor ? opaque.get(major, minor) : opaque.get(minor, major);
+	};
+
+	for (int32_t i = 1; i < steps; ++i) {
+		const int32_t major = majorStart + i * majorStep;
+		const int32_t minorNum = minorStart * steps + i * minorDelta;
+		const int32_t remainder = minorNum % steps;
+
+		if (2 * remainder == steps) {
+			// The line runs exactly between two tiles.
+			const int32_t below = minorNum / steps;
+
+			if (isOpaque(major, below) && isOpaque(major, below + 1)) {
+				return false;
+			}
+		} else if (isOpaque(major, floorDiv(2 * minorNum + steps, 2 * steps))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+VisibilityCache::VisibilityCache(const BitGrid &opaque, std::size_t capacity) :
+		        opaque_ { opaque },
+		        capacity_ { std::max(capacity, std::size_t { 1u }) } {
+}
+
+std::shared_ptr<const FieldOfView> VisibilityCache::get(const glm::ivec2 &origin, int32_t radius) {
+	const auto key = makeKey(origin, radius);
+	auto fov = lookup(key);
+
+	if (fov == nullptr) {
+		fov = std::make_shared<const FieldOfView>(opaque_, origin, radius);
+		store(key, fov);
+	}
+
+	return fov;
+}
+
+std::vector<std::shared_ptr<const FieldOfView>> VisibilityCache::getAll(const std::vector<Viewer> &viewers,
+        ThreadPool &pool) {
+	std::vector<std::shared_ptr<const FieldOfView>> results(viewers.size());
+
+	// Indices of viewers which missed the cache, with duplicates (e.g. two players on the same tile)
+	// only computed once.
+	std::vector<std::size_t> misses;
+	std::unordered_map<key_type, std::size_t> firstMiss;
+
+	for (std::size_t i = 0u; i < viewers.size(); ++i) {
+		const auto key = makeKey(viewers[i].origin, viewers[i].radius);
+		results[i] = lookup(key);
+
+		if (results[i] == nullptr && firstMiss.emplace(key, i).second) {
+			misses.emplace_back(i);
+		}
+	}
+
+	if (!misses.empty()) {
+		const std::size_t chunkCount = std::min<std::size_t>(misses.size(), pool.getThreadCount());
+		const std::size_t chunkSize = (misses.size() + chunkCount - 1u) / chunkCount;
+
+		std::vector<std::future<void>> futures;
+		futures.reserve(chunkCount);
+
+		for (std::size_t first = 0u; first < misses.size(); first += chunkSize) {
+			const std::size_t last = std::min(first + chunkSize, misses.size());
+
+			futures.emplace_back(pool.submit([this, first, last, &misses, &viewers, &results]() {
+				for (std::size_t i = first; i < last; ++i) {
+					const auto &viewer = viewers[misses[i]];
+					results[misses[i]] = std::make_shared<const FieldOfView>(opaque_, viewer.origin, viewer.radius);
+				}
+			}));
+		}
+
+		for (auto &future : futures) {
+			future.get();
+		}
+
+		for (const auto index : misses) {
+			store(makeKey(viewers[index].origin, viewers[index].radius), results[index]);
+		}
+
+		for (std::size_t i = 0u; i < viewers.size(); ++i) {
+			if (results[i] == nullptr) {
+				results[i] = results[firstMiss[makeKey(viewers[i].origin, viewers[i].radius)]];
+			}
+		}
+	}
+
+	return results;
+}
+
+std::size_t VisibilityCache::getHitCount() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return hits_;
+}
+
+std::size_t VisibilityCache::getMissCount() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return misses_;
+}
+
+VisibilityCache::key_type VisibilityCache::makeKey(const glm::ivec2 &origin, int32_t radius) {
+	const auto clampedRadius = std::min(std::max(radius, 0), FieldOfView::MAX_RADIUS);
+
+	return (static_cast<key_type>(static_cast<uint32_t>(origin.x) & 0xFFFFFFu) << 40u)
+	        | (static_cast<key_type>(static_cast<uint32_t>(origin.y) & 0xFFFFFFu) << 16u)
+	        | static_cast<key_type>(clampedRadius);
+}
+
+std::shared_ptr<const FieldOfView> VisibilityCache::lookup(key_type key) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	const auto found = index_.find(key);
+
+	if (found == index_.end()) {
+		++misses_;
+		return nullptr;
+	}
+
+	++hits_;
+	entries_.splice(entries_.begin(), entries_, found->second);
+
+	return found->second->second;
+}
+
+void VisibilityCache::store(key_type key, std::shared_ptr<const FieldOfView> fov) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	// Another thread might have computed the same field of view while we were.
+	if (index_.find(key) != index_.end()) {
+		return;
+	}
+
+	entries_.emplace_front(key, std::move(fov));
+	index_.emplace(key, entries_.begin());
+
+	while (entries_.size() > capacity_) {
+		index_.erase(entries_.back().first);
+		entries_.pop_back();
+	}
+}
+
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "InterestManager.hpp"
+
+namespace PlayPG {
+
+constexpr const int32_t InterestManager::DEFAULT_RADIUS_IN_CELLS;
+constexpr const int32_t InterestManager::DEFAULT_HYSTERESIS_IN_CELLS;
+
+const InterestManager::CellRect InterestManager::EMPTY_RECT { 0, 0, -1, -1 };
+
+InterestManager::InterestManager(const EntityGrid &entities, int32_t radiusInCells, int32_t hysteresisInCells) :
+		        entities_ { entities },
+		        radius_ { std::max(radiusInCells, 0) },
+		        hysteresis_ { std::max(hysteresisInCells, 0) },
+		        cellSubscribers_(static_cast<std::size_t>(entities.getCellsWide()) * entities.getCellsHigh()) {
+}
+
+void InterestManager::updateSubscriber(id_type subscriber, const glm::ivec2 &tile, std::vector<InterestEvent> &events) {
+	const auto cell = cellOf(tile);
+	const auto inner = rectAround(cell, radius_);
+	const auto outer = rectAround(cell, radius_ + hysteresis_);
+
+	auto it = subscriptions_.find(subscriber);
+
+	if (it == subscriptions_.end()) {
+		it = subscriptions_.emplace(subscriber, EMPTY_RECT).first;
+	}
+
+	const auto old = it->second;
+
+	if (old.contains(inner) && outer.contains(old)) {
+		// Still inside the hysteresis band; by far the most common case.
+		return;
+	}
+
+	// Keep whatever's still close enough and grow that to cover everything that must be subscribed. Both
+	// rectangles are inside outer, so their bounding box is too.
+	const CellRect kept { std::max(old.x0, outer.x0), std::max(old.y0, outer.y0), std::min(old.x1, outer.x1),
+	        std::min(old.y1, outer.y1) };
+
+	const auto next = kept.empty() ? inner : CellRect { std::min(kept.x0, inner.x0), std::min(kept.y0, inner.y0),
+	        std::max(kept.x1, inner.x1), std::max(kept.y1, inner.y1) };
+
+	for (int32_t y = old.y0; y <= old.y1; ++y) {
+		for (int32_t x = old.x0; x <= old.x1; ++x) {
+			if (!next.contains(glm::ivec2 { x, y })) {
+				unsubscribeCell(subscriber, glm::ivec2 { x, y }, &events);
+			}
+		}
+	}
+
+	for (int32_t y = next.y0; y <= next.y1; ++y) {
+		for (int32_t x = next.x0; x <= next.x1; ++x) {
+			if (!old.contains(glm::ivec2 { x, y })) {
+				subscribeCell(subscriber, glm::ivec2 { x, y }, events);
+			}
+		}
+	}
+
+	it->second = next;
+}
+
+void InterestManager::removeSubscriber(id_type subscriber, std::vector<InterestEvent> *events) {
+	const auto it = subscriptions_.find(subscriber);
+
+	if (it == subscriptions_.end()) {
+		return;
+	}
+
+	const auto rect = it->second;
+
+	for (int32_t y = rect.y0; y <= rect.y1; ++y) {
+		for (int32_t x = rect.x0; x <= rect.x1; ++x) {
+			unsubscribeCell(subscriber, glm::ivec2 { x, y }, events);
+		}
+	}
+
+	subscriptions_.erase(it);
+}
+
+void InterestManager::entityAdded(id_type entity, const glm::ivec2 &tile, std::vector<InterestEvent> &events) {
+	forEachSubscriber(tile, [&](id_type subscriber) {
+		if (subscriber != entity) {
+			events.emplace_back(InterestEvent { subscriber, entity, tile, InterestEvent::Type::ENTER });
+		}
+	});
+}
+
+void InterestManager::entityMoved(id_type entity, const glm::ivec2 &from, const glm::ivec2 &to,
+        std::vector<InterestEvent> &events) {
+	const auto fromCell = cellOf(from);
+	const auto toCell = cellOf(to);
+
+	if (fromCell == toCell) {
+		return;
+	}
+
+	for (const auto subscriber : cellSubscribers_[cellIndexFor(fromCell)]) {
+		if (subscriber != entity && !subscriptions_.at(subscriber).contains(toCell)) {
+			events.emplace_back(InterestEvent { subscriber, entity, to, InterestEvent::Type::LEAVE });
+		}
+	}
+
+	for (const auto subscriber : cellSubscribers_[cellIndexFor(toCell)]) {
+		if (subscriber != entity && !subscriptions_.at(subscriber).contains(fromCell)) {
+			events.emplace_back(InterestEvent { subscriber, entity, to, InterestEvent::Type::ENTER });
+		}
+	}
+}
+
+void InterestManager::entityRemoved(id_type entity, const glm::ivec2 &tile, std::vector<InterestEvent> &events) {
+	forEachSubscriber(tile, [&](id_type subscriber) {
+		if (subscriber != entity) {
+			events.emplace_back(InterestEvent { subscriber, entity, tile, InterestEvent::Type::LEAVE });
+		}
+	});
+}
+
+bool InterestManager::isSubscribed(id_type subscriber, const glm::ivec2 &tile) const {
+	const auto it = subscriptions_.find(subscriber);
+	return it != subscriptions_.end() && it->second.contains(cellOf(tile));
+}
+
+glm::ivec2 InterestManager::cellOf(const glm::ivec2 &tile) const {
+	const auto cellSize = entities_.getCellSize();
+
+	return glm::ivec2 { std::min(std::max(tile.x, 0) / cellSize, entities_.getCellsWide() - 1), std::min(
+	        std::max(tile.y, 0) / cellSize, entities_.getCellsHigh() - 1) };
+}
+
+InterestManager::CellRect InterestManager::rectAround(const glm::ivec2 &cell, int32_t radius) const {
+	return CellRect { std::max(cell.x - radius, 0), std::max(cell.y - radius, 0), std::min(cell.x + radius,
+	        entities_.getCellsWide() - 1), std::min(cell.y + radius, entities_.getCellsHigh() - 1) };
+}
+
+void InterestManager::subscribeCell(id_type subscriber, const glm::ivec2 &cell, std::vector<InterestEvent> &events) {
+	cellSubscribers_[cellIndexFor(cell)].emplace_back(subscriber);
+
+	const auto cellSize = entities_.getCellSize();
+
+	entities_.forEachInRect(cell.x * cellSize, cell.y * cellSize, cellSize, cellSize,
+	        [&](id_type entity, const glm::ivec2 &tile) {
+		        if (entity != subscriber) {
+			        events.emplace_back(InterestEvent { subscriber, entity, tile, InterestEvent::Type::ENTER });
+		        }
+	        });
+}
+
+void InterestManager::unsubscribeCell(id_type subscriber, const glm::ivec2 &cell, std::vector<InterestEvent> *events) {
+	auto &subscribers = cellSubscribers_[cellIndexFor(cell)];
+	const auto it = std::find(subscribers.begin(), subscribers.end(), subscriber);
+
+	if (it != subscribers.end()) {
+		*it = subscribers.back();
+		subscribers.pop_back();
+	}
+
+	if (events == nullptr) {
+		return;
+	}
+
+	const auto cellSize = entities_.getCellSize();
+
+	entities_.forEachInRect(cell.x * cellSize, cell.y * cellSize, cellSize, cellSize,
+	        [&](id_type entity, const glm::ivec2 &tile) {
+		        if (entity != subscriber) {
+			        events->emplace_back(InterestEvent { subscriber, entity, tile, InterestEvent::Type::LEAVE });
+		        }
+	        });
+}
+
+}
@@ -25,7 +25,10 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -34,20 +37,155 @@
 #include <APG/core/APGeasylogging.hpp>
 
 #include "Map.hpp"
+#include "CompiledMap.hpp"
 #include "util/Util.hpp"
 
 namespace PlayPG {
 
-Map::Map(const Tmx::Map * map_) :
-		        map { map_ } {
-	parseMap();
+namespace {
+
+enum TileFlags : uint8_t {
+	TILE_SOLID = 1u << 0,
+	TILE_INTERESTING = 1u << 1,
+	TILE_SPAWN = 1u << 2
+};
+
+// Maps smaller than this are parsed faster than threads can be started.
+constexpr const int MIN_PARALLEL_PARSE_AREA = 256 * 256;
+constexpr const int MIN_ROWS_PER_PARSE_THREAD = 64;
+
+/**
+ * Every property lookup needed by parseTiles, done once per layer and tileset rather than per tile.
+ */
+struct TilePropertyTables {
+	// Flags applied to every laid tile on a layer, indexed by layer.
+	std::vector<uint8_t> layerFlags;
+
+	// Flags for individual tiles, indexed by tileset then by tile ID within the tileset.
+	std::vector<std::vector<uint8_t>> tilesetTileFlags;
+};
+
+TilePropertyTables buildPropertyTables(const Tmx::Map * map) {
+	TilePropertyTables tables;
+
+	for (const auto &layer : map->GetTileLayers()) {
+		uint8_t flags = 0u;
+
+		if (layer->GetProperties().GetStringProperty("solid") != "") {
+			flags |= TILE_SOLID;
+		}
+
+		if (layer->GetName() == "__playerSpawn") {
+			flags |= TILE_SPAWN;
+		}
+
+		tables.layerFlags.emplace_back(flags);
+	}
+
+	tables.tilesetTileFlags.resize(map->GetNumTilesets());
+
+	for (int i = 0; i < map->GetNumTilesets(); ++i) {
+		auto &tileFlags = tables.tilesetTileFlags[i];
+
+		for (const auto &tile : map->GetTileset(i)->GetTiles()) {
+			if (tile->GetProperties().GetStringProperty("interesting") == "") {
+				continue;
+			}
+
+			const auto tileID = static_cast<std::size_t>(tile->GetId());
+
+			if (tileID >= tileFlags.size()) {
+				tileFlags.resize(tileID + 1u, 0u);
+			}
+
+			tileFlags[tileID] |= TILE_INTERESTING;
+		}
+	}
+
+	return tables;
+}
+
+unsigned int chooseParseThreadCount(int width, int height, unsigned int threadBudget) {
+	if (threadBudget <= 1u || width * height < MIN_PARALLEL_PARSE_AREA) {
+		return 1u;
+	}
+
+	const unsigned int maxByRows = std::max(1, height / MIN_ROWS_PER_PARSE_THREAD);
+
+	return std::min(threadBudget, maxByRows);
+}
+
+}
+
+Map::Map(const Tmx::Map * map_, unsigned int parseThreads) :
+		        map { map_ },
+		        fileName_ { map_->GetFilename() },
+		        width_ { map_->GetWidth() },
+		        height_ { map_->GetHeight() },
+		        tileWidth_ { map_->GetTileWidth() },
+		        tileHeight_ { map_->GetTileHeight() },
+		        inverseTileWidth_ { 1.0f / tileWidth_ },
+		        inverseTileHeight_ { 1.0f / tileHeight_ },
+		        solid_(width_, height_),
+		        interesting_(width_, height_),
+		        spawn_(width_, height_) {
+	parseMap(parseThreads);
+}
+
+Map::Map(const CompiledMap &compiled) :
+		        map { nullptr },
+		        name_ { compiled.getName() },
+		        version_ { compiled.getHeader().mapVersion },
+		        fileName_ { compiled.getFileName() },
+		        sourceHash_ { compiled.getSourceHash() },
+		        width_ { static_cast<int>(compiled.getHeader().width) },
+		        height_ { static_cast<int>(compiled.getHeader().height) },
+		        tileWidth_ { static_cast<int>(compiled.getHeader().tileWidth) },
+		        tileHeight_ { static_cast<int>(compiled.getHeader().tileHeight) },
+		        inverseTileWidth_ { 1.0f / tileWidth_ },
+		        inverseTileHeight_ { 1.0f / tileHeight_ },
+		        solid_ { BitGrid::view(width_, height_, compiled.getSolidWords(), compiled.getMappedFile()) },
+		        interesting_(width_, height_),
+		        spawn_(width_, height_) {
+	const auto logger = el::Loggers::getLogger("PlayPG");
+	const auto &header = compiled.getHeader();
+
+	logger->verbose(9, "Loading compiled map with name \"%v\".", name_);
+
+	for (uint32_t i = 0; i < header.interestingCount; ++i) {
+		const auto tileIndex = compiled.getInterestingTiles()[i];
+		interesting_.set(tileIndex % width_, tileIndex / width_);
+	}
+
+	for (uint32_t i = 0; i < header.spawnCount; ++i) {
+		const auto tileIndex = compiled.getSpawnTiles()[i];
+		spawn_.set(tileIndex % width_, tileIndex / width_);
+	}
+
+	if (header.spawnCount > 0u) {
+		// spawn tiles are stored in row-major order, so this matches the last-seen spawn point of parseTiles.
+		const auto lastSpawn = compiled.getSpawnTiles()[header.spawnCount - 1u];
+		spawnPoint.x = lastSpawn % width_;
+		spawnPoint.y = lastSpawn / width_;
+	}
+
+	objects_.reserve(header.objectCount);
+
+	for (uint32_t i = 0; i < header.objectCount; ++i) {
+		const auto &object = compiled.getObjects()[i];
+
+		objects_.emplace_back(compiled.getObjectName(object), glm::vec2 { object.x, object.y },
+		        glm::vec2 { object.width, object.height });
+	}
+
+	buildIndices();
 }
 
-const MapTile &Map::getTile(uint32_t x, uint32_t y) const {
-	return tiles[resolveTileLoc(x, y)];
+MapTile Map::getTile(uint32_t x, uint32_t y) const {
+	return MapTile(solid_.get(x, y), interesting_.get(x, y), spawn_.get(x, y));
 }
 
-void Map::parseMap() {
+void Map::parseMap(unsigned int parseThreads) {
 	const auto logger = el::Loggers::getLogger("PlayPG");
 
 	name_ = Map::resolveNameFromMap(map, logger);
@@ -55,62 +193,109 @@ void Map::parseMap() {
 
 	logger->verbose(9, "Loading map with name \"%v\".", name_);
 
-	const size_t mapArea = map->GetWidth() * map->GetHeight();
-	tiles.reserve(mapArea);
-
-	parseTiles(logger);
+	parseTiles(parseThreads, logger);
 
 	for (const auto &objectGroup : map->GetObjectGroups()) {
 		for (const auto &object : objectGroup->GetObjects()) {
 			glm::vec2 objectCentre { object->GetX() + object->GetWidth() / 2, object->GetY() + object->GetHeight() / 2 };
-			logger->info("Object \"%v\" located at (%v, %v).", object->GetName(), objectCentre.x, objectCentre.y);
+			logger->verbose(9, "Object \"%v\" located at (%v, %v).", object->GetName(), objectCentre.x, objectCentre.y);
+
+			objects_.emplace_back(object->GetName(),
+			        glm::vec2 { static_cast<float>(object->GetX()), static_cast<float>(object->GetY()) },
+			        glm::vec2 { static_cast<float>(object->GetWidth()), static_cast<float>(object->GetHeight()) });
 		}
 	}
+
+	buildIndices();
+	logger->verbose(1, "Indexed %v objects.", objects_.size());
 }
 
 void Map::parseLayers(el::Logger * const logger) {
 
 }
 
-void Map::parseTiles(el::Logger * const logger) {
-	for (int y = 0; y < map->GetHeight(); ++y) {
-		for (int x = 0; x < map->GetWidth(); ++x) {
-			bool solid = false, interesting = false, spawn = false;
-
-			for (const auto &layer : map->GetTileLayers()) {
-				if (layer->GetTileTilesetIndex(x, y) != -1) {
-					const auto &properties = layer->GetProperties();
-					const auto solidProp = properties.GetStringProperty("solid");
+void Map::parseTiles(unsigned int parseThreads, el::Logger * const logger) {
+	const auto tables = buildPropertyTables(map);
+	const auto &layers = map->GetTileLayers();
 
-					if (solidProp != "") {
-						solid = true;
-					}
+	// Rows never share words in a BitGrid, so each thread can write its own rows without locking.
+	const auto parseRows = [this, &tables, &layers](int yStart, int yEnd) {
+		for (int y = yStart; y < yEnd; ++y) {
+			for (int x = 0; x < width_; ++x) {
+				uint8_t flags = 0u;
 
-					const auto tmxTile = map->GetTileset(layer->GetTileTilesetIndex(x, y))->GetTile(
-					        layer->GetTileId(x, y));
-					if (tmxTile != nullptr) {
-						const auto &tilePs = tmxTile->GetProperties().GetStringProperty("interesting");
+				for (std::size_t layerIndex = 0u; layerIndex < layers.size(); ++layerIndex) {
+					const auto &layer = layers[layerIndex];
+					const auto tilesetIndex = layer->GetTileTilesetIndex(x, y);
 
-						if (tilePs != "") {
-							logger->verbose(1, "Interesting tile at (x, y) = (%v, %v).", x, y);
-							interesting = true;
-						}
+					if (tilesetIndex == -1) {
+						continue;
 					}
 
-					if (layer->GetName() == "__playerSpawn") {
-						// any laid tile counts as a spawn point on a __playerSpawn level.
+					flags |= tables.layerFlags[layerIndex];
+
+					const auto &tileFlags = tables.tilesetTileFlags[tilesetIndex];
+					const auto tileID = static_cast<std::size_t>(layer->GetTileId(x, y));
 
-						// at the moment, the last detected spawn point will be used as the definitive point.
-						logger->verbose(1, "Found spawn point at (x, y) = (%v, %v).", x, y);
-						spawnPoint.x = x;
-						spawnPoint.y = y;
+					if (tileID < tileFlags.size()) {
+						flags |= tileFlags[tileID];
 					}
 				}
+
+				solid_.set(x, y, (flags & TILE_SOLID) != 0u);
+				interesting_.set(x, y, (flags & TILE_INTERESTING) != 0u);
+				spawn_.set(x, y, (flags & TILE_SPAWN) != 0u);
+			}
+		}
+	};
+
+	const auto threadCount = chooseParseThreadCount(width_, height_, parseThreads);
+
+	if (threadCount <= 1u) {
+		parseRows(0, height_);
+	} else {
+		logger->verbose(9, "Parsing tiles for \"%v\" on %v threads.", name_, threadCount);
+
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount);
+
+		const int rowsPerThread = (height_ + threadCount - 1) / threadCount;
+
+		for (unsigned int i = 0u; i < threadCount; ++i) {
+			const int yStart = i * rowsPerThread;
+			const int yEnd = std::min(height_, yStart + rowsPerThread);
+
+			if (yStart < yEnd) {
+				threads.emplace_back(parseRows, yStart, yEnd);
 			}
+		}
 
-			tiles.emplace_back(solid, interesting, spawn);
+		for (auto &thread : threads) {
+			thread.join();
 		}
 	}
+
+	// any laid tile counts as a spawn point on a __playerSpawn level.
+	// at the moment, the last detected spawn point will be used as the definitive point.
+	std::size_t spawnCount = 0u;
+
+	spawn_.forEachSet([this, &spawnCount](uint32_t x, uint32_t y) {
+		spawnPoint.x = x;
+		spawnPoint.y = y;
+		++spawnCount;
+	});
+
+	if (spawnCount > 0u) {
+		logger->verbose(1, "Found %v spawn points; using (x, y) = (%v, %v).", spawnCount, spawnPoint.x, spawnPoint.y);
+	}
+
+	logger->verbose(1, "Found %v interesting tiles.", interesting_.count());
+}
+
+void Map::buildIndices() {
+	spawnIndex_ = TileIndex(spawn_);
+	interestingIndex_ = TileIndex(interesting_);
+	objectTree_ = ObjectTree(objects_);
 }
 
 std::string Map::resolveNameFromMap(const Tmx::Map * map, el::Logger * const logger) {
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdio>
+
+#include <fstream>
+#include <sstream>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "MapHashCache.hpp"
+#include "MapHeader.hpp"
+
+namespace PlayPG {
+
+constexpr const char *MapHashCache::DEFAULT_FILE_NAME;
+
+std::string MapHashCache::defaultCacheFileFor(const std::string &mapFileName) {
+	const auto lastSeparator = mapFileName.find_last_of("/\\");
+
+	if (lastSeparator == std::string::npos) {
+		return DEFAULT_FILE_NAME;
+	}
+
+	return mapFileName.substr(0u, lastSeparator + 1) + DEFAULT_FILE_NAME;
+}
+
+MapHashCache::MapHashCache(const std::string &cacheFileName, el::Logger * const logger) :
+		        cacheFileName_ { cacheFileName },
+		        logger_ { logger } {
+	std::ifstream file(cacheFileName_);
+
+	if (!file) {
+		logger_->verbose(5, "No map hash cache at %v; all maps will be hashed.", cacheFileName_);
+		return;
+	}
+
+	std::string line;
+
+	while (std::getline(file, line)) {
+		// Each line is "<algorithm> <hash> <size> <modification time> <file name>"; the file name comes last
+		// so that it may contain spaces.
+		std::istringstream lineStream(line);
+
+		std::string algorithm;
+		Entry entry;
+
+		if (!(lineStream >> algorithm >> entry.hash >> entry.fileSize >> entry.modificationTime)) {
+			continue;
+		}
+
+		std::string fileName;
+		lineStream.get();
+		std::getline(lineStream, fileName);
+
+		// entries made with another algorithm are useless, and are dropped on the next save.
+		if (fileName.empty() || algorithm != MapHeader::HASH_ALGORITHM) {
+			dirty_ = true;
+			continue;
+		}
+
+		entries_[fileName] = std::move(entry);
+	}
+
+	logger_->verbose(5, "Loaded %v cached map hashes from %v.", entries_.size(), cacheFileName_);
+}
+
+std::string MapHashCache::lookup(const std::string &fileName) const {
+	uint64_t fileSize;
+	int64_t modificationTime;
+
+	if (!MapHashCache::readFileDetails(fileName, &fileSize, &modificationTime)) {
+		return "";
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	const auto it = entries_.find(fileName);
+
+	if (it == entries_.end() || it->second.fileSize != fileSize
+	        || it->second.modificationTime != modificationTime) {
+		return "";
+	}
+
+	return it->second.hash;
+}
+
+void MapHashCache::store(const std::string &fileName, uint64_t fileSize, int64_t modificationTime,
+        const std::string &hash) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	entries_[fileName] = Entry { fileSize, modificationTime, hash };
+	dirty_ = true;
+}
+
+bool MapHashCache::save() {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (!dirty_) {
+		return true;
+	}
+
+	const auto tempFileName = cacheFileName_ + ".tmp";
+
+	{
+		std::ofstream file(tempFileName, std::ios::out | std::ios::trunc);
+
+		if (!file) {
+			logger_->warn("Couldn't write map hash cache %v; maps will be rehashed next time.", cacheFileName_);
+			return false;
+		}
+
+		for (const auto &entry : entries_) {
+			uint64_t fileSize;
+			int64_t modificationTime;
+
+			if (!MapHashCache::readFileDetails(entry.first, &fileSize, &modificationTime)) {
+				continue;
+			}
+
+			file << MapHeader::HASH_ALGORITHM << ' ' << entry.second.hash << ' ' << entry.second.fileSize << ' '
+			        << entry.second.modificationTime << ' ' << entry.first << '\n';
+		}
+
+		if (!file) {
+			logger_->warn("Error while writing map hash cache %v.", tempFileName);
+			return false;
+		}
+	}
+
+	if (std::rename(tempFileName.c_str(), cacheFileName_.c_str()) != 0) {
+		logger_->warn("Couldn't replace map hash cache %v.", cacheFileName_);
+		std::remove(tempFileName.c_str());
+		return false;
+	}
+
+	dirty_ = false;
+	return true;
+}
+
+bool MapHashCache::readFileDetails(const std::string &fileName, uint64_t * fileSize, int64_t * modificationTime) {
+	// PLATFORM SPECIFIC: nanosecond modification times are only available on some platforms.
+#ifdef _WIN32
+	struct _stat64 details;
+
+	if (::_stat64(fileName.c_str(), &details) != 0) {
+		return false;
+	}
+
+	*modificationTime = static_cast<int64_t>(details.st_mtime) * 1000000000;
+#else
+	struct stat details;
+
+	if (::stat(fileName.c_str(), &details) != 0) {
+		return false;
+	}
+
+#if defined(__APPLE__)
+	*modificationTime = static_cast<int64_t>(details.st_mtimespec.tv_sec) * 1000000000
+	        + details.st_mtimespec.tv_nsec;
+#else
+	*modificationTime = static_cast<int64_t>(details.st_mtim.tv_sec) * 1000000000 + details.st_mtim.tv_nsec;
+#endif
+#endif
+
+	*fileSize = static_cast<uint64_t>(details.st_size);
+
+	return true;
+}
+
+}
@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include <array>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+#include <APG/core/APGeasylogging.hpp>
+
+#include "MapHeader.hpp"
+#include "MapHashCache.hpp"
+#include "CompiledMap.hpp"
+#include "util/XXHash64.hpp"
+
+namespace PlayPG {
+
+namespace {
+
+constexpr const std::size_t SCAN_CHUNK_SIZE = 64u * 1024u;
+
+// A TMX header is a handful of properties; anything this large isn't worth scanning for one.
+constexpr const std::size_t MAX_HEADER_SIZE = 1024u * 1024u;
+
+// Any of these mark the end of the map-level properties; nothing after them is needed.
+constexpr const std::array<const char *, 6> HEADER_TERMINATORS { { "</properties>", "<tileset", "<layer",
+        "<objectgroup", "<imagelayer", "</map>" } };
+
+using AttributeMap = std::unordered_map<std::string, std::string>;
+
+std::string decodeEntities(const std::string &str) {
+	if (str.find('&') == std::string::npos) {
+		return str;
+	}
+
+	static const std::array<std::pair<const char *, char>, 5> entities { { { "&amp;", '&' }, { "&lt;", '<' }, {
+	        "&gt;", '>' }, { "&quot;", '"' }, { "&apos;", '\'' } } };
+
+	std::string ret;
+	ret.reserve(str.size());
+
+	for (std::string::size_type i = 0; i < str.size(); ++i) {
+		bool replaced = false;
+
+		if (str[i] == '&') {
+			for (const auto &entity : entities) {
+				const auto entityLength = std::strlen(entity.first);
+
+				if (str.compare(i, entityLength, entity.first) == 0) {
+					ret += entity.second;
+					i += entityLength - 1;
+					replaced = true;
+					break;
+				}
+			}
+		}
+
+		if (!replaced) {
+			ret += str[i];
+		}
+	}
+
+	return ret;
+}
+
+bool isXMLSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * Parses attributes from the element starting at tagStart (which should point to the '<') up until the
+ * closing '>' of that element.
+ */
+AttributeMap parseAttributes(const std::string &text, std::string::size_type tagStart) {
+	AttributeMap attributes;
+
+	auto pos = tagStart + 1;
+
+	// skip the element name
+	while (pos < text.size() && !isXMLSpace(text[pos]) && text[pos] != '>' && text[pos] != '/') {
+		++pos;
+	}
+
+	while (pos < text.size()) {
+		while (pos < text.size() && isXMLSpace(text[pos])) {
+			++pos;
+		}
+
+		if (pos >= text.size() || text[pos] == '>' || text[pos] == '/') {
+			break;
+		}
+
+		const auto nameStart = pos;
+
+		while (pos < text.size() && text[pos] != '=' && !isXMLSpace(text[pos])) {
+			++pos;
+		}
+
+		const auto name = text.substr(nameStart, pos - nameStart);
+
+		while (pos < text.size() && text[pos] != '"' && text[pos] != '\'') {
+			++pos;
+		}
+
+		if (pos >= text.size()) {
+			break;
+		}
+
+		const auto quote = text[pos++];
+		const auto valueEnd = text.find(quote, pos);
+
+		if (valueEnd == std::string::npos) {
+			break;
+		}
+
+		attributes.emplace(name, decodeEntities(text.substr(pos, valueEnd - pos)));
+		pos = valueEnd + 1;
+	}
+
+	return attributes;
+}
+
+/**
+ * Finds the start of an element with exactly the given name, so that e.g. "<property" doesn't match
+ * "<properties".
+ */
+std::string::size_type findElement(const std::string &text, const char * const element,
+        std::string::size_type from = 0u) {
+	const auto elementLength = std::strlen(element);
+
+	for (auto pos = text.find(element, from); pos != std::string::npos; pos = text.find(element, pos + 1)) {
+		const auto next = pos + elementLength;
+
+		if (next < text.size() && (isXMLSpace(text[next]) || text[next] == '>' || text[next] == '/')) {
+			return pos;
+		}
+	}
+
+	return std::string::npos;
+}
+
+int32_t attributeAsInt(const AttributeMap &attributes, const std::string &name) {
+	const auto it = attributes.find(name);
+
+	return it == attributes.end() ? 0 : static_cast<int32_t>(std::strtol(it->second.c_str(), nullptr, 10));
+}
+
+std::string::size_type findHeaderEnd(const std::string &text, std::string::size_type searchFrom) {
+	auto earliest = std::string::npos;
+
+	for (const auto &terminator : HEADER_TERMINATORS) {
+		const auto pos = text.find(terminator, searchFrom);
+
+		if (pos < earliest) {
+			earliest = pos;
+		}
+	}
+
+	return earliest;
+}
+
+void parseHeader(MapHeader &header, const std::string &text, el::Logger * const logger) {
+	const auto mapStart = findElement(text, "<map");
+
+	if (mapStart == std::string::npos) {
+		header.errorText = "no <map> element found";
+		return;
+	}
+
+	const auto mapAttributes = parseAttributes(text, mapStart);
+
+	header.width = attributeAsInt(mapAttributes, "width");
+	header.height = attributeAsInt(mapAttributes, "height");
+	header.tileWidth = attributeAsInt(mapAttributes, "tilewidth");
+	header.tileHeight = attributeAsInt(mapAttributes, "tileheight");
+
+	std::string nameFromFile { "" };
+	std::string versionFromFile { "" };
+
+	const auto propertiesStart = findElement(text, "<properties", mapStart);
+
+	if (propertiesStart != std::string::npos) {
+		for (auto propPos = findElement(text, "<property", propertiesStart); propPos != std::string::npos;
+		        propPos = findElement(text, "<property", propPos + 1)) {
+			const auto propAttributes = parseAttributes(text, propPos);
+
+			const auto nameIt = propAttributes.find("name");
+			const auto valueIt = propAttributes.find("value");
+
+			if (nameIt == propAttributes.end() || valueIt == propAttributes.end()) {
+				continue;
+			}
+
+			if (nameIt->second == "PPG_NAME") {
+				nameFromFile = valueIt->second;
+			} else if (nameIt->second == "PPG_VERSION") {
+				versionFromFile = valueIt->second;
+			}
+		}
+	}
+
+	// These match Map::resolveNameFromMap and Map::resolveVersionFromMap so that the two are interchangeable.
+	if (nameFromFile == "") {
+		logger->warn("Map %v has no associated PPG_NAME", header.fileName);
+		header.name = header.fileName;
+	} else {
+		header.name = nameFromFile;
+	}
+
+	const auto version = versionFromFile == "" ? -1 : std::strtol(versionFromFile.c_str(), nullptr, 10);
+
+	if (version <= -1) {
+		logger->warn("Map %v has no associated PPG_VERSION", header.fileName);
+		header.version = 0u;
+	} else {
+		header.version = static_cast<uint32_t>(version);
+	}
+
+	header.valid = true;
+}
+
+struct CachedHash {
+	uint64_t fileSize = 0u;
+	int64_t modificationTime = 0;
+
+	bool haveDetails = false;
+	std::string hash;
+};
+
+// Read the file details before the file itself, so that a write which happens while hashing leaves a
+// stale modification time in the cache (forcing a rehash) rather than a stale hash.
+CachedHash lookupCachedHash(const std::string &fileName, MapHashCache * const cache) {
+	CachedHash ret;
+
+	if (cache != nullptr) {
+		ret.haveDetails = MapHashCache::readFileDetails(fileName, &ret.fileSize, &ret.modificationTime);
+
+		if (ret.haveDetails) {
+			ret.hash = cache->lookup(fileName);
+		}
+	}
+
+	return ret;
+}
+
+void storeHash(const std::string &fileName, MapHashCache * const cache, const CachedHash &cached,
+        const std::string &hash) {
+	if (cache != nullptr && cached.haveDetails) {
+		cache->store(fileName, cached.fileSize, cached.modificationTime, hash);
+	}
+}
+
+}
+
+constexpr const char *MapHeader::HASH_ALGORITHM;
+
+MapHeader MapHeader::scanFile(const std::string &fileName, el::Logger * const logger, MapHashCache * const cache) {
+	if (CompiledMap::hasCompiledExtension(fileName)) {
+		// compiled maps store the hash of their source, so there's nothing to cache.
+		return CompiledMap::readHeader(fileName, logger);
+	}
+
+	return MapHeader::scanTmxFile(fileName, logger, cache);
+}
+
+MapHeader MapHeader::scanTmxFile(const std::string &fileName, el::Logger * const logger,
+        MapHashCache * const cache) {
+	MapHeader header;
+	header.fileName = fileName;
+
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+
+	if (!file) {
+		header.errorText = "couldn't open file";
+		return header;
+	}
+
+	const auto cached = lookupCachedHash(fileName, cache);
+	const bool needHash = cached.hash.empty();
+
+	XXHash64 hasher;
+
+	std::array<char, SCAN_CHUNK_SIZE> chunk;
+
+	std::string headerText;
+	bool headerComplete = false;
+
+	while (file && (needHash || !headerComplete)) {
+		file.read(chunk.data(), chunk.size());
+		const auto bytesRead = static_cast<std::size_t>(file.gcount());
+
+		if (bytesRead == 0u) {
+			break;
+		}
+
+		if (needHash) {
+			hasher.update(chunk.data(), bytesRead);
+		}
+
+		if (!headerComplete) {
+			// a terminator could straddle two chunks, so back up slightly before searching.
+			const auto searchFrom = headerText.size() < 16u ? 0u : headerText.size() - 16u;
+
+			headerText.append(chunk.data(), bytesRead);
+
+			const auto headerEnd = findHeaderEnd(headerText, searchFrom);
+
+			if (headerEnd != std::string::npos) {
+				headerText.resize(headerEnd);
+				headerComplete = true;
+			} else if (headerText.size() > MAX_HEADER_SIZE) {
+				header.errorText = "map header is too large";
+				return header;
+			}
+		}
+	}
+
+	if (file.bad()) {
+		header.errorText = "error while reading file";
+		return header;
+	}
+
+	if (needHash) {
+		header.hash = XXHash64::toHex(hasher.digest());
+		storeHash(fileName, cache, cached, header.hash);
+	} else {
+		header.hash = cached.hash;
+	}
+
+	parseHeader(header, headerText, logger);
+
+	return header;
+}
+
+std::string MapHeader::hashFile(const std::string &fileName, MapHashCache * const cache) {
+	const auto cached = lookupCachedHash(fileName, cache);
+
+	if (!cached.hash.empty()) {
+		return cached.hash;
+	}
+
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+
+	if (!file) {
+		return "";
+	}
+
+	XXHash64 hasher;
+
+	std::array<char, SCAN_CHUNK_SIZE> chunk;
+
+	while (file) {
+		file.read(chunk.data(), chunk.size());
+		const auto bytesRead = static_cast<std::size_t>(file.gcount());
+
+		if (bytesRead == 0u) {
+			break;
+		}
+
+		hasher.update(chunk.data(), bytesRead);
+	}
+
+	if (file.bad()) {
+		return "";
+	}
+
+	const auto hash = XXHash64::toHex(hasher.digest());
+	storeHash(fileName, cache, cached, hash);
+
+	return hash;
+}
+
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <numeric>
+
+#include "ObjectTree.hpp"
+#include "Map.hpp"
+
+namespace PlayPG {
+
+constexpr const uint32_t ObjectTree::MAX_LEAF_SIZE;
+
+ObjectTree::ObjectTree(const std::vector<MapObject> &objects) :
+		        objectIndices_(objects.size()) {
+	if (objects.empty()) {
+		return;
+	}
+
+	std::vector<Bounds> bounds;
+	bounds.reserve(objects.size());
+
+	for (const auto &object : objects) {
+		bounds.push_back(Bounds { object.position, object.position + object.size });
+	}
+
+	std::iota(objectIndices_.begin(), objectIndices_.end(), 0u);
+
+	// A tree split at the median always has fewer than 2n nodes.
+	nodes_.reserve(2u * objects.size());
+	nodes_.emplace_back();
+	build(0u, 0u, static_cast<uint32_t>(objects.size()), bounds);
+
+	leafBounds_.reserve(objects.size());
+
+	for (const auto index : objectIndices_) {
+		leafBounds_.emplace_back(bounds[index]);
+	}
+}
+
+void ObjectTree::findContaining(const glm::vec2 &point, std::vector<uint32_t> &out) const {
+	out.clear();
+
+	forEachContaining(point, [&out](uint32_t index) {
+		out.emplace_back(index);
+	});
+
+	std::sort(out.begin(), out.end());
+}
+
+void ObjectTree::build(uint32_t nodeIndex, uint32_t first, uint32_t count, const std::vector<Bounds> &bounds) {
+	glm::vec2 min = bounds[objectIndices_[first]].min;
+	glm::vec2 max = bounds[objectIndices_[first]].max;
+	glm::vec2 centreMin = (min + max) * 0.5f;
+	glm::vec2 centreMax = centreMin;
+
+	for (uint32_t i = first + 1u; i < first + count; ++i) {
+		const auto &object = bounds[objectIndices_[i]];
+		const auto centre = (object.min + object.max) * 0.5f;
+
+		min = glm::vec2 { std::min(min.x, object.min.x), std::min(min.y, object.min.y) };
+		max = glm::vec2 { std::max(max.x, object.max.x), std::max(max.y, object.max.y) };
+		centreMin = glm::vec2 { std::min(centreMin.x, centre.x), std::min(centreMin.y, centre.y) };
+		centreMax = glm::vec2 { std::max(centreMax.x, centre.x), std::max(centreMax.y, centre.y) };
+	}
+
+	nodes_[nodeIndex].min = min;
+	nodes_[nodeIndex].max = max;
+
+	if (count <= MAX_LEAF_SIZE) {
+		nodes_[nodeIndex].first = first;
+		nodes_[nodeIndex].count = count;
+		return;
+	}
+
+	// Split at the median centre along whichever axis the centres are most spread out.
+	const bool splitX = centreMax.x - centreMin.x >= centreMax.y - centreMin.y;
+	const auto begin = objectIndices_.begin() + first;
+
+	std::nth_element(begin, begin + count / 2u, begin + count, [&bounds, splitX](uint32_t a, uint32_t b) {
+		const auto &boundsA = bounds[a];
+		const auto &boundsB = bounds[b];
+
+		return splitX ? boundsA.min.x + boundsA.max.x < boundsB.min.x + boundsB.max.x :
+		        boundsA.min.y + boundsA.max.y < boundsB.min.y + boundsB.max.y;
+	});
+
+	// Children are always next to each other, so a node only needs to store the index of the first.
+	const auto leftIndex = static_cast<uint32_t>(nodes_.size());
+	nodes_[nodeIndex].first = leftIndex;
+	nodes_[nodeIndex].count = 0u;
+
+	nodes_.emplace_back();
+	nodes_.emplace_back();
+
+	build(leftIndex, first, count / 2u, bounds);
+	build(leftIndex + 1u, first + count / 2u, count - count / 2u, bounds);
+}
+
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+
+#include "TileIndex.hpp"
+
+namespace PlayPG {
+
+constexpr const int32_t TileIndex::DEFAULT_BUCKET_SIZE;
+
+TileIndex::TileIndex() :
+		        bucketSize_ { DEFAULT_BUCKET_SIZE },
+		        bucketsWide_ { 0 },
+		        bucketsHigh_ { 0 },
+		        bucketStarts_(1u, 0u) {
+}
+
+TileIndex::TileIndex(const BitGrid &tiles, int32_t bucketSize) :
+		        bucketSize_ { std::max(bucketSize, 1) },
+		        bucketsWide_ { (static_cast<int32_t>(tiles.getWidth()) + bucketSize_ - 1) / bucketSize_ },
+		        bucketsHigh_ { (static_cast<int32_t>(tiles.getHeight()) + bucketSize_ - 1) / bucketSize_ },
+		        bucketStarts_(static_cast<std::size_t>(bucketsWide_) * bucketsHigh_ + 1u, 0u) {
+	const auto bucketOf = [this](uint32_t x, uint32_t y) {
+		return (static_cast<int32_t>(y) / bucketSize_) * bucketsWide_ + static_cast<int32_t>(x) / bucketSize_;
+	};
+
+	// Counting sort: count each bucket's tiles, turn the counts into start offsets, then place each tile.
+	tiles.forEachSet([&](uint32_t x, uint32_t y) {
+		++bucketStarts_[bucketOf(x, y) + 1];
+	});
+
+	for (std::size_t i = 1u; i < bucketStarts_.size(); ++i) {
+		bucketStarts_[i] += bucketStarts_[i - 1u];
+	}
+
+	tiles_.resize(bucketStarts_.back());
+	std::vector<uint32_t> next(bucketStarts_.begin(), bucketStarts_.end() - 1);
+
+	tiles.forEachSet([&](uint32_t x, uint32_t y) {
+		tiles_[next[bucketOf(x, y)]++] = glm::ivec2 { static_cast<int32_t>(x), static_cast<int32_t>(y) };
+	});
+}
+
+bool TileIndex::findNearest(const glm::ivec2 &from, glm::ivec2 * const nearest) const {
+	if (tiles_.empty()) {
+		return false;
+	}
+
+	const auto isBetter = [](const glm::ivec2 &tile, int64_t distance, const glm::ivec2 &best, int64_t bestDistance) {
+		return distance < bestDistance
+		        || (distance == bestDistance && (tile.y < best.y || (tile.y == best.y && tile.x < best.x)));
+	};
+
+	const int32_t fromX = std::min(std::max(from.x / bucketSize_, 0), bucketsWide_ - 1);
+	const int32_t fromY = std::min(std::max(from.y / bucketSize_, 0), bucketsHigh_ - 1);
+	const int32_t maxRing = std::max(std::max(fromX, bucketsWide_ - 1 - fromX), std::max(fromY, bucketsHigh_ - 1 - fromY));
+
+	glm::ivec2 best { 0, 0 };
+	int64_t bestDistance = -1;
+
+	// Search rings of buckets outward from the bucket containing from, stopping once no tile in the next
+	// ring could be closer than the best found so far.
+	for (int32_t ring = 0; ring <= maxRing; ++ring) {
+		if (bestDistance >= 0) {
+			const int64_t ringGap = static_cast<int64_t>(ring - 1) * bucketSize_;
+
+			if (ringGap > 0 && ringGap * ringGap > bestDistance) {
+				break;
+			}
+		}
+
+		for (int32_t by = fromY - ring; by <= fromY + ring; ++by) {
+			if (by < 0 || by >= bucketsHigh_) {
+				continue;
+			}
+
+			const bool edgeRow = by == fromY - ring || by == fromY + ring;
+			const int32_t step = edgeRow ? 1 : 2 * ring;
+
+			for (int32_t bx = fromX - ring; bx <= fromX + ring; bx += std::max(step, 1)) {
+				if (bx < 0 || bx >= bucketsWide_) {
+					continue;
+				}
+
+				const auto bucket = by * bucketsWide_ + bx;
+
+				for (auto i = bucketStarts_[bucket]; i < bucketStarts_[bucket + 1]; ++i) {
+					const auto distance = distanceSquared(tiles_[i], from);
+
+					if (bestDistance < 0 || isBetter(tiles_[i], distance, best, bestDistance)) {
+						best = tiles_[i];
+						bestDistance = distance;
+					}
+				}
+			}
+		}
+	}
+
+	*nearest = best;
+	return true;
+}
+
+}
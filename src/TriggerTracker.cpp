@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TriggerTracker.hpp"
+#include "Map.hpp"
+
+namespace PlayPG {
+
+TriggerTracker::TriggerTracker(const Map &map) :
+		        TriggerTracker(map.getObjectTree()) {
+}
+
+TriggerTracker::TriggerTracker(const ObjectTree &tree) :
+		        tree_ { tree } {
+}
+
+void TriggerTracker::update(id_type id, const glm::vec2 &position, std::vector<TriggerEvent> &events) {
+	tree_.findContaining(position, scratch_);
+
+	auto &previous = inside_[id];
+
+	if (previous == scratch_) {
+		return;
+	}
+
+	// Both lists are sorted, so a merge finds what changed.
+	auto oldIt = previous.begin();
+	auto newIt = scratch_.begin();
+
+	while (oldIt != previous.end() || newIt != scratch_.end()) {
+		if (newIt == scratch_.end() || (oldIt != previous.end() && *oldIt < *newIt)) {
+			events.push_back(TriggerEvent { id, *oldIt++, TriggerEvent::Type::EXIT });
+		} else if (oldIt == previous.end() || *newIt < *oldIt) {
+			++newIt;
+		} else {
+			++oldIt;
+			++newIt;
+		}
+	}
+
+	oldIt = previous.begin();
+	newIt = scratch_.begin();
+
+	while (newIt != scratch_.end()) {
+		if (oldIt == previous.end() || *newIt < *oldIt) {
+			events.push_back(TriggerEvent { id, *newIt++, TriggerEvent::Type::ENTER });
+		} else if (*oldIt < *newIt) {
+			++oldIt;
+		} else {
+			++oldIt;
+			++newIt;
+		}
+	}
+
+	previous.swap(scratch_);
+}
+
+void TriggerTracker::remove(id_type id, std::vector<TriggerEvent> &events) {
+	const auto found = inside_.find(id);
+
+	if (found == inside_.end()) {
+		return;
+	}
+
+	for (const auto object : found->second) {
+		events.push_back(TriggerEvent { id, object, TriggerEvent::Type::EXIT });
+	}
+
+	inside_.erase(found);
+}
+
+const std::vector<uint32_t> &TriggerTracker::getObjectsContaining(id_type id) const {
+	static const std::vector<uint32_t> none;
+
+	const auto found = inside_.find(id);
+
+	return found == inside_.end() ? none : found->second;
+}
+
+}
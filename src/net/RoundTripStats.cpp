@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "net/RoundTripStats.hpp"
+
+namespace PlayPG {
+
+void RoundTripStats::addSample(uint64_t roundTripMicros) {
+	last_ = roundTripMicros;
+
+	if (sampleCount_ == 0u) {
+		min_ = roundTripMicros;
+		smoothed_ = roundTripMicros;
+		variation_ = roundTripMicros / 2u;
+	} else {
+		if (roundTripMicros < min_) {
+			min_ = roundTripMicros;
+		}
+
+		const auto deviation = roundTripMicros > smoothed_ ? roundTripMicros - smoothed_ : smoothed_ - roundTripMicros;
+
+		// Gains of 1/4 and 1/8.
+		variation_ = (variation_ * 3u + deviation) / 4u;
+		smoothed_ = (smoothed_ * 7u + roundTripMicros) / 8u;
+	}
+
+	++sampleCount_;
+}
+
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "net/Snapshot.hpp"
+
+namespace PlayPG {
+
+namespace {
+
+enum class EntryKind
+	: uint32_t {
+		CHANGED = 0u,
+	ADDED = 1u,
+	REMOVED = 2u
+};
+
+constexpr const uint32_t ENTRY_KIND_BITS = 2u;
+
+// Most moves are a step or two, so small deltas get a short encoding.
+constexpr const int32_t SMALL_DELTA_MIN = -8;
+constexpr const int32_t SMALL_DELTA_MAX = 7;
+constexpr const uint32_t SMALL_DELTA_BITS = 4u;
+
+uint32_t bitsFor(int32_t size) {
+	uint32_t bits = 1u;
+
+	while (bits < SnapshotFormat::MAX_COORDINATE_BITS && (int64_t { 1 } << bits) < size) {
+		++bits;
+	}
+
+	return bits;
+}
+
+void writeCoordinate(BitWriter &out, int32_t value, uint32_t bits) {
+	const int32_t max = static_cast<int32_t>((uint32_t { 1u } << bits) - 1u);
+	out.write(static_cast<uint32_t>(std::min(std::max(value, 0), max)), bits);
+}
+
+void writeCoordinateChange(BitWriter &out, int32_t from, int32_t to, uint32_t bits) {
+	out.writeBool(from != to);
+
+	if (from == to) {
+		return;
+	}
+
+	const auto delta = to - from;
+
+	if (delta >= SMALL_DELTA_MIN && delta <= SMALL_DELTA_MAX) {
+		out.writeBool(true);
+		out.write(static_cast<uint32_t>(delta - SMALL_DELTA_MIN), SMALL_DELTA_BITS);
+	} else {
+		out.writeBool(false);
+		writeCoordinate(out, to, bits);
+	}
+}
+
+int32_t readCoordinateChange(BitReader &in, int32_t from, uint32_t bits) {
+	if (!in.readBool()) {
+		return from;
+	}
+
+	if (in.readBool()) {
+		return from + static_cast<int32_t>(in.read(SMALL_DELTA_BITS)) + SMALL_DELTA_MIN;
+	}
+
+	return static_cast<int32_t>(in.read(bits));
+}
+
+/**
+ * Calls func(kind, old, now) for every entity which differs between two GUID-sorted snapshots, in GUID order.
+ */
+template<typename F> void forEachDifference(const std::vector<EntityState> &baseline,
+        const std::vector<EntityState> &current, F &&func) {
+	std::size_t b = 0u;
+	std::size_t c = 0u;
+
+	while (b < baseline.size() || c < current.size()) {
+		if (c == current.size() || (b < baseline.size() && baseline[b].guid < current[c].guid)) {
+			func(EntryKind::REMOVED, baseline[b], baseline[b]);
+			++b;
+		} else if (b == baseline.size() || current[c].guid < baseline[b].guid) {
+			func(EntryKind::ADDED, current[c], current[c]);
+			++c;
+		} else {
+			if (!(baseline[b] == current[c])) {
+				func(EntryKind::CHANGED, baseline[b], current[c]);
+			}
+
+			++b;
+			++c;
+		}
+	}
+}
+
+}
+
+constexpr const uint32_t SnapshotFormat::MAX_COORDINATE_BITS;
+
+SnapshotFormat SnapshotFormat::forMapSize(int32_t widthInTiles, int32_t heightInTiles) {
+	return SnapshotFormat { bitsFor(widthInTiles), bitsFor(heightInTiles) };
+}
+
+bool SnapshotFormat::unpack(uint16_t packed, SnapshotFormat *format) {
+	const uint32_t xBits = packed >> 8u;
+	const uint32_t yBits = packed & 0xFFu;
+
+	if (xBits == 0u || xBits > MAX_COORDINATE_BITS || yBits == 0u || yBits > MAX_COORDINATE_BITS) {
+		return false;
+	}
+
+	*format = SnapshotFormat { xBits, yBits };
+	return true;
+}
+
+void encodeSnapshotDelta(const std::vector<EntityState> &baseline, const std::vector<EntityState> &current,
+        const SnapshotFormat &format, BitWriter &out) {
+	uint64_t entryCount = 0u;
+
+	forEachDifference(baseline, current, [&](EntryKind, const EntityState &, const EntityState &) {
+		++entryCount;
+	});
+
+	out.writeVarUint(entryCount);
+
+	uint64_t previousGUID = 0u;
+
+	forEachDifference(baseline, current, [&](EntryKind kind, const EntityState &old, const EntityState &now) {
+		out.writeVarUint(now.guid - previousGUID);
+		out.write(static_cast<uint32_t>(kind), ENTRY_KIND_BITS);
+
+		previousGUID = now.guid;
+
+		switch (kind) {
+		case EntryKind::ADDED: {
+			writeCoordinate(out, now.tile.x, format.xBits);
+			writeCoordinate(out, now.tile.y, format.yBits);
+			break;
+		}
+
+		case EntryKind::CHANGED: {
+			writeCoordinateChange(out, old.tile.x, now.tile.x, format.xBits);
+			writeCoordinateChange(out, old.tile.y, now.tile.y, format.yBits);
+			break;
+		}
+
+		case EntryKind::REMOVED: {
+			break;
+		}
+		}
+	});
+}
+
+bool decodeSnapshotDelta(const std::vector<EntityState> &baseline, BitReader &in, const SnapshotFormat &format,
+        std::vector<EntityState> &current) {
+	current.clear();
+
+	const auto entryCount = in.readVarUint();
+
+	uint64_t guid = 0u;
+	std::size_t b = 0u;
+
+	for (uint64_t i = 0u; i < entryCount && !in.hasOverrun(); ++i) {
+		const auto delta = in.readVarUint();
+
+		// GUIDs strictly increase, except that the first can be 0.
+		if (delta == 0u && i != 0u) {
+			return false;
+		}
+
+		guid += delta;
+
+		// Everything in the baseline before this entry is unchanged.
+		while (b < baseline.size() && baseline[b].guid < guid) {
+			current.emplace_back(baseline[b++]);
+		}
+
+		const bool inBaseline = b < baseline.size() && baseline[b].guid == guid;
+
+		switch (static_cast<EntryKind>(in.read(ENTRY_KIND_BITS))) {
+		case EntryKind::ADDED: {
+			if (inBaseline) {
+				return false;
+			}
+
+			const auto x = static_cast<int32_t>(in.read(format.xBits));
+			const auto y = static_cast<int32_t>(in.read(format.yBits));
+
+			current.emplace_back(EntityState { guid, glm::ivec2 { x, y } });
+			break;
+		}
+
+		case EntryKind::CHANGED: {
+			if (!inBaseline) {
+				return false;
+			}
+
+			const auto &old = baseline[b++];
+			const auto x = readCoordinateChange(in, old.tile.x, format.xBits);
+			const auto y = readCoordinateChange(in, old.tile.y, format.yBits);
+
+			current.emplace_back(EntityState { guid, glm::ivec2 { x, y } });
+			break;
+		}
+
+		case EntryKind::REMOVED: {
+			if (!inBaseline) {
+				return false;
+			}
+
+			++b;
+			break;
+		}
+
+		default: {
+			return false;
+		}
+		}
+	}
+
+	while (b < baseline.size()) {
+		current.emplace_back(baseline[b++]);
+	}
+
+	return !in.hasOverrun();
+}
+
+void filterSnapshot(const std::vector<EntityState> &all, const std::vector<uint64_t> &guids,
+        std::vector<EntityState> &out) {
+	out.clear();
+
+	auto state = all.begin();
+
+	for (const auto guid : guids) {
+		state = std::lower_bound(state, all.end(), guid, [](const EntityState &lhs, uint64_t rhs) {
+			return lhs.guid < rhs;
+		});
+
+		if (state == all.end()) {
+			break;
+		}
+
+		if (state->guid == guid) {
+			out.emplace_back(*state);
+		}
+	}
+}
+
+}
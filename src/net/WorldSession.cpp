@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <utility>
+
+#include "net/WorldSession.hpp"
+#include "net/packets/TimePackets.hpp"
+#include "util/Util.hpp"
+
+namespace PlayPG {
+
+constexpr const uint32_t InboundMessage::MAX_FIELDS;
+
+constexpr const uint32_t WorldSession::DEFAULT_INBOUND_CAPACITY;
+constexpr const uint32_t WorldSession::DEFAULT_OUTBOUND_CAPACITY;
+constexpr const uint32_t WorldSession::MAX_PACKETS_PER_PUMP;
+
+namespace {
+
+/**
+ * How wide each field of a client packet is on the wire, in order after the opcode.
+ * There's no length prefix, so a packet without a layout can't be skipped.
+ */
+struct MessageLayout {
+	ClientOpcode opcode;
+	uint32_t fieldCount;
+	std::array<uint8_t, InboundMessage::MAX_FIELDS> widths;
+};
+
+const MessageLayout MESSAGE_LAYOUTS[] = {
+	{ ClientOpcode::MOVE, 3u, { { 4u, 2u, 2u, 0u } } },
+	{ ClientOpcode::SNAPSHOT_ACK, 1u, { { 4u, 0u, 0u, 0u } } },
+	{ ClientOpcode::TIME_PING, 3u, { { 8u, 8u, 4u, 0u } } },
+	{ ClientOpcode::INTERACT, 3u, { { 8u, 2u, 2u, 0u } } },
+};
+
+const MessageLayout *findLayout(opcode_type_t opcode) {
+	for (const auto &layout : MESSAGE_LAYOUTS) {
+		if (util::to_integral(layout.opcode) == opcode) {
+			return &layout;
+		}
+	}
+
+	return nullptr;
+}
+
+}
+
+WorldSession::WorldSession(uint64_t guid_, std::unique_ptr<APG::Socket> &&socket, QueueFullPolicy inboundPolicy_,
+        QueueFullPolicy outboundPolicy_, uint32_t inboundCapacity, uint32_t outboundCapacity) :
+		        guid { guid_ },
+		        remoteHost { socket->remoteHost },
+		        inboundPolicy { inboundPolicy_ },
+		        outboundPolicy { outboundPolicy_ },
+		        socket_ { std::move(socket) },
+		        inbound_ { inboundCapacity },
+		        outbound_ { outboundCapacity } {
+}
+
+uint32_t WorldSession::pumpInbound(el::Logger * const logger) {
+	if (socket_ == nullptr || isClosed()) {
+		return 0u;
+	}
+
+	if (socket_->hasError()) {
+		close();
+		return 0u;
+	}
+
+	uint32_t decoded = 0u;
+
+	while (decoded < MAX_PACKETS_PER_PUMP && socket_->hasActivity()) {
+		InboundMessage message;
+
+		if (!decode(message, logger)) {
+			close();
+			break;
+		}
+
+		++decoded;
+
+		// Answered here rather than on the tick thread, so the reply isn't held up waiting for the next tick.
+		if (message.opcode == util::to_integral(ClientOpcode::TIME_PING)) {
+			answerPing(message, logger);
+			continue;
+		}
+
+		if (!inbound_.tryPush(std::move(message))) {
+			droppedInbound_.fetch_add(1u, std::memory_order_relaxed);
+
+			if (inboundPolicy == QueueFullPolicy::DISCONNECT) {
+				logger->verbose(1, "Player %v (%v) is sending faster than their map can keep up; disconnecting them.",
+				        guid, remoteHost);
+				close();
+				break;
+			}
+		}
+	}
+
+	return decoded;
+}
+
+uint32_t WorldSession::flushOutbound(el::Logger * const logger) {
+	if (socket_ == nullptr || outbound_.empty()) {
+		return 0u;
+	}
+
+	socket_->clear();
+
+	uint32_t sent = 0u;
+	std::unique_ptr<Packet> packet;
+
+	while (outbound_.tryPop(packet)) {
+		socket_->put(&packet->buffer);
+		++sent;
+	}
+
+	if (socket_->send() == 0) {
+		logger->verbose(1, "Couldn't send to player %v (%v); disconnecting them.", guid, remoteHost);
+		close();
+	}
+
+	return sent;
+}
+
+void WorldSession::releaseSocket() {
+	if (isClosed()) {
+		socket_ = nullptr;
+	}
+}
+
+bool WorldSession::receive(InboundMessage &message) {
+	return inbound_.tryPop(message);
+}
+
+bool WorldSession::send(std::unique_ptr<Packet> &&packet) {
+	if (isClosed()) {
+		return false;
+	}
+
+	if (outbound_.tryPush(std::move(packet))) {
+		return true;
+	}
+
+	droppedOutbound_.fetch_add(1u, std::memory_order_relaxed);
+
+	if (outboundPolicy == QueueFullPolicy::DISCONNECT) {
+		// The client isn't reading; queueing more would only grow without bound.
+		close();
+	}
+
+	return false;
+}
+
+void WorldSession::answerPing(const InboundMessage &ping, el::Logger * const logger) {
+	const auto receivedAt = util::monotonicMicros();
+	const auto echoedServerTime = ping.fields[1];
+	const auto heldMicros = ping.fields[2];
+
+	// Only trust an echo of the last pong we actually sent.
+	if (echoedServerTime != 0u && echoedServerTime == lastPongSentAt_ && receivedAt > echoedServerTime + heldMicros) {
+		roundTrip_.addSample(receivedAt - echoedServerTime - heldMicros);
+
+		smoothedRoundTrip_.store(roundTrip_.getSmoothed(), std::memory_order_relaxed);
+		roundTripVariation_.store(roundTrip_.getVariation(), std::memory_order_relaxed);
+		minRoundTrip_.store(roundTrip_.getMin(), std::memory_order_relaxed);
+	}
+
+	lastPongSentAt_ = util::monotonicMicros();
+	TimePongPacket pong(ping.fields[0], receivedAt, lastPongSentAt_);
+
+	socket_->clear();
+	socket_->put(&pong.buffer);
+
+	if (socket_->send() == 0) {
+		logger->verbose(1, "Couldn't send to player %v (%v); disconnecting them.", guid, remoteHost);
+		close();
+	}
+}
+
+bool WorldSession::decode(InboundMessage &message, el::Logger * const logger) {
+	socket_->clear();
+
+	const auto opcodeBytes = socket_->recv(2);
+
+	if (opcodeBytes != 2) {
+		logger->verbose(1, "Couldn't read an opcode from player %v (%v); got %v bytes.", guid, remoteHost,
+		        opcodeBytes);
+		return false;
+	}
+
+	message.opcode = socket_->getShort();
+
+	const auto layout = findLayout(message.opcode);
+
+	if (layout == nullptr) {
+		logger->verbose(1, "Player %v (%v) sent unexpected opcode %v; can't find the next packet after it.", guid,
+		        remoteHost, message.opcode);
+		return false;
+	}
+
+	for (uint32_t i = 0u; i < layout->fieldCount; ++i) {
+		const int width = layout->widths[i];
+
+		if (socket_->recv(width) != width) {
+			logger->verbose(1, "Player %v (%v) sent a truncated packet with opcode %v.", guid, remoteHost,
+			        message.opcode);
+			return false;
+		}
+
+		switch (width) {
+		case 2: {
+			message.fields[i] = socket_->getShort();
+			break;
+		}
+
+		case 4: {
+			message.fields[i] = socket_->getInt();
+			break;
+		}
+
+		default: {
+			message.fields[i] = socket_->getLong();
+			break;
+		}
+		}
+	}
+
+	return true;
+}
+
+}
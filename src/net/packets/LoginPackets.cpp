@@ -128,6 +128,16 @@ MapServerMapList MapServerMapList::listFromMaps(const std::vector<Map> &maps) {
 	return MapServerMapList(std::move(ids));
 }
 
+MapServerMapUpdate::MapServerMapUpdate(const std::vector<Location> &updatedMaps_) :
+		        ServerPacket(ServerOpcode::MAP_SERVER_MAP_UPDATE),
+		        updatedMaps { updatedMaps_ } {
+	APG::JSONSerializer<MapServerMapList> toJson;
+	const std::string jsonString = toJson.toJSON(MapServerMapList(updatedMaps));
+
+	buffer.putShort(jsonString.size());
+	buffer.putString(jsonString);
+}
+
 MapServerConnectionInstructions::MapServerConnectionInstructions(const std::string &friendlyName_,
         const std::string &hostName_, const uint16_t &port_) :
 		        ServerPacket(ServerOpcode::MAP_SERVER_CONNECTION_INSTRUCTIONS),
@@ -25,25 +25,16 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <openssl/md5.h>
-
 #include "Location.hpp"
-#include "util/Util.hpp"
+#include "MapHeader.hpp"
 
 namespace PlayPG {
 
 Location::Location(const Map &map) :
-		        Location(map.getName(), map.getTmxMap()->GetFilename(),
-		                Location::makeMD5Hash(map.getTmxMap()->GetFilehash()), map.getVersion()) {
-
-}
-
-std::string Location::makeMD5Hash(const std::string &base64Hash) {
-	uint8_t buffer[MD5_DIGEST_LENGTH];
-
-	::MD5(reinterpret_cast<const uint8_t *>(base64Hash.c_str()), base64Hash.size(), buffer);
+		        Location(map.getName(), map.getFileName(),
+		                map.getSourceHash() == "" ? MapHeader::hashFile(map.getFileName()) : map.getSourceHash(),
+		                map.getVersion()) {
 
-	return ByteArrayUtil::byteArrayToString(buffer, MD5_DIGEST_LENGTH);
 }
 
 }
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <functional>
+
+#include "pathfinding/GridSearch.hpp"
+
+namespace PlayPG {
+
+void BoundedDijkstra::run(const BitGrid &solid, const TileRect &bounds, const glm::ivec2 &source) {
+	const int32_t x0 = std::max(bounds.x, 0);
+	const int32_t y0 = std::max(bounds.y, 0);
+	const int32_t x1 = std::min(bounds.x + bounds.w, static_cast<int32_t>(solid.getWidth()));
+	const int32_t y1 = std::min(bounds.y + bounds.h, static_cast<int32_t>(solid.getHeight()));
+
+	bounds_ = TileRect { x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0) };
+
+	costs_.assign(static_cast<std::size_t>(bounds_.w) * bounds_.h, pathcost::UNREACHABLE);
+	open_.clear();
+
+	const auto walkable = [&](int32_t x, int32_t y) {
+		return bounds_.contains(x, y) && !solid.get(x, y);
+	};
+
+	if (!walkable(source.x, source.y)) {
+		return;
+	}
+
+	const auto sourceIndex = (source.y - bounds_.y) * bounds_.w + (source.x - bounds_.x);
+	costs_[sourceIndex] = 0.0f;
+	open_.emplace_back(0.0f, sourceIndex);
+
+	const auto compare = std::greater<std::pair<float, int32_t>>();
+
+	while (!open_.empty()) {
+		std::pop_heap(open_.begin(), open_.end(), compare);
+		const auto current = open_.back();
+		open_.pop_back();
+
+		if (current.first > costs_[current.second]) {
+			// stale entry; a cheaper route to this tile was found after it was queued.
+			continue;
+		}
+
+		const int32_t x = bounds_.x + current.second % bounds_.w;
+		const int32_t y = bounds_.y + current.second / bounds_.w;
+
+		for (int32_t dy = -1; dy <= 1; ++dy) {
+			for (int32_t dx = -1; dx <= 1; ++dx) {
+				if ((dx == 0 && dy == 0) || !walkable(x + dx, y + dy)) {
+					continue;
+				}
+
+				const bool diagonal = dx != 0 && dy != 0;
+
+				if (diagonal && !(walkable(x + dx, y) && walkable(x, y + dy))) {
+					continue;
+				}
+
+				const float cost = current.first + (diagonal ? pathcost::DIAGONAL : pathcost::STRAIGHT);
+				const auto index = current.second + dy * bounds_.w + dx;
+
+				if (cost < costs_[index]) {
+					costs_[index] = cost;
+					open_.emplace_back(cost, index);
+					std::push_heap(open_.begin(), open_.end(), compare);
+				}
+			}
+		}
+	}
+}
+
+}
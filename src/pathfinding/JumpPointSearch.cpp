@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <functional>
+
+#include "pathfinding/JumpPointSearch.hpp"
+
+namespace PlayPG {
+
+namespace {
+
+inline int32_t sign(int32_t value) {
+	return (value > 0) - (value < 0);
+}
+
+const auto OPEN_COMPARE = std::greater<std::pair<float, int32_t>>();
+
+}
+
+JumpPointSearch::JumpPointSearch(const BitGrid &solid) {
+	setGrid(solid);
+}
+
+void JumpPointSearch::setGrid(const BitGrid &solid) {
+	solid_ = &solid;
+
+	if (width_ != static_cast<int32_t>(solid.getWidth()) || height_ != static_cast<int32_t>(solid.getHeight())) {
+		width_ = static_cast<int32_t>(solid.getWidth());
+		height_ = static_cast<int32_t>(solid.getHeight());
+
+		const auto tileCount = static_cast<std::size_t>(width_) * height_;
+
+		stamps_.assign(tileCount, 0u);
+		costs_.assign(tileCount, 0.0f);
+		parents_.assign(tileCount, -1);
+		generation_ = 0u;
+	}
+}
+
+bool JumpPointSearch::findPath(const glm::ivec2 &start, const glm::ivec2 &goal, std::vector<glm::ivec2> &path) {
+	return findPathWithin(start, goal, TileRect { 0, 0, width_, height_ }, path);
+}
+
+bool JumpPointSearch::findPathWithin(const glm::ivec2 &start, const glm::ivec2 &goal, const TileRect &bounds,
+        std::vector<glm::ivec2> &path) {
+	path.clear();
+	lastPathCost_ = 0.0f;
+	lastExpandedCount_ = 0u;
+
+	const int32_t x0 = std::max(bounds.x, 0);
+	const int32_t y0 = std::max(bounds.y, 0);
+	const int32_t x1 = std::min(bounds.x + bounds.w, width_);
+	const int32_t y1 = std::min(bounds.y + bounds.h, height_);
+
+	bounds_ = TileRect { x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0) };
+	goal_ = goal;
+
+	if (!isWalkable(start.x, start.y) || !isWalkable(goal.x, goal.y)) {
+		return false;
+	}
+
+	startGeneration();
+	open_.clear();
+
+	const auto startIndex = indexOf(start.x, start.y);
+	const auto goalIndex = indexOf(goal.x, goal.y);
+
+	stamps_[startIndex] = generation_;
+	costs_[startIndex] = 0.0f;
+	parents_[startIndex] = -1;
+	open_.emplace_back(pathcost::octile(start, goal), startIndex);
+
+	while (!open_.empty()) {
+		std::pop_heap(open_.begin(), open_.end(), OPEN_COMPARE);
+		const auto current = open_.back();
+		open_.pop_back();
+
+		const auto index = current.second;
+
+		if (stamps_[index] != generation_) {
+			// already closed through a cheaper entry.
+			continue;
+		}
+
+		stamps_[index] = generation_ + 1u;
+		++lastExpandedCount_;
+
+		if (index == goalIndex) {
+			lastPathCost_ = costs_[index];
+			buildPath(goalIndex, path);
+			return true;
+		}
+
+		addSuccessors(index % width_, index / width_, parents_[index]);
+	}
+
+	return false;
+}
+
+void JumpPointSearch::startGeneration() {
+	generation_ += 2u;
+
+	if (generation_ == 0u) {
+		// wrapped around; old stamps could now look current.
+		std::fill(stamps_.begin(), stamps_.end(), 0u);
+		generation_ = 2u;
+	}
+}
+
+void JumpPointSearch::addSuccessors(int32_t x, int32_t y, int32_t parentIndex) {
+	const auto fromIndex = indexOf(x, y);
+	const glm::ivec2 from { x, y };
+
+	if (parentIndex < 0) {
+		// The start tile: every walkable neighbour.
+		for (int32_t dy = -1; dy <= 1; ++dy) {
+			for (int32_t dx = -1; dx <= 1; ++dx) {
+				if (dx != 0 || dy != 0) {
+					considerSuccessor(fromIndex, from, dx, dy);
+				}
+			}
+		}
+
+		return;
+	}
+
+	const int32_t dx = sign(x - parentIndex % width_);
+	const int32_t dy = sign(y - parentIndex / width_);
+
+	// Natural and forced neighbours for travel in direction (dx, dy). Corners can't be cut, so the only
+	// forced neighbours of a straight move are the tiles either side of it.
+	if (dx != 0 && dy != 0) {
+		considerSuccessor(fromIndex, from, 0, dy);
+		considerSuccessor(fromIndex, from, dx, 0);
+		considerSuccessor(fromIndex, from, dx, dy);
+	} else if (dx != 0) {
+		considerSuccessor(fromIndex, from, dx, 0);
+		considerSuccessor(fromIndex, from, dx, 1);
+		considerSuccessor(fromIndex, from, dx, -1);
+		considerSuccessor(fromIndex, from, 0, 1);
+		considerSuccessor(fromIndex, from, 0, -1);
+	} else {
+		considerSuccessor(fromIndex, from, 0, dy);
+		considerSuccessor(fromIndex, from, 1, dy);
+		considerSuccessor(fromIndex, from, -1, dy);
+		considerSuccessor(fromIndex, from, 1, 0);
+		considerSuccessor(fromIndex, from, -1, 0);
+	}
+}
+
+void JumpPointSearch::considerSuccessor(int32_t fromIndex, const glm::ivec2 &from, int32_t dx, int32_t dy) {
+	if (!isWalkable(from.x + dx, from.y + dy)) {
+		return;
+	}
+
+	if (dx != 0 && dy != 0 && !(isWalkable(from.x + dx, from.y) && isWalkable(from.x, from.y + dy))) {
+		return;
+	}
+
+	glm::ivec2 jumpPoint;
+
+	if (!jump(from.x + dx, from.y + dy, dx, dy, &jumpPoint)) {
+		return;
+	}
+
+	const auto index = indexOf(jumpPoint.x, jumpPoint.y);
+
+	if (stamps_[index] == generation_ + 1u) {
+		return;
+	}
+
+	const float cost = costs_[fromIndex] + pathcost::octile(from, jumpPoint);
+
+	if (stamps_[index] != generation_ || cost < costs_[index]) {
+		stamps_[index] = generation_;
+		costs_[index] = cost;
+		parents_[index] = fromIndex;
+
+		open_.emplace_back(cost + pathcost::octile(jumpPoint, goal_), index);
+		std::push_heap(open_.begin(), open_.end(), OPEN_COMPARE);
+	}
+}
+
+bool JumpPointSearch::jump(int32_t x, int32_t y, int32_t dx, int32_t dy, glm::ivec2 * jumpPoint) const {
+	while (true) {
+		if (!isWalkable(x, y)) {
+			return false;
+		}
+
+		if (x == goal_.x && y == goal_.y) {
+			*jumpPoint = glm::ivec2 { x, y };
+			return true;
+		}
+
+		if (dx != 0 && dy != 0) {
+			glm::ivec2 unused;
+
+			if (jump(x + dx, y, dx, 0, &unused) || jump(x, y + dy, 0, dy, &unused)) {
+				*jumpPoint = glm::ivec2 { x, y };
+				return true;
+			}
+
+			if (!(isWalkable(x + dx, y) && isWalkable(x, y + dy))) {
+				return false;
+			}
+		} else if (dx != 0) {
+			if ((isWalkable(x, y - 1) && !isWalkable(x - dx, y - 1))
+			        || (isWalkable(x, y + 1) && !isWalkable(x - dx, y + 1))) {
+				*jumpPoint = glm::ivec2 { x, y };
+				return true;
+			}
+		} else {
+			if ((isWalkable(x - 1, y) && !isWalkable(x - 1, y - dy))
+			        || (isWalkable(x + 1, y) && !isWalkable(x + 1, y - dy))) {
+				*jumpPoint = glm::ivec2 { x, y };
+				return true;
+			}
+		}
+
+		x += dx;
+		y += dy;
+	}
+}
+
+void JumpPointSearch::buildPath(int32_t goalIndex, std::vector<glm::ivec2> &path) {
+	// Walk back through the jump points, filling in the straight or diagonal runs between them.
+	for (auto index = goalIndex; index >= 0; index = parents_[index]) {
+		const glm::ivec2 point { index % width_, index / width_ };
+		const auto parentIndex = parents_[index];
+
+		path.emplace_back(point);
+
+		if (parentIndex < 0) {
+			break;
+		}
+
+		const glm::ivec2 parent { parentIndex % width_, parentIndex / width_ };
+		const glm::ivec2 step { sign(parent.x - point.x), sign(parent.y - point.y) };
+
+		for (auto tile = point + step; tile != parent; tile = tile + step) {
+			path.emplace_back(tile);
+		}
+	}
+
+	std::reverse(path.begin(), path.end());
+}
+
+}
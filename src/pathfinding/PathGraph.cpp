@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "pathfinding/PathGraph.hpp"
+
+namespace PlayPG {
+
+constexpr const int32_t PathGraph::DEFAULT_CLUSTER_SIZE;
+constexpr const int32_t PathGraph::WIDE_ENTRANCE_SIZE;
+
+PathGraph::PathGraph(const BitGrid &solid, int32_t clusterSize) :
+		        solid_ { solid },
+		        width_ { static_cast<int32_t>(solid.getWidth()) },
+		        height_ { static_cast<int32_t>(solid.getHeight()) },
+		        clusterSize_ { std::max(clusterSize, 2) },
+		        clustersWide_ { std::max((width_ + clusterSize_ - 1) / clusterSize_, 1) },
+		        clustersHigh_ { std::max((height_ + clusterSize_ - 1) / clusterSize_, 1) },
+		        clusterNodes_(static_cast<std::size_t>(clustersWide_) * clustersHigh_),
+		        eastTransitions_(clusterNodes_.size()),
+		        southTransitions_(clusterNodes_.size()) {
+	rebuildClusters(std::vector<bool>(clusterNodes_.size(), true));
+}
+
+std::unique_ptr<PathGraph> PathGraph::updatedFor(const BitGrid &newSolid) const {
+	if (newSolid.getWidth() != solid_.getWidth() || newSolid.getHeight() != solid_.getHeight()) {
+		return std::make_unique<PathGraph>(newSolid, clusterSize_);
+	}
+
+	std::vector<bool> dirty(clusterNodes_.size(), false);
+
+	for (uint32_t y = 0u; y < newSolid.getHeight(); ++y) {
+		const auto oldRow = solid_.getRow(y);
+		const auto newRow = newSolid.getRow(y);
+		const auto clusterRow = static_cast<int32_t>(y) / clusterSize_ * clustersWide_;
+
+		for (uint32_t w = 0u; w < newSolid.getWordsPerRow(); ++w) {
+			uint64_t changed = oldRow[w] ^ newRow[w];
+
+			while (changed != 0u) {
+				const auto x = static_cast<int32_t>(w * BitGrid::BITS_PER_WORD) + util::countTrailingZeros(changed);
+				dirty[clusterRow + x / clusterSize_] = true;
+				changed &= changed - 1u;
+			}
+		}
+	}
+
+	// can't use make_unique with a private copy constructor.
+	std::unique_ptr<PathGraph> ret(new PathGraph(*this));
+	ret->solid_ = newSolid;
+	ret->rebuildClusters(dirty);
+
+	return ret;
+}
+
+TileRect PathGraph::getClusterBounds(uint32_t cluster) const {
+	const int32_t x = static_cast<int32_t>(cluster) % clustersWide_ * clusterSize_;
+	const int32_t y = static_cast<int32_t>(cluster) / clustersWide_ * clusterSize_;
+
+	return TileRect { x, y, std::min(clusterSize_, width_ - x), std::min(clusterSize_, height_ - y) };
+}
+
+uint32_t PathGraph::getLiveNodeCount() const {
+	return static_cast<uint32_t>(nodes_.size() - freeNodes_.size());
+}
+
+std::size_t PathGraph::getEdgeCount() const {
+	std::size_t count = 0u;
+
+	for (const auto &node : nodes_) {
+		count += node.edges.size();
+	}
+
+	return count;
+}
+
+void PathGraph::rebuildClusters(const std::vector<bool> &dirty) {
+	const auto clusterCount = static_cast<int32_t>(clusterNodes_.size());
+
+	std::vector<bool> eastAffected(clusterCount, false);
+	std::vector<bool> southAffected(clusterCount, false);
+	std::vector<bool> touched(clusterCount, false);
+
+	for (int32_t cluster = 0; cluster < clusterCount; ++cluster) {
+		if (!dirty[cluster]) {
+			continue;
+		}
+
+		const int32_t cx = cluster % clustersWide_;
+		const int32_t cy = cluster / clustersWide_;
+
+		touched[cluster] = true;
+
+		if (cx + 1 < clustersWide_) {
+			eastAffected[cluster] = true;
+			touched[cluster + 1] = true;
+		}
+
+		if (cx > 0) {
+			eastAffected[cluster - 1] = true;
+			touched[cluster - 1] = true;
+		}
+
+		if (cy + 1 < clustersHigh_) {
+			southAffected[cluster] = true;
+			touched[cluster + clustersWide_] = true;
+		}
+
+		if (cy > 0) {
+			southAffected[cluster - clustersWide_] = true;
+			touched[cluster - clustersWide_] = true;
+		}
+	}
+
+	for (int32_t cluster = 0; cluster < clusterCount; ++cluster) {
+		if (eastAffected[cluster]) {
+			clearTransitions(eastTransitions_[cluster]);
+		}
+
+		if (southAffected[cluster]) {
+			clearTransitions(southTransitions_[cluster]);
+		}
+	}
+
+	for (int32_t cluster = 0; cluster < clusterCount; ++cluster) {
+		if (eastAffected[cluster]) {
+			findTransitions(cluster, true);
+		}
+
+		if (southAffected[cluster]) {
+			findTransitions(cluster, false);
+		}
+	}
+
+	BoundedDijkstra search;
+	rebuiltClusterCount_ = 0u;
+
+	for (int32_t cluster = 0; cluster < clusterCount; ++cluster) {
+		if (!touched[cluster]) {
+			continue;
+		}
+
+		// nodes which lost all their transitions are no longer needed.
+		const auto nodesCopy = clusterNodes_[cluster];
+
+		for (const auto node : nodesCopy) {
+			if (nodes_[node].transitionCount == 0u) {
+				freeNode(node);
+			}
+		}
+
+		connectClusterNodes(cluster, search);
+		++rebuiltClusterCount_;
+	}
+}
+
+void PathGraph::clearTransitions(std::vector<std::pair<uint32_t, uint32_t>> &transitions) {
+	const auto removeInterEdge = [this](uint32_t from, uint32_t to) {
+		auto &edges = nodes_[from].edges;
+
+		edges.erase(std::remove_if(edges.begin(), edges.end(), [to](const Edge &edge) {
+			return edge.inter && edge.to == to;
+		}), edges.end());
+
+		--nodes_[from].transitionCount;
+	};
+
+	for (const auto &transition : transitions) {
+		removeInterEdge(transition.first, transition.second);
+		removeInterEdge(transition.second, transition.first);
+	}
+
+	transitions.clear();
+}
+
+void PathGraph::findTransitions(uint32_t cluster, bool east) {
+	const auto bounds = getClusterBounds(cluster);
+	auto &transitions = east ? eastTransitions_[cluster] : southTransitions_[cluster];
+
+	// Walk along the border, finding runs where both sides are walkable.
+	const int32_t length = east ? bounds.h : bounds.w;
+	const glm::ivec2 origin = east ? glm::ivec2 { bounds.x + bounds.w - 1, bounds.y } : glm::ivec2 { bounds.x, bounds.y
+	        + bounds.h - 1 };
+	const glm::ivec2 along = east ? glm::ivec2 { 0, 1 } : glm::ivec2 { 1, 0 };
+	const glm::ivec2 across = east ? glm::ivec2 { 1, 0 } : glm::ivec2 { 0, 1 };
+
+	int32_t runStart = -1;
+
+	for (int32_t i = 0; i <= length; ++i) {
+		const auto inside = origin + along * i;
+		const auto outside = inside + across;
+
+		const bool open = i < length && isWalkable(inside.x, inside.y) && isWalkable(outside.x, outside.y);
+
+		if (open && runStart < 0) {
+			runStart = i;
+		} else if (!open && runStart >= 0) {
+			const int32_t runEnd = i - 1;
+
+			if (runEnd - runStart + 1 >= WIDE_ENTRANCE_SIZE) {
+				addTransition(origin + along * runStart, origin + along * runStart + across, transitions);
+				addTransition(origin + along * runEnd, origin + along * runEnd + across, transitions);
+			} else {
+				const int32_t middle = (runStart + runEnd) / 2;
+				addTransition(origin + along * middle, origin + along * middle + across, transitions);
+			}
+
+			runStart = -1;
+		}
+	}
+}
+
+void PathGraph::addTransition(const glm::ivec2 &a, const glm::ivec2 &b,
+        std::vector<std::pair<uint32_t, uint32_t>> &transitions) {
+	const auto nodeA = getOrCreateNode(a);
+	const auto nodeB = getOrCreateNode(b);
+
+	nodes_[nodeA].edges.emplace_back(Edge { nodeB, pathcost::STRAIGHT, true });
+	nodes_[nodeB].edges.emplace_back(Edge { nodeA, pathcost::STRAIGHT, true });
+
+	++nodes_[nodeA].transitionCount;
+	++nodes_[nodeB].transitionCount;
+
+	transitions.emplace_back(nodeA, nodeB);
+}
+
+uint32_t PathGraph::getOrCreateNode(const glm::ivec2 &tile) {
+	const auto key = tile.y * width_ + tile.x;
+	const auto existing = nodeAtTile_.find(key);
+
+	if (existing != nodeAtTile_.end()) {
+		return existing->second;
+	}
+
+	uint32_t id;
+
+	if (freeNodes_.empty()) {
+		id = static_cast<uint32_t>(nodes_.size());
+		nodes_.emplace_back();
+	} else {
+		id = freeNodes_.back();
+		freeNodes_.pop_back();
+	}
+
+	auto &node = nodes_[id];
+	node.tile = tile;
+	node.cluster = clusterAt(tile);
+	node.edges.clear();
+	node.transitionCount = 0u;
+	node.alive = true;
+
+	nodeAtTile_.emplace(key, id);
+	clusterNodes_[node.cluster].emplace_back(id);
+
+	return id;
+}
+
+void PathGraph::freeNode(uint32_t id) {
+	auto &node = nodes_[id];
+	auto &siblings = clusterNodes_[node.cluster];
+
+	siblings.erase(std::remove(siblings.begin(), siblings.end(), id), siblings.end());
+	nodeAtTile_.erase(node.tile.y * width_ + node.tile.x);
+
+	node.edges.clear();
+	node.alive = false;
+
+	freeNodes_.emplace_back(id);
+}
+
+void PathGraph::connectClusterNodes(uint32_t cluster, BoundedDijkstra &search) {
+	const auto bounds = getClusterBounds(cluster);
+	const auto &clusterNodes = clusterNodes_[cluster];
+
+	for (const auto id : clusterNodes) {
+		auto &edges = nodes_[id].edges;
+
+		edges.erase(std::remove_if(edges.begin(), edges.end(), [](const Edge &edge) {
+			return !edge.inter;
+		}), edges.end());
+	}
+
+	for (const auto from : clusterNodes) {
+		search.run(solid_, bounds, nodes_[from].tile);
+
+		for (const auto to : clusterNodes) {
+			if (to == from) {
+				continue;
+			}
+
+			const auto cost = search.costTo(nodes_[to].tile);
+
+			if (cost != pathcost::UNREACHABLE) {
+				nodes_[from].edges.emplace_back(Edge { to, cost, false });
+			}
+		}
+	}
+}
+
+}
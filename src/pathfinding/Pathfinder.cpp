@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <functional>
+
+#include "pathfinding/Pathfinder.hpp"
+
+namespace PlayPG {
+
+Pathfinder::Pathfinder(std::shared_ptr<const PathGraph> graph) :
+		        graph_ { std::move(graph) },
+		        jps_ { graph_->getSolidGrid() } {
+}
+
+void Pathfinder::setGraph(std::shared_ptr<const PathGraph> graph) {
+	graph_ = std::move(graph);
+	jps_.setGrid(graph_->getSolidGrid());
+}
+
+bool Pathfinder::findPath(const glm::ivec2 &start, const glm::ivec2 &goal, std::vector<glm::ivec2> &path) {
+	const auto distance = std::max(std::abs(start.x - goal.x), std::abs(start.y - goal.y));
+
+	if (distance <= graph_->getClusterSize() || graph_->clusterAt(start) == graph_->clusterAt(goal)) {
+		return findShortPath(start, goal, path);
+	}
+
+	return findLongPath(start, goal, path);
+}
+
+bool Pathfinder::findShortPath(const glm::ivec2 &start, const glm::ivec2 &goal, std::vector<glm::ivec2> &path) {
+	const bool found = jps_.findPath(start, goal, path);
+	lastPathCost_ = found ? jps_.getLastPathCost() : pathcost::UNREACHABLE;
+
+	return found;
+}
+
+bool Pathfinder::findLongPath(const glm::ivec2 &start, const glm::ivec2 &goal, std::vector<glm::ivec2> &path) {
+	path.clear();
+	lastPathCost_ = pathcost::UNREACHABLE;
+
+	const auto &solid = graph_->getSolidGrid();
+	const auto inGrid = [&solid](const glm::ivec2 &tile) {
+		return tile.x >= 0 && tile.y >= 0 && static_cast<uint32_t>(tile.x) < solid.getWidth()
+		        && static_cast<uint32_t>(tile.y) < solid.getHeight();
+	};
+
+	if (!inGrid(start) || !inGrid(goal) || solid.get(start.x, start.y) || solid.get(goal.x, goal.y)) {
+		return false;
+	}
+
+	if (!searchAbstract(start, goal, nodePath_)) {
+		return false;
+	}
+
+	// Refine the abstract path: consecutive nodes in the same cluster are joined with a search confined to
+	// that cluster, and inter-cluster edges are always a single step.
+	float totalCost = 0.0f;
+	path.emplace_back(start);
+
+	for (std::size_t i = 1u; i < nodePath_.size(); ++i) {
+		const auto from = abstractTile(nodePath_[i - 1u]);
+		const auto to = abstractTile(nodePath_[i]);
+
+		if (from == to) {
+			continue;
+		}
+
+		const auto fromCluster = graph_->clusterAt(from);
+
+		if (fromCluster != graph_->clusterAt(to)) {
+			path.emplace_back(to);
+			totalCost += pathcost::STRAIGHT;
+			continue;
+		}
+
+		if (!jps_.findPathWithin(from, to, graph_->getClusterBounds(fromCluster), segment_)) {
+			// can't happen unless the graph doesn't match its grid.
+			path.clear();
+			return false;
+		}
+
+		path.insert(path.end(), segment_.begin() + 1, segment_.end());
+		totalCost += jps_.getLastPathCost();
+	}
+
+	lastPathCost_ = totalCost;
+	return true;
+}
+
+bool Pathfinder::searchAbstract(const glm::ivec2 &start, const glm::ivec2 &goal, std::vector<uint32_t> &nodePath) {
+	nodePath.clear();
+
+	const auto slotCount = graph_->getNodeSlotCount();
+	startNode_ = slotCount;
+	goalNode_ = slotCount + 1u;
+	start_ = start;
+	goal_ = goal;
+
+	if (stamps_.size() < slotCount + 2u) {
+		stamps_.resize(slotCount + 2u, 0u);
+		costs_.resize(slotCount + 2u);
+		parents_.resize(slotCount + 2u);
+	}
+
+	if (++generation_ == 0u) {
+		std::fill(stamps_.begin(), stamps_.end(), 0u);
+		generation_ = 1u;
+	}
+
+	linkToCluster(start, startLinks_);
+	linkToCluster(goal, goalLinks_);
+
+	// clusterSearch_ still holds the costs from the goal, which covers a start in the same cluster.
+	const float directCost = clusterSearch_.costTo(start);
+
+	// Costs are symmetric, so the goal's links double as edges from its cluster's nodes to the goal.
+	const auto goalCluster = graph_->clusterAt(goal);
+	const auto goalLinkCost = [this](uint32_t node) {
+		for (const auto &link : goalLinks_) {
+			if (link.first == node) {
+				return link.second;
+			}
+		}
+
+		return pathcost::UNREACHABLE;
+	};
+
+	open_.clear();
+
+	const auto push = [this](uint32_t node, uint32_t parent, float cost) {
+		if (stamps_[node] == generation_ && costs_[node] <= cost) {
+			return;
+		}
+
+		stamps_[node] = generation_;
+		costs_[node] = cost;
+		parents_[node] = parent;
+
+		open_.emplace_back(cost + pathcost::octile(abstractTile(node), goal_), node);
+		std::push_heap(open_.begin(), open_.end(), std::greater<std::pair<float, uint32_t>>());
+	};
+
+	push(startNode_, startNode_, 0.0f);
+
+	if (directCost != pathcost::UNREACHABLE) {
+		push(goalNode_, startNode_, directCost);
+	}
+
+	while (!open_.empty()) {
+		std::pop_heap(open_.begin(), open_.end(), std::greater<std::pair<float, uint32_t>>());
+		const auto current = open_.back();
+		open_.pop_back();
+
+		const auto node = current.second;
+		const auto cost = costs_[node];
+
+		if (current.first > cost + pathcost::octile(abstractTile(node), goal_)) {
+			// stale entry
+			continue;
+		}
+
+		if (node == goalNode_) {
+			for (auto at = goalNode_; at != startNode_; at = parents_[at]) {
+				nodePath.emplace_back(at);
+			}
+
+			nodePath.emplace_back(startNode_);
+			std::reverse(nodePath.begin(), nodePath.end());
+
+			return true;
+		}
+
+		if (node == startNode_) {
+			for (const auto &link : startLinks_) {
+				push(link.first, node, link.second);
+			}
+
+			continue;
+		}
+
+		for (const auto &edge : graph_->getNode(node).edges) {
+			push(edge.to, node, cost + edge.cost);
+		}
+
+		if (graph_->getNode(node).cluster == goalCluster) {
+			const auto toGoal = goalLinkCost(node);
+
+			if (toGoal != pathcost::UNREACHABLE) {
+				push(goalNode_, node, cost + toGoal);
+			}
+		}
+	}
+
+	return false;
+}
+
+void Pathfinder::linkToCluster(const glm::ivec2 &tile, std::vector<std::pair<uint32_t, float>> &links) {
+	links.clear();
+
+	const auto cluster = graph_->clusterAt(tile);
+	clusterSearch_.run(graph_->getSolidGrid(), graph_->getClusterBounds(cluster), tile);
+
+	for (const auto node : graph_->getClusterNodes(cluster)) {
+		const auto cost = clusterSearch_.costTo(graph_->getNode(node).tile);
+
+		if (cost != pathcost::UNREACHABLE) {
+			links.emplace_back(node, cost);
+		}
+	}
+}
+
+glm::ivec2 Pathfinder::abstractTile(uint32_t node) const {
+	if (node == startNode_) {
+		return start_;
+	} else if (node == goalNode_) {
+		return goal_;
+	}
+
+	return graph_->getNode(node).tile;
+}
+
+}
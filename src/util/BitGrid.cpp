@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdint>
+
+#include <algorithm>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define PLAYPG_BITGRID_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "util/BitGrid.hpp"
+
+namespace PlayPG {
+
+constexpr const uint32_t BitGrid::BITS_PER_WORD;
+
+namespace util {
+
+int32_t countTrailingZeros(uint64_t word) {
+	assert(word != 0u);
+
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return static_cast<int32_t>(index);
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+}
+
+namespace {
+
+std::size_t popCount(uint64_t word) {
+#ifdef _MSC_VER
+	return static_cast<std::size_t>(__popcnt64(word));
+#else
+	return static_cast<std::size_t>(__builtin_popcountll(word));
+#endif
+}
+
+/**
+ * ORs together count words, two at a time where SSE2 is available.
+ */
+uint64_t orWords(const uint64_t * words, std::size_t count) {
+	uint64_t acc = 0u;
+	std::size_t i = 0u;
+
+#ifdef PLAYPG_BITGRID_SSE2
+	__m128i vectorAcc = _mm_setzero_si128();
+
+	for (; i + 2u <= count; i += 2u) {
+		vectorAcc = _mm_or_si128(vectorAcc, _mm_loadu_si128(reinterpret_cast<const __m128i *>(words + i)));
+	}
+
+	alignas(16) uint64_t lanes[2];
+	_mm_store_si128(reinterpret_cast<__m128i *>(lanes), vectorAcc);
+	acc = lanes[0] | lanes[1];
+#endif
+
+	for (; i < count; ++i) {
+		acc |= words[i];
+	}
+
+	return acc;
+}
+
+// A mask of the bits at or above bit in a word.
+inline uint64_t maskFrom(uint32_t bit) {
+	return ~uint64_t { 0u } << bit;
+}
+
+// A mask of the bits at or below bit in a word.
+inline uint64_t maskTo(uint32_t bit) {
+	return ~uint64_t { 0u } >> (BitGrid::BITS_PER_WORD - 1u - bit);
+}
+
+}
+
+BitGrid::BitGrid(uint32_t width, uint32_t height) :
+		        width_ { width },
+		        height_ { height },
+		        wordsPerRow_ { BitGrid::wordsPerRowFor(width) },
+		        storage_(std::max<std::size_t>(1u, static_cast<std::size_t>(wordsPerRow_) * height_), 0u) {
+}
+
+BitGrid BitGrid::view(uint32_t width, uint32_t height, const uint64_t * words, std::shared_ptr<const void> owner) {
+	BitGrid ret(0u, 0u);
+
+	ret.width_ = width;
+	ret.height_ = height;
+	ret.wordsPerRow_ = BitGrid::wordsPerRowFor(width);
+	ret.external_ = words;
+	ret.externalOwner_ = std::move(owner);
+
+	return ret;
+}
+
+bool BitGrid::anyInRect(int32_t x, int32_t y, int32_t rectWidth, int32_t rectHeight) const {
+	const int64_t x0 = std::max<int64_t>(x, 0);
+	const int64_t y0 = std::max<int64_t>(y, 0);
+	const int64_t x1 = std::min<int64_t>(int64_t { x } + rectWidth, width_);
+	const int64_t y1 = std::min<int64_t>(int64_t { y } + rectHeight, height_);
+
+	if (x0 >= x1 || y0 >= y1) {
+		return false;
+	}
+
+	const auto firstWord = static_cast<uint32_t>(x0 / BITS_PER_WORD);
+	const auto lastWord = static_cast<uint32_t>((x1 - 1) / BITS_PER_WORD);
+
+	const uint64_t firstMask = maskFrom(x0 % BITS_PER_WORD);
+	const uint64_t lastMask = maskTo((x1 - 1) % BITS_PER_WORD);
+
+	for (auto row = y0; row < y1; ++row) {
+		const auto words = getRow(static_cast<uint32_t>(row));
+		uint64_t acc;
+
+		if (firstWord == lastWord) {
+			acc = words[firstWord] & firstMask & lastMask;
+		} else {
+			acc = (words[firstWord] & firstMask) | (words[lastWord] & lastMask)
+			        | orWords(words + firstWord + 1u, lastWord - firstWord - 1u);
+		}
+
+		if (acc != 0u) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int32_t BitGrid::firstSetInRow(uint32_t y, int32_t xStart, int32_t xEnd) const {
+	const int64_t x0 = std::max<int64_t>(xStart, 0);
+	const int64_t x1 = std::min<int64_t>(xEnd, width_);
+
+	if (y >= height_ || x0 >= x1) {
+		return -1;
+	}
+
+	const auto words = getRow(y);
+
+	auto w = static_cast<uint32_t>(x0 / BITS_PER_WORD);
+	const auto lastWord = static_cast<uint32_t>((x1 - 1) / BITS_PER_WORD);
+
+	uint64_t word = words[w] & maskFrom(x0 % BITS_PER_WORD);
+
+	while (true) {
+		if (w == lastWord) {
+			word &= maskTo((x1 - 1) % BITS_PER_WORD);
+		}
+
+		if (word != 0u) {
+			return static_cast<int32_t>(w * BITS_PER_WORD) + util::countTrailingZeros(word);
+		}
+
+		if (w == lastWord) {
+			return -1;
+		}
+
+		word = words[++w];
+	}
+}
+
+std::size_t BitGrid::count() const {
+	std::size_t total = 0u;
+	const auto wordCount = getWordCount();
+	const auto allWords = words();
+
+	for (std::size_t i = 0u; i < wordCount; ++i) {
+		total += popCount(allWords[i]);
+	}
+
+	return total;
+}
+
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "util/BitStream.hpp"
+
+namespace PlayPG {
+
+namespace {
+
+// writeVarUint prefixes each value with which of these widths it fits in.
+constexpr const uint32_t VAR_UINT_WIDTHS[] = { 4u, 8u, 16u, 64u };
+
+}
+
+void BitWriter::write(uint32_t value, uint32_t bits) {
+	for (uint32_t i = 0u; i < bits;) {
+		const auto bitInByte = static_cast<uint32_t>(bitCount_ & 7u);
+
+		if (bitInByte == 0u) {
+			bytes_.emplace_back(0u);
+		}
+
+		// Fill as much of the current byte as possible at once.
+		const auto count = std::min(8u - bitInByte, bits - i);
+		const auto chunk = (value >> i) & ((1u << count) - 1u);
+
+		bytes_.back() = static_cast<uint8_t>(bytes_.back() | (chunk << bitInByte));
+
+		i += count;
+		bitCount_ += count;
+	}
+}
+
+void BitWriter::writeVarUint(uint64_t value) {
+	uint32_t widthIndex = 0u;
+
+	while (VAR_UINT_WIDTHS[widthIndex] < 64u && (value >> VAR_UINT_WIDTHS[widthIndex]) != 0u) {
+		++widthIndex;
+	}
+
+	write(widthIndex, 2u);
+
+	const auto width = VAR_UINT_WIDTHS[widthIndex];
+
+	if (width <= 32u) {
+		write(static_cast<uint32_t>(value), width);
+	} else {
+		write(static_cast<uint32_t>(value), 32u);
+		write(static_cast<uint32_t>(value >> 32u), width - 32u);
+	}
+}
+
+void BitWriter::clear() {
+	bytes_.clear();
+	bitCount_ = 0u;
+}
+
+BitReader::BitReader(const uint8_t *data, std::size_t size) :
+		        data_ { data },
+		        bitCount_ { size * 8u } {
+}
+
+uint32_t BitReader::read(uint32_t bits) {
+	if (position_ + bits > bitCount_) {
+		overrun_ = true;
+		position_ = bitCount_;
+		return 0u;
+	}
+
+	uint32_t value = 0u;
+
+	for (uint32_t i = 0u; i < bits;) {
+		const auto bitInByte = static_cast<uint32_t>(position_ & 7u);
+		const auto count = std::min(8u - bitInByte, bits - i);
+		const auto chunk = (static_cast<uint32_t>(data_[position_ >> 3u]) >> bitInByte) & ((1u << count) - 1u);
+
+		value |= chunk << i;
+
+		i += count;
+		position_ += count;
+	}
+
+	return value;
+}
+
+uint64_t BitReader::readVarUint() {
+	const auto width = VAR_UINT_WIDTHS[read(2u)];
+
+	if (width <= 32u) {
+		return read(width);
+	}
+
+	const uint64_t low = read(32u);
+	const uint64_t high = read(width - 32u);
+
+	return low | (high << 32u);
+}
+
+}
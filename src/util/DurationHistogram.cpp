@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "util/DurationHistogram.hpp"
+
+namespace PlayPG {
+
+constexpr const uint32_t DurationHistogram::BUCKET_COUNT;
+
+DurationHistogram::DurationHistogram() {
+	buckets_.fill(0u);
+}
+
+void DurationHistogram::record(std::chrono::microseconds duration) {
+	const uint64_t micros = duration.count() < 0 ? 0u : static_cast<uint64_t>(duration.count());
+
+	++buckets_[bucketFor(micros)];
+	++count_;
+	total_ += micros;
+	max_ = std::max(max_, micros);
+}
+
+void DurationHistogram::merge(const DurationHistogram &other) {
+	for (uint32_t i = 0u; i < BUCKET_COUNT; ++i) {
+		buckets_[i] += other.buckets_[i];
+	}
+
+	count_ += other.count_;
+	total_ += other.total_;
+	max_ = std::max(max_, other.max_);
+}
+
+void DurationHistogram::reset() {
+	buckets_.fill(0u);
+	count_ = 0u;
+	total_ = 0u;
+	max_ = 0u;
+}
+
+std::chrono::microseconds DurationHistogram::percentile(double percent) const {
+	if (count_ == 0u) {
+		return std::chrono::microseconds { 0 };
+	}
+
+	const auto clamped = std::min(std::max(percent, 0.0), 100.0);
+	const auto target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(clamped / 100.0 * count_)), 1u);
+
+	uint64_t seen = 0u;
+
+	for (uint32_t i = 0u; i < BUCKET_COUNT; ++i) {
+		seen += buckets_[i];
+
+		if (seen >= target) {
+			return std::chrono::microseconds { std::min(bucketUpperBound(i), max_) };
+		}
+	}
+
+	return std::chrono::microseconds { max_ };
+}
+
+uint32_t DurationHistogram::bucketFor(uint64_t micros) {
+	// Values below 4 get a bucket each; above that, each power of two is split into 4 buckets.
+	if (micros < 4u) {
+		return static_cast<uint32_t>(micros);
+	}
+
+	uint32_t exponent = 0u;
+
+	while ((micros >> (exponent + 1u)) != 0u) {
+		++exponent;
+	}
+
+	const uint32_t subBucket = static_cast<uint32_t>((micros >> (exponent - 2u)) & 3u);
+
+	return std::min(4u * (exponent - 1u) + subBucket, BUCKET_COUNT - 1u);
+}
+
+uint64_t DurationHistogram::bucketUpperBound(uint32_t bucket) {
+	if (bucket < 4u) {
+		return bucket;
+	}
+
+	const uint32_t exponent = bucket / 4u + 1u;
+	const uint64_t lower = (uint64_t { 4u } + bucket % 4u) << (exponent - 2u);
+
+	return lower + (uint64_t { 1u } << (exponent - 2u)) - 1u;
+}
+
+}
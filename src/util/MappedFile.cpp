@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fstream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "util/MappedFile.hpp"
+
+namespace PlayPG {
+
+MappedFile::MappedFile(const std::string &fileName) :
+		        fileName_ { fileName } {
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+	if (mapped_ && data_ != nullptr) {
+		::munmap(const_cast<uint8_t *>(data_), size_);
+	}
+#endif
+}
+
+std::unique_ptr<MappedFile> MappedFile::fromFile(const std::string &fileName) {
+	auto ret = std::unique_ptr<MappedFile>(new MappedFile(fileName));
+
+#ifndef _WIN32
+	const int fd = ::open(fileName.c_str(), O_RDONLY);
+
+	if (fd == -1) {
+		return nullptr;
+	}
+
+	struct stat fileStat;
+
+	if (::fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+		::close(fd);
+		return nullptr;
+	}
+
+	const auto size = static_cast<std::size_t>(fileStat.st_size);
+	void * const mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+	// the mapping keeps its own reference to the file.
+	::close(fd);
+
+	if (mapping == MAP_FAILED) {
+		return nullptr;
+	}
+
+	ret->data_ = static_cast<const uint8_t *>(mapping);
+	ret->size_ = size;
+	ret->mapped_ = true;
+#else
+	// PLATFORM SPECIFIC: no mmap on Windows, so read the whole file instead. A CreateFileMapping
+	// based implementation could be added if page sharing is ever needed there.
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+
+	if (!file) {
+		return nullptr;
+	}
+
+	ret->fallbackBuffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	if (ret->fallbackBuffer_.empty()) {
+		return nullptr;
+	}
+
+	ret->data_ = ret->fallbackBuffer_.data();
+	ret->size_ = ret->fallbackBuffer_.size();
+#endif
+
+	return ret;
+}
+
+}
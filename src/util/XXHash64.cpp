@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2015 See AUTHORS file.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *    * Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *    * Neither the name of the <organization> nor the
+ *      names of its contributors may be used to endorse or promote products
+ *      derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+
+#include <algorithm>
+
+#include "util/XXHash64.hpp"
+
+namespace PlayPG {
+
+namespace {
+
+constexpr const uint64_t PRIME_1 = 11400714785074694791ull;
+constexpr const uint64_t PRIME_2 = 14029467366897019727ull;
+constexpr const uint64_t PRIME_3 = 1609587929392839161ull;
+constexpr const uint64_t PRIME_4 = 9650029242287828579ull;
+constexpr const uint64_t PRIME_5 = 2870177450012600261ull;
+
+inline uint64_t rotateLeft(uint64_t value, unsigned int bits) {
+	return (value << bits) | (value >> (64u - bits));
+}
+
+// xxHash is defined in terms of little endian reads regardless of the host.
+inline uint64_t read64(const uint8_t *data) {
+	uint64_t value;
+	std::memcpy(&value, data, sizeof(value));
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	value = __builtin_bswap64(value);
+#endif
+
+	return value;
+}
+
+inline uint32_t read32(const uint8_t *data) {
+	uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	value = __builtin_bswap32(value);
+#endif
+
+	return value;
+}
+
+inline uint64_t round(uint64_t accumulator, uint64_t input) {
+	accumulator += input * PRIME_2;
+	accumulator = rotateLeft(accumulator, 31u);
+	return accumulator * PRIME_1;
+}
+
+inline uint64_t mergeRound(uint64_t hash, uint64_t accumulator) {
+	hash ^= round(0u, accumulator);
+	return hash * PRIME_1 + PRIME_4;
+}
+
+}
+
+constexpr const std::size_t XXHash64::STRIPE_SIZE;
+
+uint64_t XXHash64::hash(const void *data, std::size_t length, uint64_t seed) {
+	XXHash64 hasher(seed);
+	hasher.update(data, length);
+
+	return hasher.digest();
+}
+
+std::string XXHash64::toHex(uint64_t hash) {
+	static constexpr const char digits[] = "0123456789abcdef";
+
+	std::string ret(16u, '0');
+
+	for (int i = 15; i >= 0; --i) {
+		ret[i] = digits[hash & 0xFu];
+		hash >>= 4u;
+	}
+
+	return ret;
+}
+
+XXHash64::XXHash64(uint64_t seed) :
+		        seed_ { seed },
+		        accumulators_ { { seed + PRIME_1 + PRIME_2, seed + PRIME_2, seed, seed - PRIME_1 } } {
+}
+
+void XXHash64::update(const void *data, std::size_t length) {
+	auto bytes = static_cast<const uint8_t *>(data);
+	totalLength_ += length;
+
+	if (bufferSize_ > 0u) {
+		const auto toCopy = std::min(length, STRIPE_SIZE - bufferSize_);
+
+		std::memcpy(buffer_.data() + bufferSize_, bytes, toCopy);
+		bufferSize_ += toCopy;
+		bytes += toCopy;
+		length -= toCopy;
+
+		if (bufferSize_ < STRIPE_SIZE) {
+			return;
+		}
+
+		consumeStripe(buffer_.data());
+		bufferSize_ = 0u;
+	}
+
+	while (length >= STRIPE_SIZE) {
+		consumeStripe(bytes);
+		bytes += STRIPE_SIZE;
+		length -= STRIPE_SIZE;
+	}
+
+	if (length > 0u) {
+		std::memcpy(buffer_.data(), bytes, length);
+		bufferSize_ = length;
+	}
+}
+
+uint64_t XXHash64::digest() const {
+	uint64_t hash;
+
+	if (totalLength_ >= STRIPE_SIZE) {
+		hash = rotateLeft(accumulators_[0], 1u) + rotateLeft(accumulators_[1], 7u)
+		        + rotateLeft(accumulators_[2], 12u) + rotateLeft(accumulators_[3], 18u);
+
+		for (const auto accumulator : accumulators_) {
+			hash = mergeRound(hash, accumulator);
+		}
+	} else {
+		hash = seed_ + PRIME_5;
+	}
+
+	hash += totalLength_;
+
+	const uint8_t *remaining = buffer_.data();
+	const uint8_t * const end = buffer_.data() + bufferSize_;
+
+	for (; remaining + 8 <= end; remaining += 8) {
+		hash ^= round(0u, read64(remaining));
+		hash = rotateLeft(hash, 27u) * PRIME_1 + PRIME_4;
+	}
+
+	if (remaining + 4 <= end) {
+		hash ^= static_cast<uint64_t>(read32(remaining)) * PRIME_1;
+		hash = rotateLeft(hash, 23u) * PRIME_2 + PRIME_3;
+		remaining += 4;
+	}
+
+	for (; remaining < end; ++remaining) {
+		hash ^= static_cast<uint64_t>(*remaining) * PRIME_5;
+		hash = rotateLeft(hash, 11u) * PRIME_1;
+	}
+
+	hash ^= hash >> 33u;
+	hash *= PRIME_2;
+	hash ^= hash >> 29u;
+	hash *= PRIME_3;
+	hash ^= hash >> 32u;
+
+	return hash;
+}
+
+void XXHash64::consumeStripe(const uint8_t *stripe) {
+	accumulators_[0] = round(accumulators_[0], read64(stripe));
+	accumulators_[1] = round(accumulators_[1], read64(stripe + 8));
+	accumulators_[2] = round(accumulators_[2], read64(stripe + 16));
+	accumulators_[3] = round(accumulators_[3], read64(stripe + 24));
+}
+
+}